@@ -0,0 +1,52 @@
+#include "bench.h"
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+	class Benchmark
+	{
+	public:
+		char const * name;
+		void(*function) ();
+	};
+
+	Benchmark benchmarks[] =
+	{
+		{"slot_map", &Bench::slotMap},
+		{"ptr", &Bench::ptr},
+		{"simd", &Bench::simd},
+		{"quaternion_batch", &Bench::quaternionBatch},
+		{"dynamic_bvh", &Bench::dynamicBvh},
+	};
+
+	void const * volatile keptValue; // Written by keep so that the compiler can't prove that the values are unused.
+}
+
+void Bench::report(std::string const & name, double seconds, unsigned int numOperations)
+{
+	std::printf("  %-40s %10.3f ms %10.2f ns/op\n", name.c_str(), seconds * 1e3, seconds * 1e9 / numOperations);
+}
+
+void Bench::header(std::string const & name)
+{
+	std::printf("%s\n", name.c_str());
+}
+
+void Bench::keep(void const * value)
+{
+	keptValue = value;
+}
+
+int main(int argc, char ** argv)
+{
+	char const * filter = argc > 1 ? argv[1] : "";
+	for(Benchmark const & benchmark : benchmarks)
+	{
+		if(std::strstr(benchmark.name, filter) != nullptr)
+		{
+			benchmark.function();
+		}
+	}
+	return 0;
+}
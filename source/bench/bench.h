@@ -0,0 +1,65 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+
+/*
+A small harness for timing the kit's containers and math. Each benchmark is a function that times its cases with Bench::time and
+prints them with Bench::report. The bench program runs all of them, or only those whose names contain its first argument.
+Build it in Release, since the timings of a Debug build say nothing about the optimized code.
+*/
+namespace Bench
+{
+	// Runs function numRuns times and returns the fastest run in seconds, which is the least disturbed by the rest of the system.
+	template <typename Function> double time(unsigned int numRuns, Function function);
+
+	// Same as above, but calls setup before each run, outside of the timing.
+	template <typename Setup, typename Function> double time(unsigned int numRuns, Setup setup, Function function);
+
+	// Prints the name of a case, its time, and its time per operation in nanoseconds.
+	void report(std::string const & name, double seconds, unsigned int numOperations);
+
+	// Prints the name of a benchmark before its cases.
+	void header(std::string const & name);
+
+	// Makes the compiler think the value is used, so that the work that made it isn't optimized away.
+	void keep(void const * value);
+
+	// The benchmarks. Each is defined in its own file.
+	void slotMap();
+	void ptr();
+	void simd();
+	void quaternionBatch();
+	void dynamicBvh();
+
+	// Times dereferencing n Ptrs with PTR_CHECKS on. It is called by ptr.
+	void ptrChecked(unsigned int n, unsigned int numRuns, unsigned int numPasses);
+
+	// Template Implementation
+
+	template <typename Function>
+	double time(unsigned int numRuns, Function function)
+	{
+		return time(numRuns, []()
+		{
+		}, function);
+	}
+
+	template <typename Setup, typename Function>
+	double time(unsigned int numRuns, Setup setup, Function function)
+	{
+		double fastest = 0;
+		for(unsigned int run = 0; run < numRuns; run++)
+		{
+			setup();
+			auto start = std::chrono::steady_clock::now();
+			function();
+			double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			if(run == 0 || seconds < fastest)
+			{
+				fastest = seconds;
+			}
+		}
+		return fastest;
+	}
+}
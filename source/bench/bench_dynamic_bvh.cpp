@@ -0,0 +1,177 @@
+#include "bench.h"
+#include "../kit/dynamic_bvh.h"
+#include "../kit/random.h"
+#include <cmath>
+#include <vector>
+
+// Times a DynamicBvh of 100k moving boxes: building it, updating every box each frame at slow and fast speeds, and each kind of query.
+
+namespace
+{
+	const unsigned int numObjects = 100000;
+	const float worldSize = 200; // The boxes are within a cube of this size around the origin.
+	const float margin = 0.1f;
+	const float frameTime = 1.0f / 60.0f;
+	const unsigned int numFrames = 30;
+	const unsigned int numRuns = 5;
+	const unsigned int numQueries = 1000;
+	const unsigned int numBruteForceQueries = 100;
+
+	// The boxes, which move in straight lines and bounce off of the sides of the world.
+	class Objects
+	{
+	public:
+		Objects(Random & random)
+			: centers(numObjects), halfSizes(numObjects), velocities(numObjects), ids(numObjects)
+		{
+			random.fill(centers[0].ptr(), numObjects * 3, -worldSize / 2, worldSize / 2);
+			random.fill(halfSizes[0].ptr(), numObjects * 3, 0.25f, 1);
+			random.fillUnitVectors(&velocities[0], numObjects);
+		}
+
+		Boxf getBox(unsigned int i) const
+		{
+			return Boxf(centers[i] - halfSizes[i], centers[i] + halfSizes[i]);
+		}
+
+		// Moves every box by its velocity times speed for one frame.
+		void move(float speed)
+		{
+			for(unsigned int i = 0; i < numObjects; i++)
+			{
+				float * center = centers[i].ptr();
+				float * velocity = velocities[i].ptr();
+				for(unsigned int axis = 0; axis < 3; axis++)
+				{
+					center[axis] += velocity[axis] * speed * frameTime;
+					if(std::abs(center[axis]) > worldSize / 2)
+					{
+						velocity[axis] = -velocity[axis];
+					}
+				}
+			}
+		}
+
+		std::vector<Coord3f> centers;
+		std::vector<Coord3f> halfSizes;
+		std::vector<Coord3f> velocities;
+		std::vector<unsigned int> ids;
+	};
+
+	// Times numFrames frames of moving every box and then updating its leaf, with only the updates timed, and reports the time per update.
+	// The total is used instead of the fastest frame, so that the occasional rebuild is counted.
+	void update(std::string const & name, DynamicBvh<unsigned int> & bvh, Objects & objects, float speed)
+	{
+		double seconds = 0;
+		for(unsigned int frame = 0; frame < numFrames; frame++)
+		{
+			seconds += Bench::time(1, [&]()
+			{
+				objects.move(speed);
+			}, [&]()
+			{
+				for(unsigned int i = 0; i < numObjects; i++)
+				{
+					bvh.update(objects.ids[i], objects.getBox(i));
+				}
+			});
+		}
+		Bench::report(name, seconds, numFrames * numObjects);
+	}
+}
+
+void Bench::dynamicBvh()
+{
+	Bench::header("DynamicBvh of 100k moving boxes");
+	Random random(1);
+	Objects objects(random);
+	DynamicBvh<unsigned int> bvh(margin);
+
+	Bench::report("insert", Bench::time(numRuns, [&]()
+	{
+		bvh.clear();
+	}, [&]()
+	{
+		for(unsigned int i = 0; i < numObjects; i++)
+		{
+			objects.ids[i] = bvh.insert(objects.getBox(i), i);
+		}
+	}), numObjects);
+	Bench::report("rebuild", Bench::time(numRuns, [&]()
+	{
+		bvh.rebuild();
+	}), numObjects);
+
+	// At 1 unit per second most boxes stay within their margins for several frames. At 20 most leave them every frame, which rebuilds the tree often.
+	update("update, slow motion", bvh, objects, 1);
+	update("update, fast motion", bvh, objects, 20);
+	bvh.rebuild();
+
+	// The queries are around random places in the world. The boxes and spheres each find about fifteen boxes.
+	std::vector<Coord3f> places(numQueries);
+	random.fill(places[0].ptr(), numQueries * 3, -worldSize / 2, worldSize / 2);
+	std::vector<Coord3f> directions(numQueries);
+	random.fillUnitVectors(&directions[0], numQueries);
+	unsigned int numFound = 0;
+	Bench::report("box query", Bench::time(numRuns, [&]()
+	{
+		for(unsigned int q = 0; q < numQueries; q++)
+		{
+			bvh.queryBox(Boxf(places[q] - Coord3f::filled(5), places[q] + Coord3f::filled(5)), [&](unsigned int)
+			{
+				numFound++;
+			});
+		}
+	}), numQueries);
+	Bench::report("box query, brute force", Bench::time(numRuns, [&]()
+	{
+		for(unsigned int q = 0; q < numBruteForceQueries; q++)
+		{
+			Boxf box(places[q] - Coord3f::filled(5), places[q] + Coord3f::filled(5));
+			for(unsigned int i = 0; i < numObjects; i++)
+			{
+				if(objects.getBox(i).intersects(box))
+				{
+					numFound++;
+				}
+			}
+		}
+	}), numBruteForceQueries);
+	Bench::report("sphere query", Bench::time(numRuns, [&]()
+	{
+		for(unsigned int q = 0; q < numQueries; q++)
+		{
+			bvh.querySphere(places[q], 6, [&](unsigned int)
+			{
+				numFound++;
+			});
+		}
+	}), numQueries);
+	Bench::report("nearest ray hit", Bench::time(numRuns, [&]()
+	{
+		for(unsigned int q = 0; q < numQueries; q++)
+		{
+			bvh.castRay(Ray3f(places[q], directions[q]), worldSize, [&](unsigned int, float distance)
+			{
+				numFound++;
+				return distance;
+			});
+		}
+	}), numQueries);
+
+	// A frustum at the origin looking along z, with a 90 degree field of view and a far plane at 50, which finds about 2000 boxes.
+	float s = std::sqrt(0.5f);
+	Coord4f planes[6] = {{s, 0, s, 0}, {-s, 0, s, 0}, {0, s, s, 0}, {0, -s, s, 0}, {0, 0, 1, 0}, {0, 0, -1, 50}};
+	unsigned int numFrustumQueries = numQueries / 10;
+	Bench::report("frustum query", Bench::time(numRuns, [&]()
+	{
+		for(unsigned int q = 0; q < numFrustumQueries; q++)
+		{
+			bvh.queryPlanes(planes, 6, [&](unsigned int)
+			{
+				numFound++;
+			});
+		}
+	}), numFrustumQueries);
+	Bench::keep(&numFound);
+}
@@ -0,0 +1,91 @@
+#include "bench.h"
+#include "../kit/ptr.h"
+#include <vector>
+
+// Compares dereferencing and copying Ptrs with raw pointers, with PTR_CHECKS as the build sets it, which is off in Release.
+// The same dereference with the checks on is timed by bench_ptr_checked.cpp.
+
+namespace
+{
+	class Object
+	{
+	public:
+		unsigned int value;
+		float position[7];
+	};
+
+	const unsigned int numRuns = 5;
+	const unsigned int numPasses = 10; // The dereference loops are short, so each run repeats them.
+}
+
+void Bench::ptr()
+{
+	Bench::header(std::string("Ptr vs raw pointers, PTR_CHECKS ") + (PTR_CHECKS ? "on" : "off"));
+	for(unsigned int n : {1000u, 1000000u})
+	{
+		std::string size = " " + std::to_string(n);
+		std::vector<OwnPtr<Object>> owners(n);
+		std::vector<Ptr<Object>> ptrs(n);
+		std::vector<Object *> raws(n);
+		for(unsigned int i = 0; i < n; i++)
+		{
+			owners[i] = OwnPtr<Object>::createNew();
+			owners[i]->value = i;
+			ptrs[i] = owners[i];
+			raws[i] = owners[i].raw();
+		}
+
+		unsigned int sum = 0;
+		Bench::report("raw pointer dereference" + size, Bench::time(numRuns, [&]()
+		{
+			for(unsigned int pass = 0; pass < numPasses; pass++)
+			{
+				for(Object * raw : raws)
+				{
+					sum += raw->value;
+				}
+			}
+		}), n * numPasses);
+		Bench::report("Ptr dereference" + size, Bench::time(numRuns, [&]()
+		{
+			for(unsigned int pass = 0; pass < numPasses; pass++)
+			{
+				for(Ptr<Object> const & ptr : ptrs)
+				{
+					sum += ptr->value;
+				}
+			}
+		}), n * numPasses);
+		Bench::ptrChecked(n, numRuns, numPasses);
+
+		// Copying and then destroying a Ptr is an increment and a decrement of its count.
+		Bench::report("raw pointer copy and destroy" + size, Bench::time(numRuns, [&]()
+		{
+			std::vector<Object *> copies;
+			copies.reserve(n);
+			for(Object * raw : raws)
+			{
+				copies.push_back(raw);
+			}
+			Bench::keep(&copies[0]);
+		}), n);
+		Bench::report("Ptr copy and destroy" + size, Bench::time(numRuns, [&]()
+		{
+			std::vector<Ptr<Object>> copies;
+			copies.reserve(n);
+			for(Ptr<Object> const & ptr : ptrs)
+			{
+				copies.push_back(ptr);
+			}
+			Bench::keep(&copies[0]);
+		}), n);
+		Bench::report("Ptr isValid" + size, Bench::time(numRuns, [&]()
+		{
+			for(Ptr<Object> const & ptr : ptrs)
+			{
+				sum += ptr.isValid() ? 1 : 0;
+			}
+		}), n);
+		Bench::keep(&sum);
+	}
+}
@@ -0,0 +1,42 @@
+// This file always has PTR_CHECKS on, so that bench_ptr.cpp can compare checked and unchecked dereferences in the same program.
+// Its object type is its own, so none of its Ptr instantiations are shared with the files built without the checks.
+#undef PTR_CHECKS
+#define PTR_CHECKS 1
+
+#include "bench.h"
+#include "../kit/ptr.h"
+#include <vector>
+
+namespace
+{
+	class CheckedObject
+	{
+	public:
+		unsigned int value;
+		float position[7];
+	};
+}
+
+void Bench::ptrChecked(unsigned int n, unsigned int numRuns, unsigned int numPasses)
+{
+	std::vector<OwnPtr<CheckedObject>> owners(n);
+	std::vector<Ptr<CheckedObject>> ptrs(n);
+	for(unsigned int i = 0; i < n; i++)
+	{
+		owners[i] = OwnPtr<CheckedObject>::createNew();
+		owners[i]->value = i;
+		ptrs[i] = owners[i];
+	}
+	unsigned int sum = 0;
+	Bench::report("Ptr dereference, PTR_CHECKS on " + std::to_string(n), Bench::time(numRuns, [&]()
+	{
+		for(unsigned int pass = 0; pass < numPasses; pass++)
+		{
+			for(Ptr<CheckedObject> const & ptr : ptrs)
+			{
+				sum += ptr->value;
+			}
+		}
+	}), n * numPasses);
+	Bench::keep(&sum);
+}
@@ -0,0 +1,166 @@
+#include "bench.h"
+#include "../kit/quaternion_batch.h"
+#include "../kit/random.h"
+#include <algorithm>
+#include <vector>
+
+// Compares the functions of quaternion_batch.h, both AoS and SoA, with a loop over the scalar Quaternionf functions.
+
+namespace
+{
+	const unsigned int numRuns = 5;
+	const unsigned int numElements = 4096; // Small enough that the data stays in the cache, so that the arithmetic is what is timed.
+	const unsigned int numPasses = 100;
+
+	// The same quaternions as an array of Quaternionf and as separate component arrays.
+	class Quaternions
+	{
+	public:
+		Quaternions(Random & random, bool normalized)
+			: aos(numElements), r(numElements), i(numElements), j(numElements), k(numElements)
+		{
+			random.fill(&aos[0].r, numElements * 4, -1, 1);
+			for(unsigned int index = 0; index < numElements; index++)
+			{
+				if(normalized)
+				{
+					aos[index].normalize();
+				}
+				r[index] = aos[index].r;
+				i[index] = aos[index].ijk.ptr()[0];
+				j[index] = aos[index].ijk.ptr()[1];
+				k[index] = aos[index].ijk.ptr()[2];
+			}
+			soa = Batch::QuaternionArrays{&r[0], &i[0], &j[0], &k[0]};
+		}
+
+		std::vector<Quaternionf> aos;
+		std::vector<float> r, i, j, k;
+		Batch::QuaternionArrays soa;
+	};
+
+	// Times function() numPasses times and reports it per element. The function does every element.
+	template <typename Function>
+	void run(std::string const & name, Function function)
+	{
+		Bench::report(name, Bench::time(numRuns, [&]()
+		{
+			for(unsigned int pass = 0; pass < numPasses; pass++)
+			{
+				function();
+			}
+		}), numElements * numPasses);
+	}
+}
+
+void Bench::quaternionBatch()
+{
+	Bench::header(std::string("Quaternion batch vs scalar, SIMD_ENABLED ") + (SIMD_ENABLED ? "1" : "0"));
+	Random random(1);
+	Quaternions unnormalized(random, false);
+	Quaternions q0(random, true);
+	Quaternions q1(random, true);
+	std::vector<float> t(numElements);
+	random.fill(&t[0], numElements, 0, 1);
+	std::vector<Coord3f> vectors(numElements);
+	random.fillUnitVectors(&vectors[0], numElements);
+	std::vector<float> x(numElements), y(numElements), z(numElements);
+	for(unsigned int index = 0; index < numElements; index++)
+	{
+		x[index] = vectors[index].ptr()[0];
+		y[index] = vectors[index].ptr()[1];
+		z[index] = vectors[index].ptr()[2];
+	}
+	Quaternions results(random, false);
+	std::vector<Matrix33f> matrices(numElements);
+	std::vector<Coord3f> rotated(numElements);
+	std::vector<float> rx(numElements), ry(numElements), rz(numElements);
+
+	// Normalizing is in place, so every case first copies the unnormalized quaternions to the results.
+	run("normalize, scalar", [&]()
+	{
+		for(unsigned int index = 0; index < numElements; index++)
+		{
+			results.aos[index] = unnormalized.aos[index];
+			results.aos[index].normalize();
+		}
+	});
+	run("normalize, AoS", [&]()
+	{
+		std::copy(unnormalized.aos.begin(), unnormalized.aos.end(), results.aos.begin());
+		Batch::normalizeQuaternions(&results.aos[0], numElements);
+	});
+	run("normalize, SoA", [&]()
+	{
+		std::copy(unnormalized.r.begin(), unnormalized.r.end(), results.r.begin());
+		std::copy(unnormalized.i.begin(), unnormalized.i.end(), results.i.begin());
+		std::copy(unnormalized.j.begin(), unnormalized.j.end(), results.j.begin());
+		std::copy(unnormalized.k.begin(), unnormalized.k.end(), results.k.begin());
+		Batch::normalizeQuaternions(results.soa, numElements);
+	});
+	run("nlerp, scalar", [&]()
+	{
+		for(unsigned int index = 0; index < numElements; index++)
+		{
+			results.aos[index] = nlerp(q0.aos[index], q1.aos[index], t[index]);
+		}
+	});
+	run("nlerp, AoS", [&]()
+	{
+		Batch::nlerpQuaternions(&q0.aos[0], &q1.aos[0], &t[0], &results.aos[0], numElements);
+	});
+	run("nlerp, SoA", [&]()
+	{
+		Batch::nlerpQuaternions(q0.soa, q1.soa, &t[0], results.soa, numElements);
+	});
+	run("slerp, scalar", [&]()
+	{
+		for(unsigned int index = 0; index < numElements; index++)
+		{
+			results.aos[index] = slerp(q0.aos[index], q1.aos[index], t[index]);
+		}
+	});
+	run("slerp, AoS", [&]()
+	{
+		Batch::slerpQuaternions(&q0.aos[0], &q1.aos[0], &t[0], &results.aos[0], numElements);
+	});
+	run("slerp, SoA", [&]()
+	{
+		Batch::slerpQuaternions(q0.soa, q1.soa, &t[0], results.soa, numElements);
+	});
+	run("to matrix, scalar", [&]()
+	{
+		for(unsigned int index = 0; index < numElements; index++)
+		{
+			matrices[index] = q0.aos[index].getMatrix();
+		}
+	});
+	run("to matrix, AoS", [&]()
+	{
+		Batch::quaternionsToMatrices(&q0.aos[0], &matrices[0], numElements);
+	});
+	run("to matrix, SoA", [&]()
+	{
+		Batch::quaternionsToMatrices(q0.soa, &matrices[0], numElements);
+	});
+	run("rotate, scalar", [&]()
+	{
+		for(unsigned int index = 0; index < numElements; index++)
+		{
+			rotated[index] = q0.aos[index].rotate(vectors[index]);
+		}
+	});
+	run("rotate, AoS", [&]()
+	{
+		Batch::rotateVectors(&q0.aos[0], &vectors[0], &rotated[0], numElements);
+	});
+	run("rotate, SoA", [&]()
+	{
+		Batch::rotateVectors(q0.soa, &x[0], &y[0], &z[0], &rx[0], &ry[0], &rz[0], numElements);
+	});
+	Bench::keep(&results.aos[0]);
+	Bench::keep(&results.r[0]);
+	Bench::keep(&matrices[0]);
+	Bench::keep(&rotated[0]);
+	Bench::keep(&rx[0]);
+}
@@ -0,0 +1,138 @@
+#include "bench.h"
+#include "../kit/matrix.h"
+#include "../kit/random.h"
+#include <cmath>
+#include <vector>
+
+// Compares the SIMD specializations of coord.h and matrix.h with the generic scalar templates, which are reached through the const functions.
+
+namespace
+{
+	const unsigned int numRuns = 5;
+	const unsigned int numElements = 4096; // Small enough that the data stays in the cache, so that the arithmetic is what is timed.
+	const unsigned int numPasses = 100;
+
+	std::vector<Coord4f> makeCoords(Random & random)
+	{
+		std::vector<Coord4f> coords(numElements);
+		random.fill(coords[0].ptr(), numElements * 4, -1, 1);
+		return coords;
+	}
+
+	std::vector<Matrix44f> makeMatrices(Random & random)
+	{
+		// Random affine matrices, with the diagonal made large so that every one has an inverse. They are column-major.
+		std::vector<Matrix44f> matrices(numElements);
+		for(Matrix44f & m : matrices)
+		{
+			float * c = m.ptr();
+			random.fill(c, 16, -1, 1);
+			for(unsigned int i = 0; i < 3; i++)
+			{
+				c[i * 5] += 4;
+				c[i * 4 + 3] = 0;
+			}
+			c[15] = 1;
+		}
+		return matrices;
+	}
+
+	// Times function(i) for every element, numPasses times, and reports it per element.
+	template <typename Function>
+	void run(std::string const & name, Function function)
+	{
+		Bench::report(name, Bench::time(numRuns, [&]()
+		{
+			for(unsigned int pass = 0; pass < numPasses; pass++)
+			{
+				for(unsigned int i = 0; i < numElements; i++)
+				{
+					function(i);
+				}
+			}
+		}), numElements * numPasses);
+	}
+}
+
+void Bench::simd()
+{
+	Bench::header(std::string("SIMD vs scalar, SIMD_ENABLED ") + (SIMD_ENABLED ? "1" : "0"));
+	Random random(1);
+	std::vector<Coord4f> a = makeCoords(random);
+	std::vector<Coord4f> b = makeCoords(random);
+	std::vector<Matrix44f> m0 = makeMatrices(random);
+	std::vector<Matrix44f> m1 = makeMatrices(random);
+	std::vector<float> floats(numElements);
+	std::vector<Coord3f> coords3(numElements);
+	std::vector<Coord4f> coords4(numElements);
+	std::vector<Matrix44f> matrices(numElements);
+
+	run("Coord4f dot, scalar", [&](unsigned int i)
+	{
+		floats[i] = constDot(a[i], b[i]);
+	});
+	run("Coord4f dot, SIMD", [&](unsigned int i)
+	{
+		floats[i] = a[i].dot(b[i]);
+	});
+	run("Coord3f dot, scalar", [&](unsigned int i)
+	{
+		floats[i] = constDot(a[i].shrink<3>(), b[i].shrink<3>());
+	});
+	run("Coord3f dot, SIMD", [&](unsigned int i)
+	{
+		floats[i] = a[i].shrink<3>().dot(b[i].shrink<3>());
+	});
+	run("Coord4f unit, scalar", [&](unsigned int i)
+	{
+		coords4[i] = a[i] / std::sqrt(constDot(a[i], a[i]));
+	});
+	run("Coord4f unit, SIMD", [&](unsigned int i)
+	{
+		coords4[i] = a[i].unit();
+	});
+	run("Matrix44f * Coord4f, scalar", [&](unsigned int i)
+	{
+		coords4[i] = constMultiply(m0[i], a[i]);
+	});
+	run("Matrix44f * Coord4f, SIMD", [&](unsigned int i)
+	{
+		coords4[i] = m0[i] * a[i];
+	});
+	run("Matrix44f transform, scalar", [&](unsigned int i)
+	{
+		coords3[i] = constTransform(m0[i], a[i].shrink<3>(), 1.0f);
+	});
+	run("Matrix44f transform, SIMD", [&](unsigned int i)
+	{
+		coords3[i] = m0[i].transform(a[i].shrink<3>(), 1.0f);
+	});
+	run("Matrix44f * Matrix44f, scalar", [&](unsigned int i)
+	{
+		matrices[i] = constMultiply(m0[i], m1[i]);
+	});
+	run("Matrix44f * Matrix44f, SIMD", [&](unsigned int i)
+	{
+		matrices[i] = m0[i] * m1[i];
+	});
+	run("Matrix44f transpose, scalar", [&](unsigned int i)
+	{
+		matrices[i] = constTranspose(m0[i]);
+	});
+	run("Matrix44f transpose, SIMD", [&](unsigned int i)
+	{
+		matrices[i] = m0[i].transpose();
+	});
+	run("Matrix44f inverse, scalar", [&](unsigned int i)
+	{
+		matrices[i] = constInverse(m0[i]);
+	});
+	run("Matrix44f inverse, SIMD", [&](unsigned int i)
+	{
+		matrices[i] = m0[i].inverse();
+	});
+	Bench::keep(&floats[0]);
+	Bench::keep(&coords3[0]);
+	Bench::keep(&coords4[0]);
+	Bench::keep(&matrices[0]);
+}
@@ -0,0 +1,326 @@
+#include "bench.h"
+#include "../kit/slot_map.h"
+#include <algorithm>
+#include <cassert>
+#include <random>
+#include <stack>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+	// The containers that SlotMap replaced, as they were before they were removed, so that the comparison can still be run.
+	// Only the functions that are benchmarked are kept, and IndexedList::add calls empty instead of the isEmpty that kept it from compiling.
+
+	template <typename T>
+	class Storage
+	{
+	public:
+		Storage()
+		{
+			nextFreeId = 0;
+		}
+
+		unsigned int add(T t)
+		{
+			unsigned int id = 0;
+			if(freeIds.empty())
+			{
+				id = nextFreeId;
+				nextFreeId++;
+			}
+			else
+			{
+				id = freeIds.top();
+				freeIds.pop();
+			}
+			map[id] = t;
+			return id;
+		}
+
+		void remove(unsigned int id)
+		{
+			unsigned int numErased = map.erase(id);
+			if(numErased == 1)
+			{
+				freeIds.push(id);
+			}
+			else
+			{
+				throw std::out_of_range("In Storage::remove, an invalid id: " + std::to_string(id));
+			}
+		}
+
+		T get(unsigned int id) const
+		{
+			auto it = map.find(id);
+			if(it != map.end())
+			{
+				return it->second;
+			}
+			else
+			{
+				throw std::out_of_range("In Storage::get, an invalid id: " + std::to_string(id));
+			}
+		}
+
+		typename std::unordered_map<unsigned int, T>::iterator begin()
+		{
+			return map.begin();
+		}
+
+		typename std::unordered_map<unsigned int, T>::iterator end()
+		{
+			return map.end();
+		}
+
+	private:
+		std::unordered_map<unsigned int, T> map;
+		std::stack<unsigned int> freeIds;
+		unsigned int nextFreeId;
+	};
+
+	template <typename T>
+	class IndexedList
+	{
+	public:
+		T & operator [] (int index)
+		{
+			assert(0 <= index && index < used.size() && used[index]);
+			return items[index];
+		}
+
+		int getSize() const
+		{
+			return items.size();
+		}
+
+		bool isUsed(int index) const
+		{
+			if(index < 0 || (int)used.size() <= index)
+			{
+				return false;
+			}
+			return used[index];
+		}
+
+		int add(T const & item)
+		{
+			int index;
+			if(freeIndices.empty())
+			{
+				index = items.size();
+				items.push_back(item);
+				used.push_back(true);
+			}
+			else
+			{
+				index = freeIndices.back();
+				freeIndices.pop_back();
+				items[index] = item;
+				used[index] = true;
+			}
+			return index;
+		}
+
+		void remove(int index)
+		{
+			assert(0 <= index && index < used.size() && used[index]);
+			freeIndices.push_back(index);
+			used[index] = false;
+		}
+
+	private:
+		std::vector<int> freeIndices;
+		std::vector<bool> used;
+		std::vector<T> items;
+	};
+
+	class UniqueIdFactory
+	{
+	public:
+		UniqueIdFactory()
+		{
+			freeIds.push(0);
+		}
+
+		int createId()
+		{
+			int id = freeIds.top();
+			freeIds.pop();
+			if(freeIds.empty())
+			{
+				freeIds.push(id + 1);
+			}
+			return id;
+		}
+
+		void destroyId(int id)
+		{
+			freeIds.push(id);
+		}
+
+	private:
+		std::stack<unsigned int> freeIds;
+	};
+
+	// A typical small object, such as an entity's position and a value.
+	class Object
+	{
+	public:
+		float position[3];
+		unsigned int value;
+	};
+
+	const unsigned int numRuns = 5;
+
+	// Times inserting n objects and then erasing every other one. It leaves the container with the rest, and handles with all of their handles.
+	template <typename Container, typename Handle, typename Add, typename Remove>
+	void insertAndErase(std::string const & name, unsigned int n, Container & container, std::vector<Handle> & handles, Add add, Remove remove)
+	{
+		handles.resize(n);
+		auto clear = [&]()
+		{
+			container = Container();
+		};
+		auto fill = [&]()
+		{
+			for(unsigned int i = 0; i < n; i++)
+			{
+				handles[i] = add(container, Object{{1, 2, 3}, i});
+			}
+		};
+		Bench::report(name + " insert", Bench::time(numRuns, clear, fill), n);
+		Bench::report(name + " erase", Bench::time(numRuns, [&]()
+		{
+			clear();
+			fill();
+		}, [&]()
+		{
+			for(unsigned int i = 0; i < n; i += 2)
+			{
+				remove(container, handles[i]);
+			}
+		}), n / 2);
+	}
+
+	// Times iterating over the objects left by insertAndErase and getting each of them by handle, in a random order.
+	template <typename Container, typename Handle, typename Iterate, typename Get>
+	void iterateAndGet(std::string const & name, Container & container, std::vector<Handle> const & handles, Iterate iterate, Get get)
+	{
+		unsigned int sum = 0;
+		unsigned int n = (unsigned int)handles.size();
+		Bench::report(name + " iterate", Bench::time(numRuns, [&]()
+		{
+			sum += iterate(container);
+		}), n / 2);
+		std::vector<Handle> remaining;
+		for(unsigned int i = 1; i < n; i += 2)
+		{
+			remaining.push_back(handles[i]);
+		}
+		std::shuffle(remaining.begin(), remaining.end(), std::mt19937(0));
+		Bench::report(name + " get", Bench::time(numRuns, [&]()
+		{
+			for(Handle handle : remaining)
+			{
+				sum += get(container, handle);
+			}
+		}), n / 2);
+		Bench::keep(&sum);
+	}
+}
+
+void Bench::slotMap()
+{
+	Bench::header("SlotMap vs the containers it replaced");
+	for(unsigned int n : {10000u, 1000000u})
+	{
+		std::string size = " " + std::to_string(n);
+		{
+			SlotMap<Object> container;
+			std::vector<SlotMap<Object>::Handle> handles;
+			insertAndErase("SlotMap" + size, n, container, handles, [](SlotMap<Object> & c, Object const & o)
+			{
+				return c.add(o);
+			}, [](SlotMap<Object> & c, SlotMap<Object>::Handle h)
+			{
+				c.remove(h);
+			});
+			iterateAndGet("SlotMap" + size, container, handles, [](SlotMap<Object> & c)
+			{
+				unsigned int sum = 0;
+				for(Object const & o : c)
+				{
+					sum += o.value;
+				}
+				return sum;
+			}, [](SlotMap<Object> & c, SlotMap<Object>::Handle h)
+			{
+				return c.get(h).value;
+			});
+		}
+		{
+			Storage<Object> container;
+			std::vector<unsigned int> handles;
+			insertAndErase("Storage" + size, n, container, handles, [](Storage<Object> & c, Object const & o)
+			{
+				return c.add(o);
+			}, [](Storage<Object> & c, unsigned int h)
+			{
+				c.remove(h);
+			});
+			iterateAndGet("Storage" + size, container, handles, [](Storage<Object> & c)
+			{
+				unsigned int sum = 0;
+				for(auto const & pair : c)
+				{
+					sum += pair.second.value;
+				}
+				return sum;
+			}, [](Storage<Object> & c, unsigned int h)
+			{
+				return c.get(h).value;
+			});
+		}
+		{
+			IndexedList<Object> container;
+			std::vector<int> handles;
+			insertAndErase("IndexedList" + size, n, container, handles, [](IndexedList<Object> & c, Object const & o)
+			{
+				return c.add(o);
+			}, [](IndexedList<Object> & c, int h)
+			{
+				c.remove(h);
+			});
+			iterateAndGet("IndexedList" + size, container, handles, [](IndexedList<Object> & c)
+			{
+				unsigned int sum = 0;
+				for(int i = 0; i < c.getSize(); i++)
+				{
+					if(c.isUsed(i))
+					{
+						sum += c[i].value;
+					}
+				}
+				return sum;
+			}, [](IndexedList<Object> & c, int h)
+			{
+				return c[h].value;
+			});
+		}
+		{
+			// UniqueIdFactory only makes ids, so there is nothing to iterate or get.
+			UniqueIdFactory container;
+			std::vector<int> handles;
+			insertAndErase("UniqueIdFactory" + size, n, container, handles, [](UniqueIdFactory & c, Object const &)
+			{
+				return c.createId();
+			}, [](UniqueIdFactory & c, int h)
+			{
+				c.destroyId(h);
+			});
+		}
+	}
+}
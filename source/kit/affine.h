@@ -0,0 +1,176 @@
+#pragma once
+
+#include "matrix.h"
+
+/*
+	An affine transform in dim dimensions: a linear part (rotation, scale, shear) followed by a translation, or equivalently the top dim rows
+	of a (dim + 1) x (dim + 1) matrix whose bottom row is always (0, ..., 0, 1). Keeping only those rows makes it smaller than the full matrix,
+	and composing, inverting, and transforming skip the work the bottom row would need. Use toMatrix when the full matrix is needed, such as for a shader.
+	Everything is constexpr, so fixed transforms can be computed at compile time.
+*/
+template <unsigned int dim, typename T>
+class Affine
+{
+public:
+	// Default constructor. Sets to the identity.
+	constexpr Affine();
+
+	// Constructs from a linear part and a translation.
+	constexpr Affine(Matrix<dim, dim, T> const & linear, Coord<dim, T> translation);
+
+	// Returns the identity transform.
+	static constexpr Affine<dim, T> identity();
+
+	// Returns the linear part.
+	constexpr Matrix<dim, dim, T> const & getLinear() const;
+
+	// Sets the linear part.
+	constexpr void setLinear(Matrix<dim, dim, T> const & linear);
+
+	// Returns the translation.
+	constexpr Coord<dim, T> const & getTranslation() const;
+
+	// Sets the translation.
+	constexpr void setTranslation(Coord<dim, T> translation);
+
+	// Returns this applied to the point p, which is the linear part times p plus the translation.
+	constexpr Coord<dim, T> transformPoint(Coord<dim, T> p) const;
+
+	// Returns this applied to the vector v, which is the linear part times v. The translation doesn't apply to vectors.
+	constexpr Coord<dim, T> transformVector(Coord<dim, T> v) const;
+
+	// Returns the inverse. Throws an exception if the linear part is singular. Dim must be 2, 3, or 4.
+	constexpr Affine<dim, T> inverse() const;
+
+	// Returns the inverse, assuming that the linear part is a pure rotation, so that its inverse is its transpose.
+	constexpr Affine<dim, T> rigidInverse() const;
+
+	// Returns the equivalent (dim + 1) x (dim + 1) matrix.
+	constexpr Matrix<dim + 1, dim + 1, T> toMatrix() const;
+
+private:
+	Matrix<dim, dim, T> linear;
+	Coord<dim, T> translation;
+};
+
+typedef Affine<2, float> Affine2f;
+typedef Affine<3, float> Affine3f;
+typedef Affine<2, double> Affine2d;
+typedef Affine<3, double> Affine3d;
+
+// Returns a0 a1, the transform that applies a1 and then a0.
+template <unsigned int dim, typename T> constexpr Affine<dim, T> operator * (Affine<dim, T> const & a0, Affine<dim, T> const & a1);
+
+// Template Implementations
+
+template <unsigned int dim, typename T>
+constexpr Affine<dim, T>::Affine() : linear(Matrix<dim, dim, T>::identity()), translation()
+{
+}
+
+template <unsigned int dim, typename T>
+constexpr Affine<dim, T>::Affine(Matrix<dim, dim, T> const & linear_, Coord<dim, T> translation_) : linear(linear_), translation(translation_)
+{
+}
+
+template <unsigned int dim, typename T>
+constexpr Affine<dim, T> Affine<dim, T>::identity()
+{
+	return Affine<dim, T>();
+}
+
+template <unsigned int dim, typename T>
+constexpr Matrix<dim, dim, T> const & Affine<dim, T>::getLinear() const
+{
+	return linear;
+}
+
+template <unsigned int dim, typename T>
+constexpr void Affine<dim, T>::setLinear(Matrix<dim, dim, T> const & linear_)
+{
+	linear = linear_;
+}
+
+template <unsigned int dim, typename T>
+constexpr Coord<dim, T> const & Affine<dim, T>::getTranslation() const
+{
+	return translation;
+}
+
+template <unsigned int dim, typename T>
+constexpr void Affine<dim, T>::setTranslation(Coord<dim, T> translation_)
+{
+	translation = translation_;
+}
+
+template <unsigned int dim, typename T>
+constexpr Coord<dim, T> Affine<dim, T>::transformPoint(Coord<dim, T> p) const
+{
+	return transformVector(p) + translation;
+}
+
+template <unsigned int dim, typename T>
+constexpr Coord<dim, T> Affine<dim, T>::transformVector(Coord<dim, T> v) const
+{
+	T const * a = linear.ptr();
+	T const * b = v.ptr();
+	Coord<dim, T> r;
+	T * c = r.ptr();
+	for(unsigned int k = 0; k < dim; ++k)
+	{
+		for(unsigned int i = 0; i < dim; ++i)
+		{
+			c[i] += a[k * dim + i] * b[k];
+		}
+	}
+	return r;
+}
+
+template <unsigned int dim, typename T>
+constexpr Affine<dim, T> Affine<dim, T>::inverse() const
+{
+	Affine<dim, T> r;
+	r.linear = linear.inverse();
+	r.translation = -r.transformVector(translation);
+	return r;
+}
+
+template <unsigned int dim, typename T>
+constexpr Affine<dim, T> Affine<dim, T>::rigidInverse() const
+{
+	Affine<dim, T> r;
+	r.linear = linear.transpose();
+	r.translation = -r.transformVector(translation);
+	return r;
+}
+
+template <unsigned int dim, typename T>
+constexpr Matrix<dim + 1, dim + 1, T> Affine<dim, T>::toMatrix() const
+{
+	Matrix<dim + 1, dim + 1, T> m;
+	T * c = m.ptr();
+	T const * a = linear.ptr();
+	for(unsigned int col = 0; col < dim; ++col)
+	{
+		for(unsigned int row = 0; row < dim; ++row)
+		{
+			c[col * (dim + 1) + row] = a[col * dim + row];
+		}
+		c[col * (dim + 1) + dim] = 0;
+	}
+	for(unsigned int row = 0; row < dim; ++row)
+	{
+		c[dim * (dim + 1) + row] = translation[row];
+	}
+	c[dim * (dim + 1) + dim] = 1;
+	return m;
+}
+
+template <unsigned int dim, typename T>
+constexpr Affine<dim, T> operator * (Affine<dim, T> const & a0, Affine<dim, T> const & a1)
+{
+	return Affine<dim, T>(a0.getLinear() * a1.getLinear(), a0.transformPoint(a1.getTranslation()));
+}
+
+// Compile-time checks that the constexpr functions can be used in constant expressions.
+static_assert(Affine3d(2.0 * Matrix33d::identity(), Coord3d{1, 2, 3}).inverse().transformPoint(Coord3d{3, 4, 5}) == Coord3d{1, 1, 1}, "Affine must be usable in constant expressions.");
@@ -4,6 +4,7 @@
 #include "resources.h"
 #include "window.h"
 #include "scene.h"
+#include "texture.h"
 #include <SDL.h>
 
 //#include "audio.h"
@@ -24,10 +25,19 @@ App::App(std::vector<std::string> const & args)
 
 	// Initialize the singletons.
 	//InputSystem::createInstance();
+	workerPool.setNew();
 	shaderCache.setNew();
 	textureCache.setNew();
 	fontCache.setNew();
-	//SceneModelCache::createInstance();
+	sceneModelCache.setNew();
+	shaderCache->setWorkerPool(workerPool);
+	textureCache->setWorkerPool(workerPool);
+	fontCache->setWorkerPool(workerPool);
+	sceneModelCache->setWorkerPool(workerPool);
+	textureCache->setCostFunction([](Texture const & texture)
+	{
+		return (size_t)texture.getSize()[0] * texture.getSize()[1] * 4;
+	});
 
 	//SDL_InitSubSystem(SDL_INIT_AUDIO);
 }
@@ -36,11 +46,12 @@ App::~App()
 {
 	scenes.clear();
 	windows.clear();
-	// Destroy the singletons.
+	// Destroy the singletons. The caches wait for their background loads, so the pool goes last. The models reference textures and shaders, so they go first.
+	sceneModelCache.setNull();
 	fontCache.setNull();
 	textureCache.setNull();
 	shaderCache.setNull();
-	//SceneModelCache::destroyInstance();
+	workerPool.setNull();
 	//InputSystem::destroyInstance();
 
 	// Stop SDL.
@@ -54,18 +65,16 @@ void App::quit()
 
 Ptr<Window> App::addWindow(std::string const & title)
 {
-	OwnPtr<Window> window;
-	window.setNew(title);
+	OwnPtr<Window> window = OwnPtr<Window>::createNew(title);
 	if(windows.empty())
 	{
 		glContext = SDL_GL_CreateContext(window->getSDLWindow());
 		glInitialize();
 	}
-	windows.insert(window);
-	return window;
+	return *windows.insert(std::move(window));
 }
 
-void App::removeWindow(Ptr<Window> window)
+void App::removeWindow(Ptr<Window> const & window)
 {
 	if(!window.isValid())
 	{
@@ -89,13 +98,10 @@ Ptr<Scene> App::addScene()
 	{
 		throw std::runtime_error("A scene may not be created until a window has been created.");
 	}
-	OwnPtr<Scene> scene;
-	scene.setNew();
-	scenes.insert(scene);
-	return scene;
+	return *scenes.insert(OwnPtr<Scene>::createNew());
 }
 
-void App::removeScene(Ptr<Scene> scene)
+void App::removeScene(Ptr<Scene> const & scene)
 {
 	if(!scene.isValid())
 	{
@@ -136,31 +142,57 @@ void App::loop()
 		//	}
 		//}
 
+		// Add the resources that finished loading in the background.
+		shaderCache->finishLoads();
+		textureCache->finishLoads();
+		fontCache->finishLoads();
+		sceneModelCache->finishLoads();
+
 		// Update
+		// The handlers may add or remove windows and scenes, which invalidates the iterators of a PtrSet, so the loops go over copies instead.
+		// Those added during a phase join in the next phase, and those removed are skipped.
 		float dt = 1.f / targetFrameRate;
-		for(auto & window : windows)
+		copyWindowsAndScenes();
+		for(Ptr<Window> const & window : windowsCopy)
 		{
-			window->update(dt);
+			if(window.isValid())
+			{
+				window->update(dt);
+			}
 		}
-		for(auto & scene : scenes)
+		for(Ptr<Scene> const & scene : scenesCopy)
 		{
-			scene->update(dt);
+			if(scene.isValid())
+			{
+				scene->update(dt);
+			}
 		}
 
 		// PreRender Update
-		for(auto & window : windows)
+		copyWindowsAndScenes();
+		for(Ptr<Window> const & window : windowsCopy)
 		{
-			window->preRenderUpdate();
+			if(window.isValid())
+			{
+				window->preRenderUpdate();
+			}
 		}
-		for(auto scene : scenes)
+		for(Ptr<Scene> const & scene : scenesCopy)
 		{
-			scene->preRenderUpdate();
+			if(scene.isValid())
+			{
+				scene->preRenderUpdate();
+			}
 		}
 
 		// Render (Scene render happens in each Viewport)
-		for(auto const & window : windows)
+		copyWindowsAndScenes();
+		for(Ptr<Window> const & window : windowsCopy)
 		{
-			window->render(glContext);
+			if(window.isValid())
+			{
+				window->render(glContext);
+			}
 		}
 
 		// FIX THIS: Introduce better loop timing
@@ -205,6 +237,12 @@ void App::handleSDLEvent(SDL_Event const & sdlEvent)
 	}
 }
 
+void App::copyWindowsAndScenes()
+{
+	windowsCopy.assign(windows.begin(), windows.end());
+	scenesCopy.assign(scenes.begin(), scenes.end());
+}
+
 Ptr<Window> App::getWindowFromId(unsigned int id) const
 {
 	SDL_Window * sdlWindow = SDL_GetWindowFromID(id);
@@ -44,13 +44,13 @@ public:
 	Ptr<Window> addWindow(std::string const & title);
 
 	// Removes a window.
-	void removeWindow(Ptr<Window> window);
+	void removeWindow(Ptr<Window> const & window);
 
 	// Adds a scene.
 	Ptr<Scene> addScene();
 
 	// Removes a scene.
-	void removeScene(Ptr<Scene> scene);
+	void removeScene(Ptr<Scene> const & scene);
 
 	// Shows a message dialog box.
 	void showMessage(std::string const & message);
@@ -62,8 +62,13 @@ private:
 	void handleSDLEvent(SDL_Event const & event);
 	Ptr<Window> getWindowFromId(unsigned int id) const;
 
+	// Copies the windows and scenes to be looped over, so that the handlers called in the loop can add and remove them.
+	void copyWindowsAndScenes();
+
 	PtrSet<Window> windows;
 	PtrSet<Scene> scenes;
+	std::vector<Ptr<Window>> windowsCopy;
+	std::vector<Ptr<Scene>> scenesCopy;
 	bool looping;
 	float targetFrameRate;
 	SDL_GLContext glContext;
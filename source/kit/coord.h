@@ -1,116 +1,122 @@
 #pragma once
 
 #include "serialize.h"
+#include "simd.h"
 #include <initializer_list>
 #include <exception>
 #include <cassert>
 #include <cmath>
 
 // This is a standard mathematical vector class. Dim is the dimensions of the vector and T is the type of its elements.
+// Everything but the functions that need a square root or trigonometry is constexpr, so constant vectors can be computed at compile time.
+// The exceptions are the SIMD specializations at the end (dot of 3 and 4 dimensional float vectors, and so normSq), which are only for run time.
+// For float constants, use constDot instead, which is the same as the generic member and is always constexpr.
 template <unsigned int dim, typename T>
 class Coord
 {
 public:
 	// Default constructor. Zeroes all elements.
-	Coord();
+	constexpr Coord();
 
 	// Copy constructor. Each element in v is converted from type Y to type T.
-	template <typename Y> Coord(Coord<dim, Y> v);
+	template <typename Y> constexpr Coord(Coord<dim, Y> v);
 
 	// Initializer list constructor.
-	Coord(std::initializer_list<T> const & a);
+	constexpr Coord(std::initializer_list<T> const & a);
 
 	// Returns a unit vector along the i axis.
-	static Coord<dim, T> axis(unsigned int i);
+	static constexpr Coord<dim, T> axis(unsigned int i);
 
 	// Returns a vector with all elements equal to a.
-	static Coord<dim, T> filled(T a);
+	static constexpr Coord<dim, T> filled(T a);
 
 	// Implicit conversion from one dimensional vector to type T
-	operator T () const;
+	constexpr operator T () const;
 
 	// Access element at index i.
-	T & operator [] (unsigned int i);
+	constexpr T & operator [] (unsigned int i);
 
 	// Access element at index i.
-	T operator [] (unsigned int i) const;
+	constexpr T operator [] (unsigned int i) const;
 
 	// Assignment operator. Each element in v is converted from type Y to type T.
-	template <typename Y> Coord<dim, T> const & operator = (Coord<dim, Y> v);
+	template <typename Y> constexpr Coord<dim, T> const & operator = (Coord<dim, Y> v);
 
 	// Set the elements.
-	Coord<dim, T> const & operator = (std::initializer_list<T> const & a);
+	constexpr Coord<dim, T> const & operator = (std::initializer_list<T> const & a);
 	
 	// Add v to this.
-	void operator += (Coord<dim, T> v);
+	constexpr void operator += (Coord<dim, T> v);
 
 	// Subtract v from this.
-	void operator -= (Coord<dim, T> v);
+	constexpr void operator -= (Coord<dim, T> v);
 
 	// Multiply this by a.
-	void operator *= (T a);
+	constexpr void operator *= (T a);
 
 	// Normalize this.
 	void normalize();
 
 	// Get a pointer to the elements.
-	T * ptr();
+	constexpr T * ptr();
 
 	// Get a pointer to the elements.
-	T const * ptr() const;
+	constexpr T const * ptr() const;
 
 	// Returns true if all of the elements are zero.
-	bool isZero() const;
+	constexpr bool isZero() const;
 
 	// Returns this extended to a higher dimension newDim, filling the extra elements with fill.
-	template <unsigned int newDim> Coord<newDim, T> extend(T fill) const;
+	template <unsigned int newDim> constexpr Coord<newDim, T> extend(T fill) const;
 
 	// Returns this shrunk to a lower dimension newDim.
-	template <unsigned int newDim> Coord<newDim, T> shrink() const;
+	template <unsigned int newDim> constexpr Coord<newDim, T> shrink() const;
 
 	// Returns the dot product of this with v.
-	T dot(Coord<dim, T> v) const;
+	constexpr T dot(Coord<dim, T> v) const;
 
 	// Returns the three-dimensional cross product of this and v. The vectors must be three dimensional.
-	Coord<dim, T> cross(Coord<dim, T> v) const;
+	constexpr Coord<dim, T> cross(Coord<dim, T> v) const;
 
 	// Returns this rotated by 90 degrees counter-clockwise. The vector must be two dimensional.
-	Coord<dim, T> perp2d() const;
+	constexpr Coord<dim, T> perp2d() const;
 
 	// Returns the two dimensional cross product of this and v(abs(this) abs(v) sin(the angle between the vectors). The vectors must be two dimensional.
-	T cross2d(Coord<dim, T> v) const;
+	constexpr T cross2d(Coord<dim, T> v) const;
 
 	// Returns a vector that is this from the reference frame of v (as an x-axis) with a norm that is the product of the norms of this and v. The vectors must be two dimensional.
-	Coord<dim, T> relative2d(Coord<dim, T> v) const;
+	constexpr Coord<dim, T> relative2d(Coord<dim, T> v) const;
 
 	// Returns a vector rotated counter-clockwise by the angle a. The vector must be two dimensional.
 	Coord<dim, T> rotate2d(float a);
 
 	// Returns an arbitrary vector perpendicular to this. The result is of arbitrary norm. The vector must be three dimensional.
-	Coord<dim, T> perpendicular() const;
+	constexpr Coord<dim, T> perpendicular() const;
 
 	// Returns the norm/magnitude/length.
 	T norm() const;
 
 	// Returns the square of the norm/magnitude/length.
-	T normSq() const;
+	constexpr T normSq() const;
 
 	// Returns the unit vector of this. This must not be a zero vector.
 	Coord<dim, T> unit() const;
 
 	// Returns a vector with each element in this multiplied by the corresponding element in v.
-	Coord<dim, T> scale(Coord<dim, T> v) const;
+	constexpr Coord<dim, T> scale(Coord<dim, T> v) const;
 
 	// Returns a vector with each element in this divided by the corresponding element in v. V must not contain any zero elements.
-	Coord<dim, T> scaleInv(Coord<dim, T> v) const;
+	constexpr Coord<dim, T> scaleInv(Coord<dim, T> v) const;
 
 	// Returns a vector with each element in this clamped to the range [min, max].
-	Coord<dim, T> clamp(T min, T max) const;
+	constexpr Coord<dim, T> clamp(T min, T max) const;
 
 	// Returns a vector with each element in this clamped to the range specificied by the corresponding elements in min and max.
-	Coord<dim, T> clamp(Coord<dim, T> min, Coord<dim, T> max) const;
+	constexpr Coord<dim, T> clamp(Coord<dim, T> min, Coord<dim, T> max) const;
 
 private:
+	static_assert(dim > 0, "A Coord must have at least one dimension.");
+
 	T c[dim];
 
 	template <unsigned int dimY, typename Y> friend class Coord;
@@ -127,34 +133,40 @@ typedef Coord<3, double> Coord3d;
 typedef Coord<4, double> Coord4d;
 
 // Returns true if each element in v0 is equal to the corresponding element in v1.
-template <unsigned int dim, typename T> bool operator == (Coord<dim, T> v0, Coord<dim, T> v1);
+template <unsigned int dim, typename T> constexpr bool operator == (Coord<dim, T> v0, Coord<dim, T> v1);
 
 // Returns true if any element in v0 is not equal to the corresponding elment in v1.
-template <unsigned int dim, typename T> bool operator != (Coord<dim, T> v0, Coord<dim, T> v1);
+template <unsigned int dim, typename T> constexpr bool operator != (Coord<dim, T> v0, Coord<dim, T> v1);
 
 // Returns true if the the first element in v0 that is not equal to the corresponding element in v1 is less than the other element. If they are all equal, it returns false.
-template <unsigned int dim, typename T> bool operator < (Coord<dim, T> v0, Coord<dim, T> v1);
+template <unsigned int dim, typename T> constexpr bool operator < (Coord<dim, T> v0, Coord<dim, T> v1);
 
 // Returns -v.
-template <unsigned int dim, typename T> Coord<dim, T> operator - (Coord<dim, T> const & v);
+template <unsigned int dim, typename T> constexpr Coord<dim, T> operator - (Coord<dim, T> const & v);
 
 // Returns +v.
-template <unsigned int dim, typename T> Coord<dim, T> operator + (Coord<dim, T> const & v);
+template <unsigned int dim, typename T> constexpr Coord<dim, T> operator + (Coord<dim, T> const & v);
 
 // Returns v0 + v1.
-template <unsigned int dim, typename T> Coord<dim, T> operator + (Coord<dim, T> v0, Coord<dim, T> v1);
+template <unsigned int dim, typename T> constexpr Coord<dim, T> operator + (Coord<dim, T> v0, Coord<dim, T> v1);
 
 // Returns v0 - v1.
-template <unsigned int dim, typename T> Coord<dim, T> operator - (Coord<dim, T> v0, Coord<dim, T> v1);
+template <unsigned int dim, typename T> constexpr Coord<dim, T> operator - (Coord<dim, T> v0, Coord<dim, T> v1);
 
 // Returns a v.
-template <unsigned int dim, typename T> Coord<dim, T> operator * (T a, Coord<dim, T> v);
+template <unsigned int dim, typename T> constexpr Coord<dim, T> operator * (T a, Coord<dim, T> v);
 
 // Returns v a.
-template <unsigned int dim, typename T> Coord<dim, T> operator * (Coord<dim, T> v, T a);
+template <unsigned int dim, typename T> constexpr Coord<dim, T> operator * (Coord<dim, T> v, T a);
 
 // Returns v / a. Beware of truncation if they are both integers.
-template <unsigned int dim, typename T> Coord<dim, T> operator / (Coord<dim, T> v, T a);
+template <unsigned int dim, typename T> constexpr Coord<dim, T> operator / (Coord<dim, T> v, T a);
+
+// Returns v0.dot(v1), but always usable in constant expressions, even for the float vectors whose dot has a SIMD specialization.
+template <unsigned int dim, typename T> constexpr T constDot(Coord<dim, T> v0, Coord<dim, T> v1);
+
+// Returns v0.cross(v1), like constDot. Cross has no SIMD specialization, since the shuffles made it slower than the generic one.
+template <unsigned int dim, typename T> constexpr Coord<dim, T> constCross(Coord<dim, T> v0, Coord<dim, T> v1);
 
 // Serializes v to out.
 template <unsigned int dim, typename T> void serialize(std::ostream & out, Coord<dim, T> const & v);
@@ -165,47 +177,36 @@ template <unsigned int dim, typename T> void deserialize(std::istream & in, Coor
 // Template implementations
 
 template <unsigned int dim, typename T>
-Coord<dim, T>::Coord()
+constexpr Coord<dim, T>::Coord() : c{}
 {
-	assert(dim > 0);
-	for(unsigned int i = 0; i < dim; ++i)
-	{
-		c[i] = 0;
-	}
 }
 
 template <unsigned int dim, typename T> template <typename Y>
-Coord<dim, T>::Coord(Coord<dim, Y> a)
+constexpr Coord<dim, T>::Coord(Coord<dim, Y> a) : c{}
 {
-	assert(dim > 0);
 	*this = a;
 }
 
 template <unsigned int dim, typename T>
-Coord<dim, T>::Coord(std::initializer_list<T> const & a)
+constexpr Coord<dim, T>::Coord(std::initializer_list<T> const & a) : c{}
 {
-	assert(dim > 0);
 	*this = a;
 }
 
 template <unsigned int dim, typename T>
-Coord<dim, T> Coord<dim, T>::axis(unsigned int i)
+constexpr Coord<dim, T> Coord<dim, T>::axis(unsigned int i)
 {
 	if(i >= dim)
 	{
 		throw std::exception();
 	}
 	Coord<dim, T> r;
-	for(unsigned int j = 0; j < dim; ++j)
-	{
-		r.c[j] = 0;
-	}
 	r.c[i] = 1;
 	return r;
 }
 
 template <unsigned int dim, typename T>
-Coord<dim, T> Coord<dim, T>::filled(T a)
+constexpr Coord<dim, T> Coord<dim, T>::filled(T a)
 {
 	Coord<dim, T> r;
 	for(unsigned int i = 0; i < dim; ++i)
@@ -216,14 +217,14 @@ Coord<dim, T> Coord<dim, T>::filled(T a)
 }
 
 template <unsigned int dim, typename T>
-Coord<dim, T>::operator T () const
+constexpr Coord<dim, T>::operator T () const
 {
 	assert(dim == 1);
 	return c[0];
 }
 
 template <unsigned int dim, typename T>
-T & Coord<dim, T>::operator [] (unsigned int i)
+constexpr T & Coord<dim, T>::operator [] (unsigned int i)
 {
 	if(i >= dim)
 	{
@@ -233,7 +234,7 @@ T & Coord<dim, T>::operator [] (unsigned int i)
 }
 
 template <unsigned int dim, typename T>
-T Coord<dim, T>::operator [] (unsigned int i) const
+constexpr T Coord<dim, T>::operator [] (unsigned int i) const
 {
 	if(i >= dim)
 	{
@@ -243,7 +244,7 @@ T Coord<dim, T>::operator [] (unsigned int i) const
 }
 
 template <unsigned int dim, typename T> template <typename Y>
-Coord<dim, T> const & Coord<dim, T>::operator = (Coord<dim, Y> v)
+constexpr Coord<dim, T> const & Coord<dim, T>::operator = (Coord<dim, Y> v)
 {
 	for(unsigned int i = 0; i < dim; ++i)
 	{
@@ -253,7 +254,7 @@ Coord<dim, T> const & Coord<dim, T>::operator = (Coord<dim, Y> v)
 }
 
 template <unsigned int dim, typename T>
-Coord<dim, T> const & Coord<dim, T>::operator = (std::initializer_list<T> const & a)
+constexpr Coord<dim, T> const & Coord<dim, T>::operator = (std::initializer_list<T> const & a)
 {
 	if(a.size() != dim)
 	{
@@ -269,7 +270,7 @@ Coord<dim, T> const & Coord<dim, T>::operator = (std::initializer_list<T> const
 }
 
 template <unsigned int dim, typename T>
-void Coord<dim, T>::operator += (Coord<dim, T> v)
+constexpr void Coord<dim, T>::operator += (Coord<dim, T> v)
 {
 	for(unsigned int i = 0; i < dim; ++i)
 	{
@@ -278,7 +279,7 @@ void Coord<dim, T>::operator += (Coord<dim, T> v)
 }
 
 template <unsigned int dim, typename T>
-void Coord<dim, T>::operator -= (Coord<dim, T> v)
+constexpr void Coord<dim, T>::operator -= (Coord<dim, T> v)
 {
 	for(unsigned int i = 0; i < dim; ++i)
 	{
@@ -287,7 +288,7 @@ void Coord<dim, T>::operator -= (Coord<dim, T> v)
 }
 
 template <unsigned int dim, typename T>
-void Coord<dim, T>::operator *= (T a)
+constexpr void Coord<dim, T>::operator *= (T a)
 {
 	for(unsigned int i = 0; i < dim; ++i)
 	{
@@ -311,19 +312,19 @@ void Coord<dim, T>::normalize()
 }
 
 template <unsigned int dim, typename T>
-T * Coord<dim, T>::ptr()
+constexpr T * Coord<dim, T>::ptr()
 {
 	return c;
 }
 
 template <unsigned int dim, typename T>
-T const * Coord<dim, T>::ptr() const
+constexpr T const * Coord<dim, T>::ptr() const
 {
 	return c;
 }
 
 template <unsigned int dim, typename T>
-bool Coord<dim, T>::isZero() const
+constexpr bool Coord<dim, T>::isZero() const
 {
 	for(unsigned int i = 0; i < dim; ++i)
 	{
@@ -336,7 +337,7 @@ bool Coord<dim, T>::isZero() const
 }
 
 template <unsigned int dim, typename T> template <unsigned int newDim>
-Coord<newDim, T> Coord<dim, T>::extend(T fill) const
+constexpr Coord<newDim, T> Coord<dim, T>::extend(T fill) const
 {
 	assert(newDim > dim);
 	Coord<newDim, T> r;
@@ -352,7 +353,7 @@ Coord<newDim, T> Coord<dim, T>::extend(T fill) const
 }
 
 template <unsigned int dim, typename T> template <unsigned int newDim>
-Coord<newDim, T> Coord<dim, T>::shrink() const
+constexpr Coord<newDim, T> Coord<dim, T>::shrink() const
 {
 	assert(newDim <= dim);
 	Coord<newDim, T> r;
@@ -364,29 +365,19 @@ Coord<newDim, T> Coord<dim, T>::shrink() const
 }
 
 template <unsigned int dim, typename T>
-T Coord<dim, T>::dot(Coord<dim, T> v) const
+constexpr T Coord<dim, T>::dot(Coord<dim, T> v) const
 {
-	T r = 0;
-	for(unsigned int i = 0; i < dim; ++i)
-	{
-		r += c[i] * v.c[i];
-	}
-	return r;
+	return constDot(*this, v);
 }
 
 template <unsigned int dim, typename T>
-Coord<dim, T> Coord<dim, T>::cross(Coord<dim, T> v) const
+constexpr Coord<dim, T> Coord<dim, T>::cross(Coord<dim, T> v) const
 {
-	assert(dim == 3);
-	Coord<dim, T> r;
-	r.c[0] = c[1] * v.c[2] - c[2] * v.c[1];
-	r.c[1] = c[2] * v.c[0] - c[0] * v.c[2];
-	r.c[2] = c[0] * v.c[1] - c[1] * v.c[0];
-	return r;
+	return constCross(*this, v);
 }
 
 template <unsigned int dim, typename T>
-Coord<dim, T> Coord<dim, T>::perp2d() const
+constexpr Coord<dim, T> Coord<dim, T>::perp2d() const
 {
 	assert(dim == 2);
 	Coord<dim, T> r;
@@ -396,17 +387,17 @@ Coord<dim, T> Coord<dim, T>::perp2d() const
 }
 
 template <unsigned int dim, typename T>
-T Coord<dim, T>::cross2d(Coord<dim, T> v) const
+constexpr T Coord<dim, T>::cross2d(Coord<dim, T> v) const
 {
 	assert(dim == 2);
 	return c[0] * v.c[1] - c[1] * v.c[0];
 }
 
 template <unsigned int dim, typename T>
-Coord<dim, T> Coord<dim, T>::relative2d(Coord<dim, T> v) const
+constexpr Coord<dim, T> Coord<dim, T>::relative2d(Coord<dim, T> v) const
 {
 	assert(dim == 2);
-	return Coord<dim, T>(dot(v), cross2D(v));
+	return Coord<dim, T>{dot(v), cross2d(v)};
 }
 
 template <unsigned int dim, typename T>
@@ -415,14 +406,14 @@ Coord<dim, T> Coord<dim, T>::rotate2d(float a)
 	assert(dim == 2);
 	T cosa = std::cos(a);
 	T sina = std::sin(a);
-	return Coord<dim, T>(c[0] * cosa - c[1] * sina, c[0] * sina + c[1] * cosa);
+	return Coord<dim, T>{c[0] * cosa - c[1] * sina, c[0] * sina + c[1] * cosa};
 }
 
 template <unsigned int dim, typename T>
-Coord<dim, T> Coord<dim, T>::perpendicular() const
+constexpr Coord<dim, T> Coord<dim, T>::perpendicular() const
 {
 	assert(dim == 3);
-	Coord<dim, T> r(0, c[2], -c[1]);
+	Coord<dim, T> r{0, c[2], -c[1]};
 	if(c[2] == 0 && c[1] == 0)
 	{
 		r[1] = c[0];
@@ -438,7 +429,7 @@ T Coord<dim, T>::norm() const
 }
 
 template <unsigned int dim, typename T>
-T Coord<dim, T>::normSq() const
+constexpr T Coord<dim, T>::normSq() const
 {
 	return dot(*this);
 }
@@ -461,7 +452,7 @@ Coord<dim, T> Coord<dim, T>::unit() const
 }
 
 template <unsigned int dim, typename T>
-Coord<dim, T> Coord<dim, T>::scale(Coord<dim, T> v) const
+constexpr Coord<dim, T> Coord<dim, T>::scale(Coord<dim, T> v) const
 {
 	Coord<dim, T> r;
 	for(unsigned int i = 0; i < dim; ++i)
@@ -472,7 +463,7 @@ Coord<dim, T> Coord<dim, T>::scale(Coord<dim, T> v) const
 }
 
 template <unsigned int dim, typename T>
-Coord<dim, T> Coord<dim, T>::scaleInv(Coord<dim, T> v) const
+constexpr Coord<dim, T> Coord<dim, T>::scaleInv(Coord<dim, T> v) const
 {
 	Coord<dim, T> r;
 	for(unsigned int i = 0; i < dim; ++i)
@@ -487,7 +478,7 @@ Coord<dim, T> Coord<dim, T>::scaleInv(Coord<dim, T> v) const
 }
 
 template <unsigned int dim, typename T>
-Coord<dim, T> Coord<dim, T>::clamp(T min, T max) const
+constexpr Coord<dim, T> Coord<dim, T>::clamp(T min, T max) const
 {
 	Coord<dim, T> r;
 	for(unsigned int i = 0; i < dim; ++i)
@@ -509,7 +500,7 @@ Coord<dim, T> Coord<dim, T>::clamp(T min, T max) const
 }
 
 template <unsigned int dim, typename T>
-Coord<dim, T> Coord<dim, T>::clamp(Coord<dim, T> min, Coord<dim, T> max) const
+constexpr Coord<dim, T> Coord<dim, T>::clamp(Coord<dim, T> min, Coord<dim, T> max) const
 {
 	Coord<dim, T> r;
 	for(unsigned int i = 0; i < dim; ++i)
@@ -531,7 +522,7 @@ Coord<dim, T> Coord<dim, T>::clamp(Coord<dim, T> min, Coord<dim, T> max) const
 }
 
 template <unsigned int dim, typename T>
-bool operator == (Coord<dim, T> v0, Coord<dim, T> v1)
+constexpr bool operator == (Coord<dim, T> v0, Coord<dim, T> v1)
 {
 	for(unsigned int i = 0; i < dim; ++i)
 	{
@@ -544,13 +535,13 @@ bool operator == (Coord<dim, T> v0, Coord<dim, T> v1)
 }
 
 template <unsigned int dim, typename T>
-bool operator != (Coord<dim, T> v0, Coord<dim, T> v1)
+constexpr bool operator != (Coord<dim, T> v0, Coord<dim, T> v1)
 {
 	return !(v0 == v1);
 }
 
 template <unsigned int dim, typename T>
-bool operator < (Coord<dim, T> v0, Coord<dim, T> v1)
+constexpr bool operator < (Coord<dim, T> v0, Coord<dim, T> v1)
 {
 	for(unsigned int i = 0; i < dim; ++i)
 	{
@@ -567,7 +558,7 @@ bool operator < (Coord<dim, T> v0, Coord<dim, T> v1)
 }
 
 template <unsigned int dim, typename T>
-Coord<dim, T> operator - (Coord<dim, T> const & v)
+constexpr Coord<dim, T> operator - (Coord<dim, T> const & v)
 {
 	Coord<dim, T> r;
 	for(unsigned int i = 0; i < dim; ++i)
@@ -578,7 +569,7 @@ Coord<dim, T> operator - (Coord<dim, T> const & v)
 }
 
 template <unsigned int dim, typename T>
-Coord<dim, T> operator + (Coord<dim, T> const & v)
+constexpr Coord<dim, T> operator + (Coord<dim, T> const & v)
 {
 	Coord<dim, T> r;
 	for(unsigned int i = 0; i < dim; ++i)
@@ -589,7 +580,7 @@ Coord<dim, T> operator + (Coord<dim, T> const & v)
 }
 
 template <unsigned int dim, typename T>
-Coord<dim, T> operator + (Coord<dim, T> v0, Coord<dim, T> v1)
+constexpr Coord<dim, T> operator + (Coord<dim, T> v0, Coord<dim, T> v1)
 {
 	Coord<dim, T> r(v0);
 	r += v1;
@@ -597,7 +588,7 @@ Coord<dim, T> operator + (Coord<dim, T> v0, Coord<dim, T> v1)
 }
 
 template <unsigned int dim, typename T>
-Coord<dim, T> operator - (Coord<dim, T> v0, Coord<dim, T> v1)
+constexpr Coord<dim, T> operator - (Coord<dim, T> v0, Coord<dim, T> v1)
 {
 	Coord<dim, T> r(v0);
 	r -= v1;
@@ -605,7 +596,7 @@ Coord<dim, T> operator - (Coord<dim, T> v0, Coord<dim, T> v1)
 }
 
 template <unsigned int dim, typename T>
-Coord<dim, T> operator * (T a, Coord<dim, T> v)
+constexpr Coord<dim, T> operator * (T a, Coord<dim, T> v)
 {
 	Coord<dim, T> r;
 	for(unsigned int i = 0; i < dim; ++i)
@@ -616,7 +607,7 @@ Coord<dim, T> operator * (T a, Coord<dim, T> v)
 }
 
 template <unsigned int dim, typename T>
-Coord<dim, T> operator * (Coord<dim, T> v, T a)
+constexpr Coord<dim, T> operator * (Coord<dim, T> v, T a)
 {
 	Coord<dim, T> r;
 	for(unsigned int i = 0; i < dim; ++i)
@@ -627,7 +618,7 @@ Coord<dim, T> operator * (Coord<dim, T> v, T a)
 }
 
 template <unsigned int dim, typename T>
-Coord<dim, T> operator / (Coord<dim, T> v, T a)
+constexpr Coord<dim, T> operator / (Coord<dim, T> v, T a)
 {
 	if(a == 0)
 	{
@@ -641,6 +632,33 @@ Coord<dim, T> operator / (Coord<dim, T> v, T a)
 	return r;
 }
 
+template <unsigned int dim, typename T>
+constexpr T constDot(Coord<dim, T> v0, Coord<dim, T> v1)
+{
+	T const * a = v0.ptr();
+	T const * b = v1.ptr();
+	T r = 0;
+	for(unsigned int i = 0; i < dim; ++i)
+	{
+		r += a[i] * b[i];
+	}
+	return r;
+}
+
+template <unsigned int dim, typename T>
+constexpr Coord<dim, T> constCross(Coord<dim, T> v0, Coord<dim, T> v1)
+{
+	assert(dim == 3);
+	T const * a = v0.ptr();
+	T const * b = v1.ptr();
+	Coord<dim, T> r;
+	T * rc = r.ptr();
+	rc[0] = a[1] * b[2] - a[2] * b[1];
+	rc[1] = a[2] * b[0] - a[0] * b[2];
+	rc[2] = a[0] * b[1] - a[1] * b[0];
+	return r;
+}
+
 template <unsigned int dim, typename T>
 void serialize(std::ostream & out, Coord<dim, T> const & v)
 {
@@ -659,3 +677,66 @@ void deserialize(std::istream & in, Coord<dim, T> & v)
 	}
 }
 
+#if SIMD_ENABLED
+
+// SIMD Specializations. They have the same behavior as the generic templates above.
+
+template <>
+inline float Coord<3, float>::dot(Coord<3, float> v) const
+{
+	return Simd::sum(Simd::mul(Simd::load3(c), Simd::load3(v.c)));
+}
+
+template <>
+inline float Coord<4, float>::dot(Coord<4, float> v) const
+{
+	return Simd::sum(Simd::mul(Simd::load(c), Simd::load(v.c)));
+}
+
+template <>
+inline void Coord<3, float>::normalize()
+{
+	float n = norm();
+	if(n == 0)
+	{
+		throw std::exception();
+	}
+	Simd::store3(c, Simd::mul(Simd::load3(c), Simd::splat(1 / n)));
+}
+
+template <>
+inline void Coord<4, float>::normalize()
+{
+	float n = norm();
+	if(n == 0)
+	{
+		throw std::exception();
+	}
+	Simd::store(c, Simd::mul(Simd::load(c), Simd::splat(1 / n)));
+}
+
+template <>
+inline Coord<3, float> Coord<3, float>::unit() const
+{
+	Coord<3, float> r(*this);
+	r.normalize();
+	return r;
+}
+
+template <>
+inline Coord<4, float> Coord<4, float>::unit() const
+{
+	Coord<4, float> r(*this);
+	r.normalize();
+	return r;
+}
+
+#endif
+
+// Compile-time checks that the constexpr functions can be used in constant expressions.
+static_assert(Coord3i::axis(0).cross(Coord3i::axis(1)) == Coord3i::axis(2), "Coord must be usable in constant expressions.");
+static_assert((2.0 * Coord2d{1, 2} + Coord2d::filled(1)).dot(Coord2d{1, 1}) == 8, "Coord must be usable in constant expressions.");
+static_assert(Coord3d{3, -1, 2}.clamp(0, 2).extend<4>(1) == Coord4d{2, 0, 2, 1}, "Coord must be usable in constant expressions.");
+static_assert(Coord3f{1, 2, 3} + 2.0f * Coord3f::axis(1) == Coord3f{1, 4, 3}, "Coord must be usable in constant expressions.");
+static_assert(Coord3f::axis(0).cross(Coord3f::axis(1)) == Coord3f::axis(2), "Coord must be usable in constant expressions.");
+static_assert(constDot(Coord4f{1, 2, 3, 4}, Coord4f::filled(1)) == 10, "Coord must be usable in constant expressions.");
@@ -0,0 +1,55 @@
+#include "cull_batch.h"
+#include "simd.h"
+
+static_assert(sizeof(Coord3f) == 3 * sizeof(float), "Coord3f arrays must be tightly packed floats.");
+
+namespace
+{
+	// Returns the signed distance from the plane to the far side of the sphere. The sphere is outside of the plane when it is negative.
+	float distance(Coord4f plane, Coord3f center, float radius)
+	{
+		return plane[0] * center[0] + (plane[1] * center[1] + (plane[2] * center[2] + (plane[3] + radius)));
+	}
+}
+
+unsigned int Batch::cullSpheres(Coord4f const * planes, unsigned int numPlanes, Coord3f const * centers, float const * radii, unsigned int * visibleIndices, unsigned int count)
+{
+	unsigned int numVisible = 0;
+	unsigned int i = 0;
+#if SIMD_ENABLED
+	for(; i + 4 <= count; i += 4)
+	{
+		Simd::Float4 x, y, z;
+		Simd::loadInterleaved3(centers[i].ptr(), x, y, z);
+		Simd::Float4 radius = Simd::load(radii + i);
+		Simd::Float4 least = Simd::splat(0.0f); // Only the sign matters, so the least distance can start at zero.
+		for(unsigned int j = 0; j < numPlanes; j++)
+		{
+			Simd::Float4 d = Simd::mulAdd(x, Simd::splat(planes[j][0]), Simd::mulAdd(y, Simd::splat(planes[j][1]), Simd::mulAdd(z, Simd::splat(planes[j][2]), Simd::add(Simd::splat(planes[j][3]), radius))));
+			least = Simd::min(d, least);
+		}
+		// Each index is written and then kept only if its sphere is visible, which avoids a branch.
+		float leastDistances[4];
+		Simd::store(leastDistances, least);
+		for(unsigned int k = 0; k < 4; k++)
+		{
+			visibleIndices[numVisible] = i + k;
+			numVisible += (leastDistances[k] >= 0.0f ? 1 : 0);
+		}
+	}
+#endif
+	for(; i < count; i++)
+	{
+		bool visible = true;
+		for(unsigned int j = 0; j < numPlanes && visible; j++)
+		{
+			visible = distance(planes[j], centers[i], radii[i]) >= 0.0f;
+		}
+		if(visible)
+		{
+			visibleIndices[numVisible] = i;
+			numVisible++;
+		}
+	}
+	return numVisible;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "coord.h"
+
+/*
+Functions that test many bounding volumes against a few planes at once, such as the frustum planes of SceneCamera, to find what can be seen.
+As in transform_batch.h, the inner loops work on four at a time with SIMD when it is enabled.
+Each plane is (normal, d) with a unit normal, and a point p is inside of it when normal . p + d >= 0.
+A volume is culled when it is entirely outside of any one plane. Some volumes near the corners of a frustum are outside of it without being outside of a single plane, and are kept.
+*/
+namespace Batch
+{
+	// Sets the start of visibleIndices to the indices, in order, of the spheres with centers[i] and radii[i] that aren't culled by the planes, and returns how many there are.
+	unsigned int cullSpheres(Coord4f const * planes, unsigned int numPlanes, Coord3f const * centers, float const * radii, unsigned int * visibleIndices, unsigned int count);
+}
@@ -0,0 +1,651 @@
+#pragma once
+
+#include "box.h"
+#include "ray.h"
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <cstdint>
+
+/*
+A bounding volume hierarchy of boxes that move, for finding what is along a ray, near a place, or in view without testing everything.
+Each box is kept in a leaf with a value, such as a pointer to the box's owner, and the id of the leaf stays the same until it is removed.
+The leaves are enlarged by a margin, so that a box that moves a little stays within its leaf and nothing changes. When a box moves out of
+its leaf, the leaf and its ancestors are refitted around it. Refitting is fast but makes the tree worse, so after as many refits as there
+are leaves, the tree is rebuilt from scratch. The queries only give the leaves whose actual boxes, not the enlarged ones, pass their tests.
+*/
+template <typename T>
+class DynamicBvh
+{
+public:
+	// Constructor. Each leaf is enlarged on every side by margin times the size of its box.
+	DynamicBvh(float margin);
+
+	// Adds a leaf with the box and value and returns its id. O(log n) on average.
+	unsigned int insert(Boxf const & box, T const & value);
+
+	// Removes the leaf. Throws an exception if the id is invalid. O(log n) on average.
+	void remove(unsigned int id);
+
+	// Moves the leaf to the box. O(1) if the box is still within the leaf and O(log n) on average if it isn't, plus the occasional rebuild.
+	// Throws an exception if the id is invalid.
+	void update(unsigned int id, Boxf const & box);
+
+	// Rebuilds the tree from scratch, with the leaves sorted along a Morton curve through their centers. The ids stay the same. O(n log n)
+	void rebuild();
+
+	// Returns the box of the leaf. Throws an exception if the id is invalid. O(1)
+	Boxf const & getBox(unsigned int id) const;
+
+	// Returns the value of the leaf. Throws an exception if the id is invalid. O(1)
+	T const & getValue(unsigned int id) const;
+
+	// Returns the number of leaves. O(1)
+	unsigned int size() const;
+
+	// Removes all leaves. O(n)
+	void clear();
+
+	// Calls callback(value) for each leaf whose box overlaps the box.
+	template <typename Callback> void queryBox(Boxf const & box, Callback callback) const;
+
+	// Calls callback(value) for each leaf whose box overlaps the sphere.
+	template <typename Callback> void querySphere(Coord3f center, float radius, Callback callback) const;
+
+	// Calls callback(value) for each leaf whose box isn't entirely outside of any one of the planes, given as in cull_batch.h.
+	template <typename Callback> void queryPlanes(Coord4f const * planes, unsigned int numPlanes, Callback callback) const;
+
+	// Calls callback(value, distance) for each leaf whose box the ray enters, at distance, before maxDistance, in units of the ray's direction.
+	// The callback returns the new maxDistance, so returning distance finds the nearest box. The nearer child of each node is visited first.
+	template <typename Callback> void castRay(Ray3f const & ray, float maxDistance, Callback callback) const;
+
+private:
+	class Node
+	{
+	public:
+		Boxf box; // The box around the children, or the enlarged box of a leaf.
+		Boxf bounds; // The actual box of a leaf.
+		unsigned int parent; // The parent, or the next free node if this is free.
+		unsigned int children[2]; // Both are none for a leaf. The second is freed for a free node.
+		T value;
+	};
+
+	bool isLeaf(unsigned int node) const;
+	Node const & getLeaf(unsigned int id, char const * function) const;
+	unsigned int allocateNode();
+	void freeNode(unsigned int node);
+	void insertLeaf(unsigned int leaf);
+	void removeLeaf(unsigned int leaf);
+	void refit(unsigned int node);
+	unsigned int build(uint64_t const * keys, unsigned int count, unsigned int parent);
+
+	// Returns the bits of x spread out to every third bit. X must be less than 1024.
+	static uint32_t spreadBits(uint32_t x);
+	template <typename Callback> void reportAll(unsigned int node, Callback & callback) const;
+
+	// Returns half of the surface area of the box, the cost of visiting a node in the surface area heuristic.
+	static float halfArea(Boxf const & box);
+
+	// Returns where the ray enters the box, or infinity if it misses, as in intersect_batch.h.
+	static float intersect(Coord3f start, Coord3f directionInv, Boxf const & box);
+
+	// Returns -1 if the box is entirely outside of one of the planes, 1 if it is entirely inside of all of them, and 0 otherwise.
+	static int classify(Boxf const & box, Coord4f const * planes, unsigned int numPlanes);
+
+	static const unsigned int none = (unsigned int)-1;
+	static const unsigned int freed = (unsigned int)-2;
+
+	std::vector<Node> nodes;
+	unsigned int root;
+	unsigned int firstFreeNode;
+	unsigned int numLeaves;
+	unsigned int numRefitsSinceRebuild;
+	float margin;
+};
+
+// Template Implementation
+
+template <typename T>
+DynamicBvh<T>::DynamicBvh(float margin_)
+{
+	root = none;
+	firstFreeNode = none;
+	numLeaves = 0;
+	numRefitsSinceRebuild = 0;
+	margin = margin_;
+}
+
+template <typename T>
+unsigned int DynamicBvh<T>::insert(Boxf const & box, T const & value)
+{
+	unsigned int leaf = allocateNode();
+	Coord3f enlargement = margin * (box.max - box.min);
+	nodes[leaf].box = Boxf(box.min - enlargement, box.max + enlargement);
+	nodes[leaf].bounds = box;
+	nodes[leaf].value = value;
+	insertLeaf(leaf);
+	numLeaves++;
+	return leaf;
+}
+
+template <typename T>
+void DynamicBvh<T>::remove(unsigned int id)
+{
+	getLeaf(id, "remove");
+	removeLeaf(id);
+	freeNode(id);
+	numLeaves--;
+}
+
+template <typename T>
+void DynamicBvh<T>::update(unsigned int id, Boxf const & box)
+{
+	getLeaf(id, "update");
+	Node & leaf = nodes[id];
+	leaf.bounds = box;
+	if(leaf.box.contains(box.min) && leaf.box.contains(box.max))
+	{
+		return;
+	}
+	Coord3f enlargement = margin * (box.max - box.min);
+	leaf.box = Boxf(box.min - enlargement, box.max + enlargement);
+	refit(leaf.parent);
+	numRefitsSinceRebuild++;
+	if(numRefitsSinceRebuild > numLeaves)
+	{
+		rebuild();
+	}
+}
+
+template <typename T>
+void DynamicBvh<T>::rebuild()
+{
+	// The leaves keep their nodes, so that their ids stay the same, and the other nodes are freed and used again for the new tree.
+	Boxf centers;
+	std::vector<unsigned int> leaves;
+	leaves.reserve(numLeaves);
+	for(unsigned int node = 0; node < nodes.size(); node++)
+	{
+		if(isLeaf(node))
+		{
+			Coord3f center = nodes[node].box.min + nodes[node].box.max; // Doubled, which doesn't matter here.
+			centers = leaves.empty() ? Boxf(center, center) : centers.extendedTo(center);
+			leaves.push_back(node);
+		}
+		else if(nodes[node].children[1] != freed)
+		{
+			freeNode(node);
+		}
+	}
+	if(leaves.empty())
+	{
+		root = none;
+		numRefitsSinceRebuild = 0;
+		return;
+	}
+
+	// Sort the leaves by the Morton codes of their centers, each axis quantized to 10 bits, with the ids in the low bits of the keys.
+	// Leaves that are near each other are then near each other in the order, and splitting by the bits of the codes splits space in half.
+	// This is much faster than splitting at medians, whose comparisons are unpredictable, and almost as good.
+	std::vector<uint64_t> keys(leaves.size());
+	Coord3f size = centers.max - centers.min;
+	Coord3f scale;
+	for(unsigned int axis = 0; axis < 3; axis++)
+	{
+		scale[axis] = size[axis] > 0 ? 1023.0f / size[axis] : 0.0f;
+	}
+	for(unsigned int i = 0; i < leaves.size(); i++)
+	{
+		Coord3f center = nodes[leaves[i]].box.min + nodes[leaves[i]].box.max;
+		uint32_t code = 0;
+		for(unsigned int axis = 0; axis < 3; axis++)
+		{
+			code |= spreadBits((uint32_t)((center[axis] - centers.min[axis]) * scale[axis])) << (2 - axis);
+		}
+		keys[i] = ((uint64_t)code << 32) | leaves[i];
+	}
+	std::sort(keys.begin(), keys.end());
+	root = build(&keys[0], (unsigned int)keys.size(), none);
+	numRefitsSinceRebuild = 0;
+}
+
+template <typename T>
+Boxf const & DynamicBvh<T>::getBox(unsigned int id) const
+{
+	return getLeaf(id, "getBox").bounds;
+}
+
+template <typename T>
+T const & DynamicBvh<T>::getValue(unsigned int id) const
+{
+	return getLeaf(id, "getValue").value;
+}
+
+template <typename T>
+unsigned int DynamicBvh<T>::size() const
+{
+	return numLeaves;
+}
+
+template <typename T>
+void DynamicBvh<T>::clear()
+{
+	nodes.clear();
+	root = none;
+	firstFreeNode = none;
+	numLeaves = 0;
+	numRefitsSinceRebuild = 0;
+}
+
+template <typename T>
+template <typename Callback>
+void DynamicBvh<T>::queryBox(Boxf const & box, Callback callback) const
+{
+	if(root == none)
+	{
+		return;
+	}
+	std::vector<unsigned int> stack(1, root);
+	while(!stack.empty())
+	{
+		Node const & node = nodes[stack.back()];
+		stack.pop_back();
+		if(!node.box.intersects(box))
+		{
+			continue;
+		}
+		if(node.children[0] == none)
+		{
+			if(node.bounds.intersects(box))
+			{
+				callback(node.value);
+			}
+		}
+		else
+		{
+			stack.push_back(node.children[0]);
+			stack.push_back(node.children[1]);
+		}
+	}
+}
+
+template <typename T>
+template <typename Callback>
+void DynamicBvh<T>::querySphere(Coord3f center, float radius, Callback callback) const
+{
+	if(root == none)
+	{
+		return;
+	}
+	float radiusSq = radius * radius;
+	std::vector<unsigned int> stack(1, root);
+	while(!stack.empty())
+	{
+		Node const & node = nodes[stack.back()];
+		stack.pop_back();
+		if((node.box.closest(center) - center).normSq() > radiusSq)
+		{
+			continue;
+		}
+		if(node.children[0] == none)
+		{
+			if((node.bounds.closest(center) - center).normSq() <= radiusSq)
+			{
+				callback(node.value);
+			}
+		}
+		else
+		{
+			stack.push_back(node.children[0]);
+			stack.push_back(node.children[1]);
+		}
+	}
+}
+
+template <typename T>
+template <typename Callback>
+void DynamicBvh<T>::queryPlanes(Coord4f const * planes, unsigned int numPlanes, Callback callback) const
+{
+	if(root == none)
+	{
+		return;
+	}
+	std::vector<unsigned int> stack(1, root);
+	while(!stack.empty())
+	{
+		unsigned int index = stack.back();
+		Node const & node = nodes[index];
+		stack.pop_back();
+		int classification = classify(node.box, planes, numPlanes);
+		if(classification < 0)
+		{
+			continue;
+		}
+		if(classification > 0)
+		{
+			// The whole subtree is inside, so there is no need to test any more of it.
+			reportAll(index, callback);
+		}
+		else if(node.children[0] == none)
+		{
+			if(classify(node.bounds, planes, numPlanes) >= 0)
+			{
+				callback(node.value);
+			}
+		}
+		else
+		{
+			stack.push_back(node.children[0]);
+			stack.push_back(node.children[1]);
+		}
+	}
+}
+
+template <typename T>
+template <typename Callback>
+void DynamicBvh<T>::castRay(Ray3f const & ray, float maxDistance, Callback callback) const
+{
+	if(root == none)
+	{
+		return;
+	}
+	Coord3f directionInv{1.0f / ray.direction[0], 1.0f / ray.direction[1], 1.0f / ray.direction[2]};
+	std::vector<std::pair<unsigned int, float>> stack(1, std::pair<unsigned int, float>(root, intersect(ray.start, directionInv, nodes[root].box)));
+	while(!stack.empty())
+	{
+		std::pair<unsigned int, float> entry = stack.back();
+		stack.pop_back();
+		if(entry.second >= maxDistance)
+		{
+			continue;
+		}
+		Node const & node = nodes[entry.first];
+		if(node.children[0] == none)
+		{
+			float distance = intersect(ray.start, directionInv, node.bounds);
+			if(distance < maxDistance)
+			{
+				maxDistance = callback(node.value, distance);
+			}
+			continue;
+		}
+		// Push the farther child first, so that the nearer one is visited first.
+		float distance0 = intersect(ray.start, directionInv, nodes[node.children[0]].box);
+		float distance1 = intersect(ray.start, directionInv, nodes[node.children[1]].box);
+		unsigned int near = 0;
+		if(distance1 < distance0)
+		{
+			std::swap(distance0, distance1);
+			near = 1;
+		}
+		if(distance1 < maxDistance)
+		{
+			stack.push_back(std::pair<unsigned int, float>(node.children[1 - near], distance1));
+		}
+		if(distance0 < maxDistance)
+		{
+			stack.push_back(std::pair<unsigned int, float>(node.children[near], distance0));
+		}
+	}
+}
+
+template <typename T>
+bool DynamicBvh<T>::isLeaf(unsigned int node) const
+{
+	return nodes[node].children[0] == none && nodes[node].children[1] == none;
+}
+
+template <typename T>
+typename DynamicBvh<T>::Node const & DynamicBvh<T>::getLeaf(unsigned int id, char const * function) const
+{
+	if(id >= nodes.size() || !isLeaf(id))
+	{
+		throw std::out_of_range(std::string("In DynamicBvh::") + function + ", an invalid id.");
+	}
+	return nodes[id];
+}
+
+template <typename T>
+unsigned int DynamicBvh<T>::allocateNode()
+{
+	unsigned int node;
+	if(firstFreeNode != none)
+	{
+		node = firstFreeNode;
+		firstFreeNode = nodes[node].parent;
+	}
+	else
+	{
+		node = (unsigned int)nodes.size();
+		nodes.emplace_back();
+	}
+	nodes[node].parent = none;
+	nodes[node].children[0] = none;
+	nodes[node].children[1] = none;
+	return node;
+}
+
+template <typename T>
+void DynamicBvh<T>::freeNode(unsigned int node)
+{
+	nodes[node].value = T();
+	nodes[node].parent = firstFreeNode;
+	nodes[node].children[0] = none;
+	nodes[node].children[1] = freed;
+	firstFreeNode = node;
+}
+
+template <typename T>
+void DynamicBvh<T>::insertLeaf(unsigned int leaf)
+{
+	if(root == none)
+	{
+		root = leaf;
+		nodes[leaf].parent = none;
+		return;
+	}
+
+	// Go down the tree to find the best sibling for the leaf by the surface area heuristic, as in Box2D.
+	// The cost of making a node the sibling is the area of their new parent plus the area added to the ancestors.
+	Boxf box = nodes[leaf].box;
+	unsigned int sibling = root;
+	while(!isLeaf(sibling))
+	{
+		Node const & node = nodes[sibling];
+		float area = halfArea(node.box);
+		float combinedArea = halfArea(node.box.unionedWith(box));
+		float cost = 2 * combinedArea;
+		float inheritedCost = 2 * (combinedArea - area);
+		float childCosts[2];
+		for(unsigned int i = 0; i < 2; i++)
+		{
+			Boxf const & childBox = nodes[node.children[i]].box;
+			childCosts[i] = halfArea(childBox.unionedWith(box)) + inheritedCost;
+			if(!isLeaf(node.children[i]))
+			{
+				childCosts[i] -= halfArea(childBox);
+			}
+		}
+		if(cost < childCosts[0] && cost < childCosts[1])
+		{
+			break;
+		}
+		sibling = childCosts[0] <= childCosts[1] ? node.children[0] : node.children[1];
+	}
+
+	// Make a new parent for the sibling and the leaf.
+	unsigned int oldParent = nodes[sibling].parent;
+	unsigned int newParent = allocateNode();
+	nodes[newParent].parent = oldParent;
+	nodes[newParent].children[0] = sibling;
+	nodes[newParent].children[1] = leaf;
+	nodes[newParent].box = nodes[sibling].box.unionedWith(box);
+	nodes[sibling].parent = newParent;
+	nodes[leaf].parent = newParent;
+	if(oldParent == none)
+	{
+		root = newParent;
+	}
+	else
+	{
+		nodes[oldParent].children[nodes[oldParent].children[0] == sibling ? 0 : 1] = newParent;
+		refit(oldParent);
+	}
+}
+
+template <typename T>
+void DynamicBvh<T>::removeLeaf(unsigned int leaf)
+{
+	if(leaf == root)
+	{
+		root = none;
+		return;
+	}
+
+	// The sibling takes the place of the parent.
+	unsigned int parent = nodes[leaf].parent;
+	unsigned int grandParent = nodes[parent].parent;
+	unsigned int sibling = nodes[parent].children[nodes[parent].children[0] == leaf ? 1 : 0];
+	nodes[sibling].parent = grandParent;
+	if(grandParent == none)
+	{
+		root = sibling;
+	}
+	else
+	{
+		nodes[grandParent].children[nodes[grandParent].children[0] == parent ? 0 : 1] = sibling;
+		refit(grandParent);
+	}
+	freeNode(parent);
+}
+
+template <typename T>
+void DynamicBvh<T>::refit(unsigned int node)
+{
+	// Go up until a box doesn't change, since then none above it will either.
+	while(node != none)
+	{
+		Node & n = nodes[node];
+		Boxf box = nodes[n.children[0]].box.unionedWith(nodes[n.children[1]].box);
+		if(box.min == n.box.min && box.max == n.box.max)
+		{
+			break;
+		}
+		n.box = box;
+		node = n.parent;
+	}
+}
+
+template <typename T>
+unsigned int DynamicBvh<T>::build(uint64_t const * keys, unsigned int count, unsigned int parent)
+{
+	if(count == 1)
+	{
+		unsigned int leaf = (unsigned int)keys[0];
+		nodes[leaf].parent = parent;
+		return leaf;
+	}
+
+	// Split where the highest bit in which the codes differ changes. If the codes are all the same, split in the middle.
+	uint32_t firstCode = (uint32_t)(keys[0] >> 32);
+	uint32_t lastCode = (uint32_t)(keys[count - 1] >> 32);
+	unsigned int split = count / 2;
+	if(firstCode != lastCode)
+	{
+		uint32_t highestBit = 0x80000000u;
+		while((firstCode ^ lastCode) < highestBit)
+		{
+			highestBit >>= 1;
+		}
+		uint64_t splitKey = (uint64_t)(lastCode & ~(highestBit - 1)) << 32;
+		split = (unsigned int)(std::lower_bound(keys, keys + count, splitKey) - keys);
+	}
+
+	unsigned int node = allocateNode();
+	nodes[node].parent = parent;
+	unsigned int child0 = build(keys, split, node);
+	unsigned int child1 = build(keys + split, count - split, node);
+	nodes[node].children[0] = child0;
+	nodes[node].children[1] = child1;
+	nodes[node].box = nodes[child0].box.unionedWith(nodes[child1].box);
+	return node;
+}
+
+template <typename T>
+template <typename Callback>
+void DynamicBvh<T>::reportAll(unsigned int node, Callback & callback) const
+{
+	std::vector<unsigned int> stack(1, node);
+	while(!stack.empty())
+	{
+		Node const & n = nodes[stack.back()];
+		stack.pop_back();
+		if(n.children[0] == none)
+		{
+			callback(n.value);
+		}
+		else
+		{
+			stack.push_back(n.children[0]);
+			stack.push_back(n.children[1]);
+		}
+	}
+}
+
+template <typename T>
+uint32_t DynamicBvh<T>::spreadBits(uint32_t x)
+{
+	x = (x | (x << 16)) & 0x030000ffu;
+	x = (x | (x << 8)) & 0x0300f00fu;
+	x = (x | (x << 4)) & 0x030c30c3u;
+	x = (x | (x << 2)) & 0x09249249u;
+	return x;
+}
+
+template <typename T>
+float DynamicBvh<T>::halfArea(Boxf const & box)
+{
+	Coord3f size = box.max - box.min;
+	return size[0] * size[1] + size[1] * size[2] + size[2] * size[0];
+}
+
+template <typename T>
+float DynamicBvh<T>::intersect(Coord3f start, Coord3f directionInv, Boxf const & box)
+{
+	float near = 0;
+	float far = std::numeric_limits<float>::infinity();
+	for(unsigned int axis = 0; axis < 3; axis++)
+	{
+		float t0 = (box.min[axis] - start[axis]) * directionInv[axis];
+		float t1 = (box.max[axis] - start[axis]) * directionInv[axis];
+		near = std::max(near, std::min(t1, t0));
+		far = std::min(far, std::max(t1, t0));
+	}
+	return near <= far ? near : std::numeric_limits<float>::infinity();
+}
+
+template <typename T>
+int DynamicBvh<T>::classify(Boxf const & box, Coord4f const * planes, unsigned int numPlanes)
+{
+	// Compare the distance from each plane to the center of the box with the box's extent along the plane's normal.
+	Coord3f center = (box.min + box.max) / 2.0f;
+	Coord3f extent = (box.max - box.min) / 2.0f;
+	int classification = 1;
+	for(unsigned int i = 0; i < numPlanes; i++)
+	{
+		float distance = planes[i][0] * center[0] + planes[i][1] * center[1] + planes[i][2] * center[2] + planes[i][3];
+		float radius = std::abs(planes[i][0]) * extent[0] + std::abs(planes[i][1]) * extent[1] + std::abs(planes[i][2]) * extent[2];
+		if(distance + radius < 0)
+		{
+			return -1;
+		}
+		if(distance - radius < 0)
+		{
+			classification = 0;
+		}
+	}
+	return classification;
+}
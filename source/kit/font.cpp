@@ -6,15 +6,61 @@
 #include "scene_model.h"
 #include "math_util.h"
 #include <SDL_ttf.h>
+#include <mutex>
 
 unsigned int numFontsLoaded = 0;
 unsigned int numCharsInRow = 16;
 unsigned int numCharsInCol = 8;
 unsigned int numCharsInBlock = numCharsInRow * numCharsInCol;
 
-Font::Font(std::string const & filename, int size_)
+namespace
 {
+	// Guards SDL_ttf and numFontsLoaded, since fonts are opened and drawn on worker threads as well as the GL thread.
+	std::mutex ttfMutex;
+
+	// Draws the glyphs of the block starting at blockStart into RGBA32 pixels. It doesn't use GL. The mutex must be locked.
+	void rasterBlock(TTF_Font * ttfFont, int size, int blockStart, Texture::Pixels & pixels, std::vector<unsigned int> & widths, unsigned int & cellSize, unsigned int & heightOfChar)
+	{
+		widths.resize(numCharsInBlock);
+		cellSize = 2 * Math::ceilPow2(size);
+		SDL_Color white = {255, 255, 255, 255};
+		SDL_Surface * surface = SDL_CreateRGBSurface(0, cellSize * numCharsInRow, cellSize * numCharsInCol, 32, 0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000);
+		for(unsigned int i = 0; i < numCharsInBlock; ++i)
+		{
+			SDL_Surface * glyphSurface = TTF_RenderGlyph_Solid(ttfFont, blockStart + i, white);
+			if(glyphSurface != 0)
+			{
+				heightOfChar = glyphSurface->h;
+				widths[i] = glyphSurface->w;
+				SDL_Rect rect;
+				rect.x = (i % numCharsInRow) * cellSize + (cellSize - glyphSurface->w) / 2;
+				rect.y = (i / numCharsInRow) * cellSize + (cellSize - glyphSurface->h) / 2;
+				SDL_BlitSurface(glyphSurface, 0, surface, &rect);
+				SDL_FreeSurface(glyphSurface);
+			}
+		}
+		pixels.size = {surface->w, surface->h};
+		pixels.data.assign((unsigned char const *)surface->pixels, (unsigned char const *)surface->pixels + surface->w * surface->h * 4);
+		SDL_FreeSurface(surface);
+	}
+
+	void closeFont(TTF_Font * ttfFont)
+	{
+		std::lock_guard<std::mutex> lock(ttfMutex);
+		TTF_CloseFont(ttfFont);
+		numFontsLoaded--;
+		if(numFontsLoaded == 0)
+		{
+			TTF_Quit();
+		}
+	}
+}
+
+Font::Raster::Raster(std::string const & filename, int size_)
+{
+	std::lock_guard<std::mutex> lock(ttfMutex);
 	size = size_;
+	heightOfChar = 0;
 	if(numFontsLoaded == 0)
 	{
 		int status = 0;
@@ -28,22 +74,51 @@ Font::Font(std::string const & filename, int size_)
 	ttfFont = TTF_OpenFont(filename.c_str(), size_);
 	if(ttfFont == 0)
 	{
+		if(numFontsLoaded == 0)
+		{
+			TTF_Quit();
+		}
 		throw std::runtime_error("The font '" + filename + "' at size " + std::to_string(size_) + " could not be loaded. ");
 	}
 	numFontsLoaded++;
-	loadBlock(0);
+	rasterBlock(ttfFont, size, 0, pixels, widths, cellSize, heightOfChar);
 }
 
-Font::~Font()
+Font::Raster::Raster(Raster && raster) : ttfFont(raster.ttfFont), size(raster.size), heightOfChar(raster.heightOfChar), cellSize(raster.cellSize), widths(std::move(raster.widths)), pixels(std::move(raster.pixels))
 {
-	TTF_CloseFont(ttfFont);
-	numFontsLoaded--;
-	if(numFontsLoaded == 0)
+	raster.ttfFont = nullptr;
+}
+
+Font::Raster::~Raster()
+{
+	if(ttfFont != nullptr)
 	{
-		TTF_Quit();
+		closeFont(ttfFont);
 	}
 }
 
+Font::Font(std::string const & filename, int size) : Font(Raster(filename, size))
+{
+}
+
+Font::Font(Raster && raster)
+{
+	size = raster.size;
+	heightOfChar = raster.heightOfChar;
+	Block block;
+	block.widths = std::move(raster.widths);
+	block.cellSize = raster.cellSize;
+	block.texture.setNew(&raster.pixels.data[0], raster.pixels.size);
+	blocks[0] = block;
+	ttfFont = raster.ttfFont;
+	raster.ttfFont = nullptr;
+}
+
+Font::~Font()
+{
+	closeFont(ttfFont);
+}
+
 void Font::getGuiModelsFromText(std::string const & text, std::vector<OwnPtr<GuiModel>> & models, Coord2i & textSize)
 {
 	models.clear();
@@ -167,28 +242,12 @@ void Font::loadBlock(int blockStart)
 {
 	// Create a texture for 128 characters, starting with the unicodeStart.
 	Block block;
-	int numCharsInBlock = numCharsInRow * numCharsInCol;
-	block.widths.resize(numCharsInBlock);
-	block.cellSize = 2 * Math::ceilPow2(size);
-	SDL_Color white = {255, 255, 255, 255};
-	SDL_Surface * surface = SDL_CreateRGBSurface(0, block.cellSize * numCharsInRow, block.cellSize * numCharsInCol, 32, 0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000);
-	for(int i = 0; i < numCharsInBlock; ++i)
+	Texture::Pixels pixels;
 	{
-		SDL_Surface * glyphSurface = TTF_RenderGlyph_Solid(ttfFont, blockStart + i, white);
-		if(glyphSurface != 0)
-		{
-			heightOfChar = glyphSurface->h;
-			block.widths[i] = glyphSurface->w;
-			SDL_Rect rect;
-			rect.x = (i % numCharsInRow) * block.cellSize + (block.cellSize - glyphSurface->w) / 2;
-			rect.y = (i / numCharsInRow) * block.cellSize + (block.cellSize - glyphSurface->h) / 2;
-			SDL_BlitSurface(glyphSurface, 0, surface, &rect);
-			SDL_FreeSurface(glyphSurface);
-		}
+		std::lock_guard<std::mutex> lock(ttfMutex);
+		rasterBlock(ttfFont, size, blockStart, pixels, block.widths, block.cellSize, heightOfChar);
 	}
-	SDL_SaveBMP(surface, "test.bmp");
-	block.texture.setNew(surface->pixels, Coord2i{surface->w, surface->h});
-	SDL_FreeSurface(surface);
+	block.texture.setNew(&pixels.data[0], pixels.size);
 	blocks[blockStart] = block;
 }
 
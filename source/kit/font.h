@@ -3,6 +3,7 @@
 #include "coord.h"
 #include "ptr.h"
 #include "rect.h"
+#include "texture.h"
 #include <string>
 #include <map>
 #include <vector>
@@ -12,12 +13,43 @@
 typedef struct _TTF_Font TTF_Font;
 class GuiModel;
 class SceneModel;
-class Texture;
 
 class Font
 {
 public:
+	// An opened font file with its first block of glyphs drawn into pixels. Making it doesn't use GL, so it can be done on a worker thread, with the font created later from it.
+	class Raster
+	{
+	public:
+		// Opens the font file at the size and draws the first block. Throws an exception if the file can't be opened.
+		Raster(std::string const & filename, int size);
+
+		// Move constructor. The font file goes with it.
+		Raster(Raster && raster);
+
+		// Closes the font file, unless a Font took it.
+		~Raster();
+
+	private:
+		Raster(Raster const &) = delete;
+		Raster & operator = (Raster const &) = delete;
+
+		TTF_Font * ttfFont;
+		int size;
+		unsigned int heightOfChar;
+		unsigned int cellSize;
+		std::vector<unsigned int> widths;
+		Texture::Pixels pixels;
+
+		friend class Font;
+	};
+
+	// Opens the font file at the size.
 	Font(std::string const & filename, int size);
+
+	// Creates the font from a raster, taking its font file.
+	Font(Raster && raster);
+
 	~Font();
 	void getGuiModelsFromText(std::string const & text, std::vector<OwnPtr<GuiModel>> & models, Coord2i & textSize);
 	void getSceneModelsFromText(std::string const & text, std::vector<OwnPtr<SceneModel>> & models, Coord2i & textSize);
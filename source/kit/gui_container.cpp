@@ -34,11 +34,7 @@ void GuiContainer::removeElement(Ptr<GuiElement> const & element)
 void GuiContainer::moveElementToFront(Ptr<GuiElement> const & element)
 {
 	auto itOld = find(element);
-	ElementInfo info = *itOld; // make a copy so it doesn't destruct
-	infos.erase(itOld);
-	lookup.erase(element);
-	auto itNew = infos.insert(infos.end(), info);
-	lookup[info.element] = itNew;
+	infos.splice(infos.end(), infos, itOld); // relinks the node, so the iterator in the lookup stays valid
 }
 
 void GuiContainer::setElementActive(Ptr<GuiElement> const & element, bool active)
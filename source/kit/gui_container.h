@@ -5,6 +5,7 @@
 #include <map>
 #include <list>
 #include <functional>
+#include <utility>
 
 class GuiContainer : public GuiElement
 {
@@ -15,7 +16,7 @@ public:
 
 	void setSize(Coord2i size) override;
 
-	template <typename T> Ptr<T> addElement();
+	template <typename T, typename... Args> Ptr<T> addElement(Args && ... args);
 
 	void removeElement(Ptr<GuiElement> const & element);
 
@@ -65,19 +66,20 @@ private:
 	std::function<void ()> preRenderUpdateHandler;
 };
 
-template <typename T> Ptr<T> GuiContainer::addElement()
+template <typename T, typename... Args> Ptr<T> GuiContainer::addElement(Args && ... args)
 {
 	ElementInfo info;
-	OwnPtr<T> elementDerived = OwnPtr<T>::createNew();
-	info.element = elementDerived;
+	OwnPtr<T> elementDerived = OwnPtr<T>::createNew(std::forward<Args>(args)...);
+	Ptr<T> element = elementDerived;
+	info.element = std::move(elementDerived);
 	info.active = true;
 	info.sizeFractionOfContainer = {1, 1};
 	info.positionFractionOfElement = {0, 0};
 	info.positionFractionOfContainer = {0, 0};
 	info.positionOffset = {0, 0};
-	auto it = infos.insert(infos.end(), info);
-	lookup[info.element] = it;
-	updateElementBounds(info);
-	return elementDerived;
+	auto it = infos.insert(infos.end(), std::move(info));
+	lookup[it->element] = it;
+	updateElementBounds(*it);
+	return element;
 }
 
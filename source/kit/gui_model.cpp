@@ -67,7 +67,8 @@ void GuiModel::render(Coord2i windowSize)
 
 void GuiModel::updateShader()
 {
-	if(!shaderCache->has("guiShader"))
+	auto key = shaderCache->getKey("guiShader");
+	if(!shaderCache->has(key))
 	{
 		std::string version = "120";
 		std::string attribute = "attribute";
@@ -106,11 +107,11 @@ void GuiModel::updateShader()
 			"{\n"
 			"  gl_FragColor = texture2D(uSampler, vec2(vUv.s / float(uTextureSize.x), vUv.t / float(uTextureSize.y)));\n"
 			"}\n";
-		shader = shaderCache->load("guiShader", code);
+		shader = shaderCache->load(key, code);
 	}
 	else
 	{
-		shader = shaderCache->get("guiShader");
+		shader = shaderCache->get(key);
 	}
 }
 
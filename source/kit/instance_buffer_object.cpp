@@ -0,0 +1,24 @@
+#include "instance_buffer_object.h"
+#include "open_gl.h"
+
+InstanceBufferObject::InstanceBufferObject()
+{
+	glGenBuffers(1, &arrayBuffer);
+}
+
+InstanceBufferObject::~InstanceBufferObject()
+{
+	glDeleteBuffers(1, &arrayBuffer);
+}
+
+void InstanceBufferObject::setInstances(void const * instances, unsigned int numBytes)
+{
+	glBindBuffer(GL_ARRAY_BUFFER, arrayBuffer);
+	glBufferData(GL_ARRAY_BUFFER, numBytes, instances, GL_STREAM_DRAW);
+}
+
+void InstanceBufferObject::bind() const
+{
+	glBindBuffer(GL_ARRAY_BUFFER, arrayBuffer);
+}
+
@@ -0,0 +1,20 @@
+#pragma once
+
+// A buffer of per-instance attributes, such as transforms, for instanced renders of a VertexBufferObject. It is meant to be refilled every frame.
+class InstanceBufferObject
+{
+public:
+	InstanceBufferObject();
+
+	~InstanceBufferObject();
+
+	// Sets the instances, replacing the previous ones. The storage is reallocated each time so that the driver doesn't wait for renders still reading the previous ones.
+	void setInstances(void const * instances, unsigned int numBytes);
+
+	// Binds the buffer, so that the instance components of a VertexBufferObject can be pointed into it.
+	void bind() const;
+
+private:
+	unsigned int arrayBuffer;
+};
+
@@ -0,0 +1,228 @@
+#include "intersect_batch.h"
+#include "simd.h"
+#include <limits>
+#include <algorithm>
+
+static_assert(sizeof(Boxf) == 6 * sizeof(float), "Boxf arrays must be tightly packed floats, min first.");
+static_assert(sizeof(Ray3f) == 6 * sizeof(float), "Ray3f arrays must be tightly packed floats, start first.");
+static_assert(sizeof(Coord3f) == 3 * sizeof(float), "Coord3f arrays must be tightly packed floats.");
+
+namespace
+{
+	float const infinity = std::numeric_limits<float>::infinity();
+
+	// Returns the inverse of each element of the direction, for the slab test.
+	Coord3f inverse(Coord3f direction)
+	{
+		return Coord3f{1.0f / direction[0], 1.0f / direction[1], 1.0f / direction[2]};
+	}
+
+	// Returns where the ray enters the box, given the inverse of its direction, or infinity if it misses.
+	// The accumulated near and far are the second arguments of max and min, so that a NaN from 0 times infinity is ignored, as with SSE.
+	float intersect(Coord3f start, Coord3f directionInv, Coord3f min, Coord3f max)
+	{
+		float near = 0;
+		float far = infinity;
+		for(unsigned int axis = 0; axis < 3; axis++)
+		{
+			float t0 = (min[axis] - start[axis]) * directionInv[axis];
+			float t1 = (max[axis] - start[axis]) * directionInv[axis];
+			near = std::max(near, std::min(t1, t0));
+			far = std::min(far, std::max(t1, t0));
+		}
+		return near <= far ? near : infinity;
+	}
+
+	// Returns where the ray hits the triangle, or infinity if it misses.
+	float intersect(Ray3f const & ray, Coord3f v0, Coord3f v1, Coord3f v2)
+	{
+		Coord3f e1 = v1 - v0;
+		Coord3f e2 = v2 - v0;
+		Coord3f p = ray.direction.cross(e2);
+		float detInv = 1.0f / e1.dot(p); // If the ray is parallel to the triangle, this is infinite and u, v, or t below won't pass.
+		Coord3f s = ray.start - v0;
+		float u = s.dot(p) * detInv;
+		Coord3f q = s.cross(e1);
+		float v = ray.direction.dot(q) * detInv;
+		float t = e2.dot(q) * detInv;
+		if(0 <= u && 0 <= v && u + v <= 1 && 0 <= t)
+		{
+			return t;
+		}
+		return infinity;
+	}
+
+#if SIMD_ENABLED
+	// Loads four consecutive pairs of Coord3fs, such as boxes or rays, and sets a and b to the x, y, and z of the first and second of each pair.
+	void loadPairs(float const * p, Simd::Float4 * a, Simd::Float4 * b)
+	{
+		Simd::Float4 x0, y0, z0, x1, y1, z1;
+		Simd::loadInterleaved3(p, x0, y0, z0); // (a0, b0, a1, b1) for each of x, y, and z
+		Simd::loadInterleaved3(p + 12, x1, y1, z1); // (a2, b2, a3, b3)
+		Simd::unzip(x0, x1, a[0], b[0]);
+		Simd::unzip(y0, y1, a[1], b[1]);
+		Simd::unzip(z0, z1, a[2], b[2]);
+	}
+
+	// The same as the scalar intersect above, for four rays and boxes.
+	Simd::Float4 intersect(Simd::Float4 const * start, Simd::Float4 const * directionInv, Simd::Float4 const * min, Simd::Float4 const * max)
+	{
+		Simd::Float4 near = Simd::splat(0.0f);
+		Simd::Float4 far = Simd::splat(infinity);
+		for(unsigned int axis = 0; axis < 3; axis++)
+		{
+			Simd::Float4 t0 = Simd::mul(Simd::sub(min[axis], start[axis]), directionInv[axis]);
+			Simd::Float4 t1 = Simd::mul(Simd::sub(max[axis], start[axis]), directionInv[axis]);
+			near = Simd::max(Simd::min(t0, t1), near);
+			far = Simd::min(Simd::max(t0, t1), far);
+		}
+		return Simd::ifLessEqual(near, far, near, Simd::splat(infinity));
+	}
+
+	// Sets r to a x b.
+	void cross(Simd::Float4 const * a, Simd::Float4 const * b, Simd::Float4 * r)
+	{
+		r[0] = Simd::sub(Simd::mul(a[1], b[2]), Simd::mul(a[2], b[1]));
+		r[1] = Simd::sub(Simd::mul(a[2], b[0]), Simd::mul(a[0], b[2]));
+		r[2] = Simd::sub(Simd::mul(a[0], b[1]), Simd::mul(a[1], b[0]));
+	}
+
+	Simd::Float4 dot(Simd::Float4 const * a, Simd::Float4 const * b)
+	{
+		return Simd::mulAdd(a[0], b[0], Simd::mulAdd(a[1], b[1], Simd::mul(a[2], b[2])));
+	}
+
+	// The same as the scalar intersect above, for one ray and four triangles, whose vertices are given one component per register.
+	Simd::Float4 intersect(Simd::Float4 const * start, Simd::Float4 const * direction, Simd::Float4 const * v0, Simd::Float4 const * v1, Simd::Float4 const * v2)
+	{
+		Simd::Float4 e1[3], e2[3], p[3], s[3], q[3];
+		for(unsigned int axis = 0; axis < 3; axis++)
+		{
+			e1[axis] = Simd::sub(v1[axis], v0[axis]);
+			e2[axis] = Simd::sub(v2[axis], v0[axis]);
+			s[axis] = Simd::sub(start[axis], v0[axis]);
+		}
+		cross(direction, e2, p);
+		Simd::Float4 detInv = Simd::div(Simd::splat(1.0f), dot(e1, p));
+		Simd::Float4 u = Simd::mul(dot(s, p), detInv);
+		cross(s, e1, q);
+		Simd::Float4 v = Simd::mul(dot(direction, q), detInv);
+		Simd::Float4 t = Simd::mul(dot(e2, q), detInv);
+		Simd::Float4 zero = Simd::splat(0.0f);
+		Simd::Float4 miss = Simd::splat(infinity);
+		Simd::Float4 r = Simd::ifLessEqual(zero, t, t, miss);
+		r = Simd::ifLessEqual(zero, u, r, miss);
+		r = Simd::ifLessEqual(zero, v, r, miss);
+		return Simd::ifLessEqual(Simd::add(u, v), Simd::splat(1.0f), r, miss);
+	}
+#endif
+}
+
+void Batch::intersectRayBoxes(Ray3f const & ray, Boxf const * boxes, float * distances, unsigned int count)
+{
+	Coord3f directionInv = inverse(ray.direction);
+	unsigned int i = 0;
+#if SIMD_ENABLED
+	Simd::Float4 start4[3], directionInv4[3];
+	for(unsigned int axis = 0; axis < 3; axis++)
+	{
+		start4[axis] = Simd::splat(ray.start[axis]);
+		directionInv4[axis] = Simd::splat(directionInv[axis]);
+	}
+	for(; i + 4 <= count; i += 4)
+	{
+		Simd::Float4 min[3], max[3];
+		loadPairs(reinterpret_cast<float const *>(boxes + i), min, max);
+		Simd::store(distances + i, intersect(start4, directionInv4, min, max));
+	}
+#endif
+	for(; i < count; i++)
+	{
+		distances[i] = intersect(ray.start, directionInv, boxes[i].min, boxes[i].max);
+	}
+}
+
+void Batch::intersectRayBoxes(Ray3f const & ray, BoxArrays const & boxes, float * distances, unsigned int count)
+{
+	Coord3f directionInv = inverse(ray.direction);
+	unsigned int i = 0;
+#if SIMD_ENABLED
+	Simd::Float4 start4[3], directionInv4[3];
+	for(unsigned int axis = 0; axis < 3; axis++)
+	{
+		start4[axis] = Simd::splat(ray.start[axis]);
+		directionInv4[axis] = Simd::splat(directionInv[axis]);
+	}
+	for(; i + 4 <= count; i += 4)
+	{
+		Simd::Float4 min[3] = {Simd::load(boxes.minX + i), Simd::load(boxes.minY + i), Simd::load(boxes.minZ + i)};
+		Simd::Float4 max[3] = {Simd::load(boxes.maxX + i), Simd::load(boxes.maxY + i), Simd::load(boxes.maxZ + i)};
+		Simd::store(distances + i, intersect(start4, directionInv4, min, max));
+	}
+#endif
+	for(; i < count; i++)
+	{
+		distances[i] = intersect(ray.start, directionInv, Coord3f{boxes.minX[i], boxes.minY[i], boxes.minZ[i]}, Coord3f{boxes.maxX[i], boxes.maxY[i], boxes.maxZ[i]});
+	}
+}
+
+void Batch::intersectRaysBox(Ray3f const * rays, Boxf const & box, float * distances, unsigned int count)
+{
+	unsigned int i = 0;
+#if SIMD_ENABLED
+	Simd::Float4 min[3], max[3];
+	for(unsigned int axis = 0; axis < 3; axis++)
+	{
+		min[axis] = Simd::splat(box.min[axis]);
+		max[axis] = Simd::splat(box.max[axis]);
+	}
+	Simd::Float4 one = Simd::splat(1.0f);
+	for(; i + 4 <= count; i += 4)
+	{
+		Simd::Float4 start[3], directionInv[3];
+		loadPairs(reinterpret_cast<float const *>(rays + i), start, directionInv);
+		for(unsigned int axis = 0; axis < 3; axis++)
+		{
+			directionInv[axis] = Simd::div(one, directionInv[axis]);
+		}
+		Simd::store(distances + i, intersect(start, directionInv, min, max));
+	}
+#endif
+	for(; i < count; i++)
+	{
+		distances[i] = intersect(rays[i].start, inverse(rays[i].direction), box.min, box.max);
+	}
+}
+
+void Batch::intersectRayTriangles(Ray3f const & ray, Coord3f const * vertices, float * distances, unsigned int count)
+{
+	unsigned int i = 0;
+#if SIMD_ENABLED
+	Simd::Float4 start[3], direction[3];
+	for(unsigned int axis = 0; axis < 3; axis++)
+	{
+		start[axis] = Simd::splat(ray.start[axis]);
+		direction[axis] = Simd::splat(ray.direction[axis]);
+	}
+	for(; i + 4 <= count; i += 4)
+	{
+		// Load the four triangles with one register for each of their nine floats. The first loads give the x, y, and z of the twelve
+		// vertices, in order, and then splitting each of those by three gives the x, y, or z of each of the three vertices.
+		Simd::Float4 x[3], y[3], z[3];
+		float const * p = vertices[3 * i].ptr();
+		for(unsigned int k = 0; k < 3; k++)
+		{
+			Simd::loadInterleaved3(p + 12 * k, x[k], y[k], z[k]);
+		}
+		Simd::Float4 v[9]; // The x, y, and z of v0, then of v1, then of v2.
+		Simd::deinterleave3(x[0], x[1], x[2], v[0], v[3], v[6]);
+		Simd::deinterleave3(y[0], y[1], y[2], v[1], v[4], v[7]);
+		Simd::deinterleave3(z[0], z[1], z[2], v[2], v[5], v[8]);
+		Simd::store(distances + i, intersect(start, direction, v + 0, v + 3, v + 6));
+	}
+#endif
+	for(; i < count; i++)
+	{
+		distances[i] = intersect(ray, vertices[3 * i], vertices[3 * i + 1], vertices[3 * i + 2]);
+	}
+}
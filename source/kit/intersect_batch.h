@@ -0,0 +1,39 @@
+#pragma once
+
+#include "ray.h"
+#include "box.h"
+
+/*
+Functions that intersect rays with many boxes or triangles, or many rays with a box, for picking and for walking bounding volume hierarchies.
+As in transform_batch.h, the inner loops work on four at a time with SIMD when it is enabled.
+Each result is the distance along the ray to the first hit, in units of the ray's direction, so the hit point is start + distance direction.
+A miss gives infinity, so the nearest hit is the smallest result. Hits behind the start of the ray are misses.
+Rays that lie exactly in the plane of a box face may or may not hit it.
+*/
+namespace Batch
+{
+	// The separate min and max arrays of many boxes.
+	class BoxArrays
+	{
+	public:
+		float const * minX;
+		float const * minY;
+		float const * minZ;
+		float const * maxX;
+		float const * maxY;
+		float const * maxZ;
+	};
+
+	// Sets distances[i] to where the ray enters boxes[i], or 0 if the start is within it. Uses the slab test.
+	void intersectRayBoxes(Ray3f const & ray, Boxf const * boxes, float * distances, unsigned int count);
+
+	// Sets distances[i] to where the ray enters the ith box, or 0 if the start is within it. Uses the slab test.
+	void intersectRayBoxes(Ray3f const & ray, BoxArrays const & boxes, float * distances, unsigned int count);
+
+	// Sets distances[i] to where rays[i] enters the box, or 0 if its start is within it. Uses the slab test.
+	void intersectRaysBox(Ray3f const * rays, Boxf const & box, float * distances, unsigned int count);
+
+	// Sets distances[i] to where the ray hits the triangle with vertices[3 i], vertices[3 i + 1], and vertices[3 i + 2], from either side.
+	// Uses the Moller-Trumbore test.
+	void intersectRayTriangles(Ray3f const & ray, Coord3f const * vertices, float * distances, unsigned int count);
+}
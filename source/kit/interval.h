@@ -8,63 +8,59 @@ class Interval
 {
 public:
 	// Constructs to all zeros.
-	Interval();
+	constexpr Interval();
 
 	// Constructs to the other.
-	Interval(Interval<dim, T> const & other);
+	constexpr Interval(Interval<dim, T> const & other);
 
 	// Constructs to min and max.
-	Interval(Coord<dim, T> min, Coord<dim, T> max);
+	constexpr Interval(Coord<dim, T> min, Coord<dim, T> max);
 
 	// Returns true if every element in v is within the corresponding dimension of the interval.
-	bool contains(Coord<dim, T> v) const;
+	constexpr bool contains(Coord<dim, T> v) const;
 
 	// Returns true if any part of the interval is within the other and vice versa.
-	bool intersects(Interval<dim, T> other) const;
+	constexpr bool intersects(Interval<dim, T> other) const;
 
 	// Returns the point closest to p within within the interval.
-	Coord<dim, T> closest(Coord<dim, T> p) const;
+	constexpr Coord<dim, T> closest(Coord<dim, T> p) const;
 
 	// Returns an interval that is the interval extended around p by decreasing the min or increasing the max, if necessary.
-	Interval<dim, T> extendedTo(Coord<dim, T> p) const;
+	constexpr Interval<dim, T> extendedTo(Coord<dim, T> p) const;
 
 	// Returns an interval that is the union of this and other.
-	Interval<dim, T> unionedWith(Interval<dim, T> const & other) const;
+	constexpr Interval<dim, T> unionedWith(Interval<dim, T> const & other) const;
 
 	// Returns an interval that is the intersection of this and other. If they do not overlap, the result is all zeros.
-	Interval<dim, T> intersectedWith(Interval<dim, T> const & other) const;
+	constexpr Interval<dim, T> intersectedWith(Interval<dim, T> const & other) const;
 
 	// Returns a position or size aligned to the interval.
-	template <typename Y> Coord<dim, T> getAligned(Coord<dim, Y> fractionOfThisSize, Coord<dim, T> offset) const;
+	template <typename Y> constexpr Coord<dim, T> getAligned(Coord<dim, Y> fractionOfThisSize, Coord<dim, T> offset) const;
 
 	// Returns an object position aligned to the interval, given the size of an object. You may want to set the size of the object first using the function above.
-	template <typename Y> Coord<dim, T> getAligned(Coord<dim, T> objectSize, Coord<dim, Y> fractionOfObjectSize, Coord<dim, Y> fractionOfThisSize, Coord<dim, T> offset) const;
+	template <typename Y> constexpr Coord<dim, T> getAligned(Coord<dim, T> objectSize, Coord<dim, Y> fractionOfObjectSize, Coord<dim, Y> fractionOfThisSize, Coord<dim, T> offset) const;
 
 	Coord<dim, T> min;
 	Coord<dim, T> max;
 };
 
 template <int dim, typename T>
-Interval<dim, T>::Interval()
+constexpr Interval<dim, T>::Interval()
 {
 }
 
 template <int dim, typename T>
-Interval<dim, T>::Interval(Interval<dim, T> const & other)
+constexpr Interval<dim, T>::Interval(Interval<dim, T> const & other) : min(other.min), max(other.max)
 {
-	min = other.min;
-	max = other.max;
 }
 
 template <int dim, typename T>
-Interval<dim, T>::Interval(Coord<dim, T> min_, Coord<dim, T> max_)
+constexpr Interval<dim, T>::Interval(Coord<dim, T> min_, Coord<dim, T> max_) : min(min_), max(max_)
 {
-	min = min_;
-	max = max_;
 }
 
 template <int dim, typename T>
-bool Interval<dim, T>::contains(Coord<dim, T> v) const
+constexpr bool Interval<dim, T>::contains(Coord<dim, T> v) const
 {
 	for(int i = 0; i < dim; ++i)
 	{
@@ -77,7 +73,7 @@ bool Interval<dim, T>::contains(Coord<dim, T> v) const
 }
 
 template <int dim, typename T>
-bool Interval<dim, T>::intersects(Interval<dim, T> other) const
+constexpr bool Interval<dim, T>::intersects(Interval<dim, T> other) const
 {
 	for(int i = 0; i < dim; ++i)
 	{
@@ -90,7 +86,7 @@ bool Interval<dim, T>::intersects(Interval<dim, T> other) const
 }
 
 template <int dim, typename T>
-Coord<dim, T> Interval<dim, T>::closest(Coord<dim, T> p) const
+constexpr Coord<dim, T> Interval<dim, T>::closest(Coord<dim, T> p) const
 {
 	Coord<dim, T> r;
 	for(int i = 0; i < dim; ++i)
@@ -112,7 +108,7 @@ Coord<dim, T> Interval<dim, T>::closest(Coord<dim, T> p) const
 }
 
 template <int dim, typename T>
-Interval<dim, T> Interval<dim, T>::extendedTo(Coord<dim, T> p) const
+constexpr Interval<dim, T> Interval<dim, T>::extendedTo(Coord<dim, T> p) const
 {
 	Interval<dim, T> r;
 	for(int i = 0; i < dim; ++i)
@@ -124,7 +120,7 @@ Interval<dim, T> Interval<dim, T>::extendedTo(Coord<dim, T> p) const
 }
 
 template <int dim, typename T>
-Interval<dim, T> Interval<dim, T>::unionedWith(Interval<dim, T> const & other) const
+constexpr Interval<dim, T> Interval<dim, T>::unionedWith(Interval<dim, T> const & other) const
 {
 	Interval<dim, T> r;
 	for(int i = 0; i < dim; ++i)
@@ -136,7 +132,7 @@ Interval<dim, T> Interval<dim, T>::unionedWith(Interval<dim, T> const & other) c
 }
 
 template <int dim, typename T>
-Interval<dim, T> Interval<dim, T>::intersectedWith(Interval<dim, T> const & other) const
+constexpr Interval<dim, T> Interval<dim, T>::intersectedWith(Interval<dim, T> const & other) const
 {
 	Interval<dim, T> r;
 	for(int i = 0; i < dim; ++i)
@@ -152,7 +148,7 @@ Interval<dim, T> Interval<dim, T>::intersectedWith(Interval<dim, T> const & othe
 }
 
 template <int dim, typename T> template <typename Y>
-Coord<dim, T> Interval<dim, T>::getAligned(Coord<dim, Y> fractionOfThisSize, Coord<dim, T> offset) const
+constexpr Coord<dim, T> Interval<dim, T>::getAligned(Coord<dim, Y> fractionOfThisSize, Coord<dim, T> offset) const
 {
 	Coord<dim, T> r;
 	for(int i = 0; i < dim; ++i)
@@ -163,7 +159,7 @@ Coord<dim, T> Interval<dim, T>::getAligned(Coord<dim, Y> fractionOfThisSize, Coo
 }
 
 template <int dim, typename T> template <typename Y>
-Coord<dim, T> Interval<dim, T>::getAligned(Coord<dim, T> objectSize, Coord<dim, Y> fractionOfObjectSize, Coord<dim, Y> fractionOfThisSize, Coord<dim, T> offset) const
+constexpr Coord<dim, T> Interval<dim, T>::getAligned(Coord<dim, T> objectSize, Coord<dim, Y> fractionOfObjectSize, Coord<dim, Y> fractionOfThisSize, Coord<dim, T> offset) const
 {
 	Coord<dim, T> r;
 	for(int i = 0; i < dim; ++i)
@@ -173,3 +169,6 @@ Coord<dim, T> Interval<dim, T>::getAligned(Coord<dim, T> objectSize, Coord<dim,
 	return r;
 }
 
+
+// Compile-time checks that the constexpr functions can be used in constant expressions.
+static_assert(Interval<2, int>(Coord2i{0, 0}, Coord2i{4, 4}).intersectedWith(Interval<2, int>(Coord2i{2, 3}, Coord2i{6, 6})).contains(Coord2i{3, 4}), "Interval must be usable in constant expressions.");
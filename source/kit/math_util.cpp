@@ -1,7 +1,16 @@
 #include "math_util.h"
+#include "random.h"
 
 namespace Math
 {
-	bool firstRandom = true;
+	int random(int min, int max)
+	{
+		return Random::local().nextInt(min, max);
+	}
+
+	float random(float min, float max)
+	{
+		return Random::local().nextFloat(min, max);
+	}
 }
 
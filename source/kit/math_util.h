@@ -2,16 +2,12 @@
 
 #include <cmath>
 #include <cassert>
-#include <cstdlib>
-#include <ctime>
 #ifndef _MSC_VER
 #include <float.h>
 #endif
 
 namespace Math
 {
-	extern bool firstRandom;
-
 	const double PI = 3.1415926535897932384626433832795; // 180 degrees
 	const double TWO_PI = 6.283185307179586476925286766559; // 360 degrees
 	const double PI_OVER_2 = 1.5707963267948966192313216916398; // 90 degrees
@@ -29,11 +25,11 @@ namespace Math
 	//! Returns the minimum of x and y
 	template <class T> T min(T x, T y);
 
-	//! Returns an int random number between min (inclusive) and max (exclusive).
-	inline int random(int min, int max);
+	//! Returns an int random number between min (inclusive) and max (exclusive). Uses the generator of the calling thread, Random::local().
+	int random(int min, int max);
 
-	//! Returns a float random number between min (inclusive) and max (inclusive). Has a resolution of (max - min) / RAND_MAX.
-	inline float random(float min, float max);
+	//! Returns a float random number between min (inclusive) and max (exclusive). Uses the generator of the calling thread, Random::local().
+	float random(float min, float max);
 
 	//! Returns the next highest power of two, given a 16 bit number.
 	template <class T> T ceilPow2(T x);
@@ -64,28 +60,6 @@ namespace Math
 		return x <= y ? x : y;
 	}
 
-	inline int random(int min, int max)
-	{
-		assert(max - min <= RAND_MAX && max > min);
-		if(firstRandom)
-		{
-			std::srand((int)(std::time(nullptr)));
-			firstRandom = false;
-		}
-		return (rand() % (max - min)) + min;
-	}
-
-	inline float random(float min, float max)
-	{
-		assert(max >= min);
-		if(firstRandom)
-		{
-			std::srand((int)(std::time(nullptr)));
-			firstRandom = false;
-		}
-		return (float)rand() * ((max - min) / (float)RAND_MAX) + min;
-	}
-
 	template <class T> T ceilPow2(T x)
 	{
 		x--;
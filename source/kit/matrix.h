@@ -7,103 +7,215 @@
 	The matrix is in column-major order. The rationale for this is that traditional mathematics uses m * v operator order, which means that,
 	for a translation matrix, the elements m(0, 3), m(1, 3), and m(2, 3) should contain the translation components. In addition, video cards
 	expect the translation components to be in elements 12, 13, and 14, which would then indicate a column-major order.
+	Everything is constexpr, so constant matrices can be computed at compile time, except for the SIMD specializations at the end, which are for
+	float 4x4 matrices and are only for run time. For float 4x4 constants, use constTranspose, constTransform, constInverse, and constMultiply,
+	which are the same as the generic templates and are always constexpr. The affine and rigid inverses have no such versions.
 */
 template <unsigned int rows, unsigned int cols, typename T>
 class Matrix
 {
 public:
-	// Default constructor.
-	Matrix();
-
-	// Copy constructor.
-	Matrix(Matrix<rows, cols, T> const & m);
+	// Default constructor. Zeroes all elements.
+	constexpr Matrix();
 
 	// Returns a matrix where each element is zero.
-	static Matrix<rows, cols, T> zero();
+	static constexpr Matrix<rows, cols, T> zero();
 
 	// Returns the identity matrix. Rows must equal cols.
-	static Matrix<rows, cols, T> identity();
+	static constexpr Matrix<rows, cols, T> identity();
 
 	// Returns a matrix equivalent to the cross product with the first operand as v.
-	static Matrix<rows, cols, T> crossProduct(Coord<rows, T> v);
+	static constexpr Matrix<rows, cols, T> crossProduct(Coord<rows, T> v);
 
 	// Access the element at row row and column col.
-	T & operator()(unsigned int row, unsigned int col);
+	constexpr T & operator()(unsigned int row, unsigned int col);
 
 	// Access the element at row row and column col.
-	T const & operator()(unsigned int row, unsigned int col) const;
+	constexpr T const & operator()(unsigned int row, unsigned int col) const;
 
 	// Access the element at index i. Remember the matrix is column-major.
-	T & operator [](unsigned int i);
+	constexpr T & operator [](unsigned int i);
 
 	// Access the element at index i. Remember the matrix is column-major.
-	T const & operator [](unsigned int i) const;
-
-	// Assignment operator.
-	Matrix<rows, cols, T> & operator = (Matrix<rows, cols, T> const & m);
+	constexpr T const & operator [](unsigned int i) const;
 
 	// Get a pointer to the elements.
-	T * ptr();
+	constexpr T * ptr();
 
 	// Get a pointer to the elements.
-	T const * ptr() const;
+	constexpr T const * ptr() const;
 
 	// Returns the transpose.
-	Matrix<cols, rows, T> transpose() const;
+	constexpr Matrix<cols, rows, T> transpose() const;
 
 	// Returns this v, extending v either as a point(v3 = 1) or direction(v3 = 0). Rows must equal cols.
-	Coord < rows - 1, T > transform(Coord < cols - 1, T > v, T v3) const;
+	constexpr Coord < rows - 1, T > transform(Coord < cols - 1, T > v, T v3) const;
 
 	// Returns v this. Used for dealing with row-major systems.
-	Coord<cols, T> preMultiply(Coord<rows, T> v) const;
+	constexpr Coord<cols, T> preMultiply(Coord<rows, T> v) const;
+
+	// Returns the inverse. Rows must equal cols and be 2, 3, or 4. Throws an exception if the matrix is singular.
+	constexpr Matrix<rows, cols, T> inverse() const;
+
+	// Returns the inverse, assuming that the bottom row is (0, ..., 0, 1), as with an affine transform. Faster than inverse.
+	// Rows must equal cols and be 3 or 4. Throws an exception if the matrix is singular.
+	constexpr Matrix<rows, cols, T> affineInverse() const;
+
+	// Returns the inverse, assuming that the bottom row is (0, ..., 0, 1) and the rest of the first rows - 1 columns is a rotation,
+	// as with a camera or entity transform without scale. Faster than affineInverse. Rows must equal cols.
+	constexpr Matrix<rows, cols, T> rigidInverse() const;
 
 private:
+	static_assert(rows > 0 && cols > 0, "A Matrix must have at least one row and column.");
+
 	T c[rows * cols];
 };
 
+typedef Matrix<2, 2, float> Matrix22f;
+typedef Matrix<2, 2, double> Matrix22d;
 typedef Matrix<3, 3, float> Matrix33f;
 typedef Matrix<3, 3, double> Matrix33d;
 typedef Matrix<4, 4, float> Matrix44f;
 typedef Matrix<4, 4, double> Matrix44d;
 
 // Returns true if each element in m0 is equal to its corresponding element in m1.
-template <unsigned int rows, unsigned int cols, typename T> bool operator == (Matrix<rows, cols, T> const & m0, Matrix<rows, cols, T> const & m1);
+template <unsigned int rows, unsigned int cols, typename T> constexpr bool operator == (Matrix<rows, cols, T> const & m0, Matrix<rows, cols, T> const & m1);
 
 // Returns true if any element in m0 is not equal to its corresponding element in m1.
-template <unsigned int rows, unsigned int cols, typename T> bool operator != (Matrix<rows, cols, T> const & m0, Matrix<rows, cols, T> const & m1);
+template <unsigned int rows, unsigned int cols, typename T> constexpr bool operator != (Matrix<rows, cols, T> const & m0, Matrix<rows, cols, T> const & m1);
 
 // Returns m0 + m1.
-template <unsigned int rows, unsigned int cols, typename T> Matrix<rows, cols, T> operator + (Matrix<rows, cols, T> const & m0, Matrix<rows, cols, T> const & m1);
+template <unsigned int rows, unsigned int cols, typename T> constexpr Matrix<rows, cols, T> operator + (Matrix<rows, cols, T> const & m0, Matrix<rows, cols, T> const & m1);
 
 // Returns m0 - m1.
-template <unsigned int rows, unsigned int cols, typename T> Matrix<rows, cols, T> operator - (Matrix<rows, cols, T> const & m0, Matrix<rows, cols, T> const & m1);
+template <unsigned int rows, unsigned int cols, typename T> constexpr Matrix<rows, cols, T> operator - (Matrix<rows, cols, T> const & m0, Matrix<rows, cols, T> const & m1);
 
 // Returns m0 m1.
-template <unsigned int rows, unsigned int mid, unsigned int cols, typename T> Matrix<rows, cols, T> operator * (Matrix<rows, mid, T> const & m0, Matrix<mid, cols, T> const & m1);
+template <unsigned int rows, unsigned int mid, unsigned int cols, typename T> constexpr Matrix<rows, cols, T> operator * (Matrix<rows, mid, T> const & m0, Matrix<mid, cols, T> const & m1);
 
 // Returns a m. There is no m a syntax to be consistent with standard mathematical formula writing order.
-template <unsigned int rows, unsigned int cols, typename T> Matrix<rows, cols, T> operator * (T a, Matrix<rows, cols, T> const & m);
+template <unsigned int rows, unsigned int cols, typename T> constexpr Matrix<rows, cols, T> operator * (T a, Matrix<rows, cols, T> const & m);
 
 // Returns m v.
-template <unsigned int rows, unsigned int cols, typename T> Coord<rows, T> operator * (Matrix<rows, cols, T> const & m, Coord<cols, T> v);
+template <unsigned int rows, unsigned int cols, typename T> constexpr Coord<rows, T> operator * (Matrix<rows, cols, T> const & m, Coord<cols, T> v);
+
+// Returns m.transpose(), but always usable in constant expressions, even for the float matrices whose transpose has a SIMD specialization.
+template <unsigned int rows, unsigned int cols, typename T> constexpr Matrix<cols, rows, T> constTranspose(Matrix<rows, cols, T> const & m);
+
+// Returns m.transform(v, v3), but always usable in constant expressions, like constTranspose.
+template <unsigned int rows, unsigned int cols, typename T> constexpr Coord < rows - 1, T > constTransform(Matrix<rows, cols, T> const & m, Coord < cols - 1, T > v, T v3);
+
+// Returns m.inverse(), but always usable in constant expressions, like constTranspose.
+template <unsigned int rows, unsigned int cols, typename T> constexpr Matrix<rows, cols, T> constInverse(Matrix<rows, cols, T> const & m);
+
+// Returns m0 m1, but always usable in constant expressions, like constTranspose.
+template <unsigned int rows, unsigned int mid, unsigned int cols, typename T> constexpr Matrix<rows, cols, T> constMultiply(Matrix<rows, mid, T> const & m0, Matrix<mid, cols, T> const & m1);
+
+// Returns m v, but always usable in constant expressions, like constTranspose.
+template <unsigned int rows, unsigned int cols, typename T> constexpr Coord<rows, T> constMultiply(Matrix<rows, cols, T> const & m, Coord<cols, T> v);
 
 // Template Implementations
 
-template <unsigned int rows, unsigned int cols, typename T>
-Matrix<rows, cols, T>::Matrix()
+template <typename T>
+constexpr Matrix<2, 2, T> _matrixInverse(Matrix<2, 2, T> const & m)
 {
-	assert(rows > 0 && cols > 0);
+	T const * a = m.ptr();
+	T det = a[0] * a[3] - a[2] * a[1];
+	if(det == 0)
+	{
+		throw std::exception();
+	}
+	T detInv = 1 / det;
+	Matrix<2, 2, T> r;
+	T * b = r.ptr();
+	b[0] = a[3] * detInv;
+	b[1] = -a[1] * detInv;
+	b[2] = -a[2] * detInv;
+	b[3] = a[0] * detInv;
+	return r;
+}
+
+template <typename T>
+constexpr Matrix<3, 3, T> _matrixInverse(Matrix<3, 3, T> const & m)
+{
+	// The inverse is the transpose of the cofactors divided by the determinant. Column-major, so a[col * 3 + row].
+	T const * a = m.ptr();
+	Matrix<3, 3, T> r;
+	T * b = r.ptr();
+	b[0] = a[4] * a[8] - a[7] * a[5];
+	b[1] = a[7] * a[2] - a[1] * a[8];
+	b[2] = a[1] * a[5] - a[4] * a[2];
+	b[3] = a[6] * a[5] - a[3] * a[8];
+	b[4] = a[0] * a[8] - a[6] * a[2];
+	b[5] = a[3] * a[2] - a[0] * a[5];
+	b[6] = a[3] * a[7] - a[6] * a[4];
+	b[7] = a[6] * a[1] - a[0] * a[7];
+	b[8] = a[0] * a[4] - a[3] * a[1];
+	T det = a[0] * b[0] + a[3] * b[1] + a[6] * b[2];
+	if(det == 0)
+	{
+		throw std::exception();
+	}
+	T detInv = 1 / det;
+	for(unsigned int i = 0; i < 9; i++)
+	{
+		b[i] *= detInv;
+	}
+	return r;
+}
+
+template <typename T>
+constexpr Matrix<4, 4, T> _matrixInverse(Matrix<4, 4, T> const & m)
+{
+	// The cofactors are built from the 2x2 determinants of the first two columns (s) and of the last two columns (c), which they share.
+	// The inverse of the transpose is the transpose of the inverse, so this works the same whether a[col * 4 + row] or a[row * 4 + col].
+	T const * a = m.ptr();
+	T s0 = a[0] * a[5] - a[4] * a[1];
+	T s1 = a[0] * a[6] - a[4] * a[2];
+	T s2 = a[0] * a[7] - a[4] * a[3];
+	T s3 = a[1] * a[6] - a[5] * a[2];
+	T s4 = a[1] * a[7] - a[5] * a[3];
+	T s5 = a[2] * a[7] - a[6] * a[3];
+	T c0 = a[8] * a[13] - a[12] * a[9];
+	T c1 = a[8] * a[14] - a[12] * a[10];
+	T c2 = a[8] * a[15] - a[12] * a[11];
+	T c3 = a[9] * a[14] - a[13] * a[10];
+	T c4 = a[9] * a[15] - a[13] * a[11];
+	T c5 = a[10] * a[15] - a[14] * a[11];
+	T det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+	if(det == 0)
+	{
+		throw std::exception();
+	}
+	T detInv = 1 / det;
+	Matrix<4, 4, T> r;
+	T * b = r.ptr();
+	b[0] = (a[5] * c5 - a[6] * c4 + a[7] * c3) * detInv;
+	b[1] = (-a[1] * c5 + a[2] * c4 - a[3] * c3) * detInv;
+	b[2] = (a[13] * s5 - a[14] * s4 + a[15] * s3) * detInv;
+	b[3] = (-a[9] * s5 + a[10] * s4 - a[11] * s3) * detInv;
+	b[4] = (-a[4] * c5 + a[6] * c2 - a[7] * c1) * detInv;
+	b[5] = (a[0] * c5 - a[2] * c2 + a[3] * c1) * detInv;
+	b[6] = (-a[12] * s5 + a[14] * s2 - a[15] * s1) * detInv;
+	b[7] = (a[8] * s5 - a[10] * s2 + a[11] * s1) * detInv;
+	b[8] = (a[4] * c4 - a[5] * c2 + a[7] * c0) * detInv;
+	b[9] = (-a[0] * c4 + a[1] * c2 - a[3] * c0) * detInv;
+	b[10] = (a[12] * s4 - a[13] * s2 + a[15] * s0) * detInv;
+	b[11] = (-a[8] * s4 + a[9] * s2 - a[11] * s0) * detInv;
+	b[12] = (-a[4] * c3 + a[5] * c1 - a[6] * c0) * detInv;
+	b[13] = (a[0] * c3 - a[1] * c1 + a[2] * c0) * detInv;
+	b[14] = (-a[12] * s3 + a[13] * s1 - a[14] * s0) * detInv;
+	b[15] = (a[8] * s3 - a[9] * s1 + a[10] * s0) * detInv;
+	return r;
 }
 
 template <unsigned int rows, unsigned int cols, typename T>
-Matrix<rows, cols, T>::Matrix(Matrix<rows, cols, T> const & m)
+constexpr Matrix<rows, cols, T>::Matrix() : c{}
 {
-	assert(rows > 0 && cols > 0);
-	*this = m;
 }
 
 template <unsigned int rows, unsigned int cols, typename T>
-Matrix<rows, cols, T> Matrix<rows, cols, T>::zero()
+constexpr Matrix<rows, cols, T> Matrix<rows, cols, T>::zero()
 {
 	Matrix<rows, cols, T> r;
 	unsigned int size = rows * cols;
@@ -115,7 +227,7 @@ Matrix<rows, cols, T> Matrix<rows, cols, T>::zero()
 }
 
 template <unsigned int rows, unsigned int cols, typename T>
-Matrix<rows, cols, T> Matrix<rows, cols, T>::identity()
+constexpr Matrix<rows, cols, T> Matrix<rows, cols, T>::identity()
 {
 	assert(rows == cols);
 	Matrix<rows, cols, T> r = zero();
@@ -128,7 +240,7 @@ Matrix<rows, cols, T> Matrix<rows, cols, T>::identity()
 }
 
 template <unsigned int rows, unsigned int cols, typename T>
-Matrix<rows, cols, T> Matrix<rows, cols, T>::crossProduct(Coord<rows, T> v)
+constexpr Matrix<rows, cols, T> Matrix<rows, cols, T>::crossProduct(Coord<rows, T> v)
 {
 	assert(rows == 3 && cols == 3);
 	Matrix<rows, cols, T> r;
@@ -145,7 +257,7 @@ Matrix<rows, cols, T> Matrix<rows, cols, T>::crossProduct(Coord<rows, T> v)
 }
 
 template <unsigned int rows, unsigned int cols, typename T>
-T & Matrix<rows, cols, T>::operator()(unsigned int row, unsigned int col)
+constexpr T & Matrix<rows, cols, T>::operator()(unsigned int row, unsigned int col)
 {
 	if(row >= rows || col >= cols)
 	{
@@ -155,7 +267,7 @@ T & Matrix<rows, cols, T>::operator()(unsigned int row, unsigned int col)
 }
 
 template <unsigned int rows, unsigned int cols, typename T>
-T const & Matrix<rows, cols, T>::operator()(unsigned int row, unsigned int col) const
+constexpr T const & Matrix<rows, cols, T>::operator()(unsigned int row, unsigned int col) const
 {
 	if(row >= rows || col >= cols)
 	{
@@ -165,7 +277,7 @@ T const & Matrix<rows, cols, T>::operator()(unsigned int row, unsigned int col)
 }
 
 template <unsigned int rows, unsigned int cols, typename T>
-T & Matrix<rows, cols, T>::operator [](unsigned int i)
+constexpr T & Matrix<rows, cols, T>::operator [](unsigned int i)
 {
 	if(i >= rows * cols)
 	{
@@ -175,7 +287,7 @@ T & Matrix<rows, cols, T>::operator [](unsigned int i)
 }
 
 template <unsigned int rows, unsigned int cols, typename T>
-T const & Matrix<rows, cols, T>::operator [](unsigned int i) const
+constexpr T const & Matrix<rows, cols, T>::operator [](unsigned int i) const
 {
 	if(i >= rows * cols)
 	{
@@ -185,90 +297,103 @@ T const & Matrix<rows, cols, T>::operator [](unsigned int i) const
 }
 
 template <unsigned int rows, unsigned int cols, typename T>
-Matrix<rows, cols, T> & Matrix<rows, cols, T>::operator = (Matrix<rows, cols, T> const & m)
+constexpr T * Matrix<rows, cols, T>::ptr()
 {
-	unsigned int size = rows * cols;
-	for(unsigned int i = 0; i < size; ++i)
-	{
-		c[i] = m.c[i];
-	}
-	return *this;
+	return c;
 }
 
 template <unsigned int rows, unsigned int cols, typename T>
-T * Matrix<rows, cols, T>::ptr()
+constexpr T const * Matrix<rows, cols, T>::ptr() const
 {
 	return c;
 }
 
 template <unsigned int rows, unsigned int cols, typename T>
-T const * Matrix<rows, cols, T>::ptr() const
+constexpr Matrix<cols, rows, T> Matrix<rows, cols, T>::transpose() const
 {
-	return c;
+	return constTranspose(*this);
 }
 
 template <unsigned int rows, unsigned int cols, typename T>
-Matrix<cols, rows, T> Matrix<rows, cols, T>::transpose() const
+constexpr Coord < rows - 1, T > Matrix<rows, cols, T>::transform(Coord < cols - 1, T > v, T v3) const
 {
-	Matrix<cols, rows, T> r;
-	for(unsigned int i = 0; i < rows; ++i)
+	return constTransform(*this, v, v3);
+}
+
+template <unsigned int rows, unsigned int cols, typename T>
+constexpr Coord<cols, T> Matrix<rows, cols, T>::preMultiply(Coord<rows, T> v) const
+{
+	Coord<cols, T> r;
+	for(int i = 0; i < cols; ++i)
 	{
-		unsigned int icols = i * cols;
-		for(unsigned int j = 0; j < cols; ++j)
+		r[i] = (T)0;
+	}
+	for(unsigned int i = 0; i < cols; ++i)
+	{
+		unsigned int irows = i * rows;
+		for(unsigned int k = 0; k < rows; ++k)
 		{
-			r(icols + j) = c[j * rows + i];
+			r[i] += v[k] * c[irows + k];
 		}
 	}
 	return r;
 }
 
 template <unsigned int rows, unsigned int cols, typename T>
-Coord < rows - 1, T > Matrix<rows, cols, T>::transform(Coord < cols - 1, T > v, T v3) const
+constexpr Matrix<rows, cols, T> Matrix<rows, cols, T>::inverse() const
 {
-	assert(rows == cols && rows > 1);
-	Coord < rows - 1, T > r;
-	for(unsigned int i = 0; i < rows - 1; ++i)
-	{
-		r[i] = (T)0;
-	}
-	for(unsigned int k = 0; k < cols - 1; ++k)
+	return constInverse(*this);
+}
+
+template <unsigned int rows, unsigned int cols, typename T>
+constexpr Matrix<rows, cols, T> Matrix<rows, cols, T>::affineInverse() const
+{
+	static_assert(rows == cols && rows >= 3 && rows <= 4, "Only 3x3 and 4x4 matrices have an affine inverse.");
+	// The inverse of [L t; 0 1] is [L^-1 -L^-1 t; 0 1].
+	unsigned int const n = rows - 1;
+	Matrix<n, n, T> linear;
+	for(unsigned int col = 0; col < n; ++col)
 	{
-		unsigned int krows = k * rows;
-		T v_k = v[k];
-		for(unsigned int i = 0; i < rows - 1; ++i)
+		for(unsigned int row = 0; row < n; ++row)
 		{
-			r[i] += c[krows + i] * v_k;
+			linear.ptr()[col * n + row] = c[col * rows + row];
 		}
 	}
-	unsigned int krows = (cols - 1) * rows;
-	for(unsigned int i = 0; i < rows - 1; i++)
+	Matrix<n, n, T> linearInv = _matrixInverse(linear);
+	Matrix<rows, cols, T> r;
+	for(unsigned int col = 0; col < n; ++col)
 	{
-		r[i] += c[krows + i] * v3;
+		for(unsigned int row = 0; row < n; ++row)
+		{
+			r.c[col * rows + row] = linearInv.ptr()[col * n + row];
+			r.c[n * rows + row] -= linearInv.ptr()[col * n + row] * c[n * rows + col];
+		}
 	}
+	r.c[n * rows + n] = 1;
 	return r;
 }
 
 template <unsigned int rows, unsigned int cols, typename T>
-Coord<cols, T> Matrix<rows, cols, T>::preMultiply(Coord<rows, T> v) const
+constexpr Matrix<rows, cols, T> Matrix<rows, cols, T>::rigidInverse() const
 {
-	Coord<cols, T> r;
-	for(int i = 0; i < cols; ++i)
-	{
-		r[i] = (T)0;
-	}
-	for(unsigned int i = 0; i < cols; ++i)
+	static_assert(rows == cols, "Only square matrices have an inverse.");
+	// The inverse of [R t; 0 1] is [R^T -R^T t; 0 1].
+	unsigned int const n = rows - 1;
+	Matrix<rows, cols, T> r;
+	for(unsigned int col = 0; col < n; ++col)
 	{
-		unsigned int irows = i * rows;
-		for(unsigned int k = 0; k < rows; ++k)
+		for(unsigned int row = 0; row < n; ++row)
 		{
-			r[i] += v[k] * c[irows + k];
+			r.c[col * rows + row] = c[row * rows + col];
+			r.c[n * rows + row] -= c[row * rows + col] * c[n * rows + col];
 		}
 	}
+	r.c[n * rows + n] = 1;
 	return r;
 }
 
 template <unsigned int rows, unsigned int cols, typename T>
-bool operator == (Matrix<rows, cols, T> const & m0, Matrix<rows, cols, T> const & m1)
+constexpr bool operator == (Matrix<rows, cols, T> const & m0, Matrix<rows, cols, T> const & m1)
 {
 	unsigned int size = rows * cols;
 	for(unsigned int i = 0; i < size; ++i)
@@ -282,13 +407,13 @@ bool operator == (Matrix<rows, cols, T> const & m0, Matrix<rows, cols, T> const
 }
 
 template <unsigned int rows, unsigned int cols, typename T>
-bool operator != (Matrix<rows, cols, T> const & m0, Matrix<rows, cols, T> const & m1)
+constexpr bool operator != (Matrix<rows, cols, T> const & m0, Matrix<rows, cols, T> const & m1)
 {
 	return !(m0 == m1);
 }
 
 template <unsigned int rows, unsigned int cols, typename T>
-Matrix<rows, cols, T> operator + (Matrix<rows, cols, T> const & m0, Matrix<rows, cols, T> const & m1)
+constexpr Matrix<rows, cols, T> operator + (Matrix<rows, cols, T> const & m0, Matrix<rows, cols, T> const & m1)
 {
 	Matrix<rows, cols, T> r;
 	unsigned int size = rows * cols;
@@ -300,7 +425,7 @@ Matrix<rows, cols, T> operator + (Matrix<rows, cols, T> const & m0, Matrix<rows,
 }
 
 template <unsigned int rows, unsigned int cols, typename T>
-Matrix<rows, cols, T> operator - (Matrix<rows, cols, T> const & m0, Matrix<rows, cols, T> const & m1)
+constexpr Matrix<rows, cols, T> operator - (Matrix<rows, cols, T> const & m0, Matrix<rows, cols, T> const & m1)
 {
 	Matrix<rows, cols, T> r;
 	unsigned int size = rows * cols;
@@ -312,7 +437,7 @@ Matrix<rows, cols, T> operator - (Matrix<rows, cols, T> const & m0, Matrix<rows,
 }
 
 template <unsigned int rows, unsigned int mid, unsigned int cols, typename T>
-Matrix<rows, cols, T> operator * (Matrix<rows, mid, T> const & m0, Matrix<mid, cols, T> const & m1)
+constexpr Matrix<rows, cols, T> operator * (Matrix<rows, mid, T> const & m0, Matrix<mid, cols, T> const & m1)
 {
 	Matrix<rows, cols, T> r;
 	for(unsigned int j = 0; j < cols; ++j)
@@ -337,7 +462,7 @@ Matrix<rows, cols, T> operator * (Matrix<rows, mid, T> const & m0, Matrix<mid, c
 }
 
 template <unsigned int rows, unsigned int cols, typename T>
-Matrix<rows, cols, T> operator * (T a, Matrix<rows, cols, T> const & m)
+constexpr Matrix<rows, cols, T> operator * (T a, Matrix<rows, cols, T> const & m)
 {
 	Matrix<rows, cols, T> r;
 	unsigned int size = rows * cols;
@@ -349,7 +474,7 @@ Matrix<rows, cols, T> operator * (T a, Matrix<rows, cols, T> const & m)
 }
 
 template <unsigned int rows, unsigned int cols, typename T>
-Coord<rows, T> operator * (Matrix<rows, cols, T> const & m, Coord<cols, T> v)
+constexpr Coord<rows, T> operator * (Matrix<rows, cols, T> const & m, Coord<cols, T> v)
 {
 	Coord<rows, T> r;
 	for(unsigned int i = 0; i < rows; ++i)
@@ -368,3 +493,258 @@ Coord<rows, T> operator * (Matrix<rows, cols, T> const & m, Coord<cols, T> v)
 	return r;
 }
 
+template <unsigned int rows, unsigned int cols, typename T>
+constexpr Matrix<cols, rows, T> constTranspose(Matrix<rows, cols, T> const & m)
+{
+	T const * a = m.ptr();
+	Matrix<cols, rows, T> r;
+	T * rc = r.ptr();
+	for(unsigned int i = 0; i < rows; ++i)
+	{
+		unsigned int icols = i * cols;
+		for(unsigned int j = 0; j < cols; ++j)
+		{
+			rc[icols + j] = a[j * rows + i];
+		}
+	}
+	return r;
+}
+
+template <unsigned int rows, unsigned int cols, typename T>
+constexpr Coord < rows - 1, T > constTransform(Matrix<rows, cols, T> const & m, Coord < cols - 1, T > v, T v3)
+{
+	assert(rows == cols && rows > 1);
+	T const * a = m.ptr();
+	T const * vc = v.ptr();
+	Coord < rows - 1, T > r;
+	T * rc = r.ptr();
+	for(unsigned int i = 0; i < rows - 1; ++i)
+	{
+		rc[i] = (T)0;
+	}
+	for(unsigned int k = 0; k < cols - 1; ++k)
+	{
+		unsigned int krows = k * rows;
+		T v_k = vc[k];
+		for(unsigned int i = 0; i < rows - 1; ++i)
+		{
+			rc[i] += a[krows + i] * v_k;
+		}
+	}
+	unsigned int krows = (cols - 1) * rows;
+	for(unsigned int i = 0; i < rows - 1; i++)
+	{
+		rc[i] += a[krows + i] * v3;
+	}
+	return r;
+}
+
+template <unsigned int rows, unsigned int cols, typename T>
+constexpr Matrix<rows, cols, T> constInverse(Matrix<rows, cols, T> const & m)
+{
+	static_assert(rows == cols && rows >= 2 && rows <= 4, "Only 2x2, 3x3, and 4x4 matrices have an inverse.");
+	return _matrixInverse(m);
+}
+
+template <unsigned int rows, unsigned int mid, unsigned int cols, typename T>
+constexpr Matrix<rows, cols, T> constMultiply(Matrix<rows, mid, T> const & m0, Matrix<mid, cols, T> const & m1)
+{
+	// The explicit template arguments skip the non-template SIMD overload.
+	return operator *<rows, mid, cols, T>(m0, m1);
+}
+
+template <unsigned int rows, unsigned int cols, typename T>
+constexpr Coord<rows, T> constMultiply(Matrix<rows, cols, T> const & m, Coord<cols, T> v)
+{
+	return operator *<rows, cols, T>(m, v);
+}
+
+#if SIMD_ENABLED
+
+// SIMD Specializations. They have the same behavior as the generic templates above.
+
+template <>
+inline Matrix<4, 4, float> Matrix<4, 4, float>::transpose() const
+{
+	Simd::Float4 c0 = Simd::load(c + 0);
+	Simd::Float4 c1 = Simd::load(c + 4);
+	Simd::Float4 c2 = Simd::load(c + 8);
+	Simd::Float4 c3 = Simd::load(c + 12);
+	Simd::transpose(c0, c1, c2, c3);
+	Matrix<4, 4, float> r;
+	Simd::store(r.c + 0, c0);
+	Simd::store(r.c + 4, c1);
+	Simd::store(r.c + 8, c2);
+	Simd::store(r.c + 12, c3);
+	return r;
+}
+
+template <>
+inline Coord<3, float> Matrix<4, 4, float>::transform(Coord<3, float> v, float v3) const
+{
+	Simd::Float4 r = Simd::mul(Simd::load(c + 0), Simd::splat(v[0]));
+	r = Simd::mulAdd(Simd::load(c + 4), Simd::splat(v[1]), r);
+	r = Simd::mulAdd(Simd::load(c + 8), Simd::splat(v[2]), r);
+	r = Simd::mulAdd(Simd::load(c + 12), Simd::splat(v3), r);
+	Coord<3, float> result;
+	Simd::store3(result.ptr(), r);
+	return result;
+}
+
+// Returns a b, where each 2x2 matrix is a register of (m00, m01, m10, m11).
+inline Simd::Float4 _mat2Mul(Simd::Float4 a, Simd::Float4 b)
+{
+	return Simd::mulAdd(a, Simd::shuffle<0, 3, 0, 3>(b, b), Simd::mul(Simd::shuffle<1, 0, 3, 2>(a, a), Simd::shuffle<2, 1, 2, 1>(b, b)));
+}
+
+// Returns adj(a) b, where adj(a) is the adjugate, the inverse times the determinant.
+inline Simd::Float4 _mat2AdjMul(Simd::Float4 a, Simd::Float4 b)
+{
+	return Simd::sub(Simd::mul(Simd::shuffle<3, 3, 0, 0>(a, a), b), Simd::mul(Simd::shuffle<1, 1, 2, 2>(a, a), Simd::shuffle<2, 3, 0, 1>(b, b)));
+}
+
+// Returns a adj(b).
+inline Simd::Float4 _mat2MulAdj(Simd::Float4 a, Simd::Float4 b)
+{
+	return Simd::sub(Simd::mul(a, Simd::shuffle<3, 0, 3, 0>(b, b)), Simd::mul(Simd::shuffle<1, 0, 3, 2>(a, a), Simd::shuffle<2, 1, 2, 1>(b, b)));
+}
+
+// Returns the inverse of an affine matrix with the given translation, when the rows of the inverse of its linear part are r0, r1, and r2, each with a w of 0.
+inline Matrix<4, 4, float> _affineInverseFromRows(Simd::Float4 r0, Simd::Float4 r1, Simd::Float4 r2, float const * translation)
+{
+	// The inverse's translation is -L^-1 t, the columns of L^-1 weighted by -t, plus the w of 1.
+	Simd::Float4 r3 = Simd::splat(0.0f);
+	Simd::transpose(r0, r1, r2, r3);
+	float const w[4] = {0, 0, 0, 1};
+	Simd::Float4 translationInv = Simd::sub(Simd::load(w), Simd::mul(r0, Simd::splat(translation[0])));
+	translationInv = Simd::sub(translationInv, Simd::mul(r1, Simd::splat(translation[1])));
+	translationInv = Simd::sub(translationInv, Simd::mul(r2, Simd::splat(translation[2])));
+	Matrix<4, 4, float> r;
+	float * rc = r.ptr();
+	Simd::store(rc + 0, r0);
+	Simd::store(rc + 4, r1);
+	Simd::store(rc + 8, r2);
+	Simd::store(rc + 12, translationInv);
+	return r;
+}
+
+template <>
+inline Matrix<4, 4, float> Matrix<4, 4, float>::inverse() const
+{
+	// The matrix is split into the 2x2 blocks [A B; C D], and the inverse is built from their adjugates and determinants.
+	// Each block is a register. As with the generic version, the order of rows and columns doesn't matter.
+	Simd::Float4 c0 = Simd::load(c + 0);
+	Simd::Float4 c1 = Simd::load(c + 4);
+	Simd::Float4 c2 = Simd::load(c + 8);
+	Simd::Float4 c3 = Simd::load(c + 12);
+	Simd::Float4 a = Simd::shuffle<0, 1, 0, 1>(c0, c1);
+	Simd::Float4 b = Simd::shuffle<2, 3, 2, 3>(c0, c1);
+	Simd::Float4 cc = Simd::shuffle<0, 1, 0, 1>(c2, c3);
+	Simd::Float4 d = Simd::shuffle<2, 3, 2, 3>(c2, c3);
+	float blockDets[4]; // The determinants of a, b, cc, and d.
+	Simd::store(blockDets, Simd::sub(Simd::mul(Simd::shuffle<0, 2, 0, 2>(c0, c2), Simd::shuffle<1, 3, 1, 3>(c1, c3)),
+		Simd::mul(Simd::shuffle<1, 3, 1, 3>(c0, c2), Simd::shuffle<0, 2, 0, 2>(c1, c3))));
+	Simd::Float4 detA = Simd::splat(blockDets[0]);
+	Simd::Float4 detB = Simd::splat(blockDets[1]);
+	Simd::Float4 detC = Simd::splat(blockDets[2]);
+	Simd::Float4 detD = Simd::splat(blockDets[3]);
+	Simd::Float4 adjDc = _mat2AdjMul(d, cc);
+	Simd::Float4 adjAb = _mat2AdjMul(a, b);
+	// The adjugates of the blocks of the inverse, before dividing by the determinant.
+	Simd::Float4 x = Simd::sub(Simd::mul(detD, a), _mat2Mul(b, adjDc));
+	Simd::Float4 w = Simd::sub(Simd::mul(detA, d), _mat2Mul(cc, adjAb));
+	Simd::Float4 y = Simd::sub(Simd::mul(detB, cc), _mat2MulAdj(d, adjAb));
+	Simd::Float4 z = Simd::sub(Simd::mul(detC, b), _mat2MulAdj(a, adjDc));
+	float trace = Simd::sum(Simd::mul(adjAb, Simd::shuffle<0, 2, 1, 3>(adjDc, adjDc)));
+	float det = blockDets[0] * blockDets[3] + blockDets[1] * blockDets[2] - trace;
+	if(det == 0)
+	{
+		throw std::exception();
+	}
+	float detInv = 1 / det;
+	float const signedDetInv[4] = {detInv, -detInv, -detInv, detInv}; // Turns the adjugates back into the blocks.
+	Simd::Float4 scale = Simd::load(signedDetInv);
+	x = Simd::mul(x, scale);
+	y = Simd::mul(y, scale);
+	z = Simd::mul(z, scale);
+	w = Simd::mul(w, scale);
+	Matrix<4, 4, float> r;
+	Simd::store(r.c + 0, Simd::shuffle<3, 1, 3, 1>(x, y));
+	Simd::store(r.c + 4, Simd::shuffle<2, 0, 2, 0>(x, y));
+	Simd::store(r.c + 8, Simd::shuffle<3, 1, 3, 1>(z, w));
+	Simd::store(r.c + 12, Simd::shuffle<2, 0, 2, 0>(z, w));
+	return r;
+}
+
+template <>
+inline Matrix<4, 4, float> Matrix<4, 4, float>::affineInverse() const
+{
+	// The rows of the inverse of the linear part are the cross products of its columns divided by the determinant.
+	Simd::Float4 c0 = Simd::load(c + 0);
+	Simd::Float4 c1 = Simd::load(c + 4);
+	Simd::Float4 c2 = Simd::load(c + 8);
+	Simd::Float4 r0 = Simd::cross(c1, c2);
+	Simd::Float4 r1 = Simd::cross(c2, c0);
+	Simd::Float4 r2 = Simd::cross(c0, c1);
+	float det = Simd::sum(Simd::mul(c0, r0));
+	if(det == 0)
+	{
+		throw std::exception();
+	}
+	Simd::Float4 detInv = Simd::splat(1 / det);
+	return _affineInverseFromRows(Simd::mul(r0, detInv), Simd::mul(r1, detInv), Simd::mul(r2, detInv), c + 12);
+}
+
+template <>
+inline Matrix<4, 4, float> Matrix<4, 4, float>::rigidInverse() const
+{
+	// The rows of the inverse of a rotation are its columns.
+	return _affineInverseFromRows(Simd::load(c + 0), Simd::load(c + 4), Simd::load(c + 8), c + 12);
+}
+
+// Returns m0 m1. Each column of the result is the columns of m0 weighted by a column of m1.
+inline Matrix<4, 4, float> operator * (Matrix<4, 4, float> const & m0, Matrix<4, 4, float> const & m1)
+{
+	float const * a = m0.ptr();
+	float const * b = m1.ptr();
+	Simd::Float4 a0 = Simd::load(a + 0);
+	Simd::Float4 a1 = Simd::load(a + 4);
+	Simd::Float4 a2 = Simd::load(a + 8);
+	Simd::Float4 a3 = Simd::load(a + 12);
+	Matrix<4, 4, float> r;
+	float * rc = r.ptr();
+	for(unsigned int j = 0; j < 16; j += 4)
+	{
+		Simd::Float4 column = Simd::mul(a0, Simd::splat(b[j + 0]));
+		column = Simd::mulAdd(a1, Simd::splat(b[j + 1]), column);
+		column = Simd::mulAdd(a2, Simd::splat(b[j + 2]), column);
+		column = Simd::mulAdd(a3, Simd::splat(b[j + 3]), column);
+		Simd::store(rc + j, column);
+	}
+	return r;
+}
+
+// Returns m v.
+inline Coord<4, float> operator * (Matrix<4, 4, float> const & m, Coord<4, float> v)
+{
+	float const * a = m.ptr();
+	Simd::Float4 r = Simd::mul(Simd::load(a + 0), Simd::splat(v[0]));
+	r = Simd::mulAdd(Simd::load(a + 4), Simd::splat(v[1]), r);
+	r = Simd::mulAdd(Simd::load(a + 8), Simd::splat(v[2]), r);
+	r = Simd::mulAdd(Simd::load(a + 12), Simd::splat(v[3]), r);
+	Coord<4, float> result;
+	Simd::store(result.ptr(), r);
+	return result;
+}
+
+#endif
+
+// Compile-time checks that the constexpr functions can be used in constant expressions.
+static_assert(Matrix33d::identity() * Coord3d{1, 2, 3} == Coord3d{1, 2, 3}, "Matrix must be usable in constant expressions.");
+static_assert((Matrix33d::crossProduct(Coord3d{1, 0, 0}) * Coord3d{0, 1, 0}) == Coord3d{0, 0, 1}, "Matrix must be usable in constant expressions.");
+static_assert(Matrix44d::identity().transpose() * (2.0 * Matrix44d::identity()) == 2.0 * Matrix44d::identity(), "Matrix must be usable in constant expressions.");
+static_assert((2.0 * Matrix44d::identity()).inverse() * (2.0 * Matrix44d::identity()) == Matrix44d::identity(), "Matrix must be usable in constant expressions.");
+static_assert(Matrix33d::identity().affineInverse() == Matrix33d::identity().rigidInverse(), "Matrix must be usable in constant expressions.");
+static_assert(constMultiply(Matrix44f::identity(), 2.0f * Matrix44f::identity()) == 2.0f * Matrix44f::identity(), "Matrix must be usable in constant expressions.");
+static_assert(constMultiply(constTranspose(Matrix44f::identity()), Coord4f{1, 2, 3, 4}) == Coord4f{1, 2, 3, 4}, "Matrix must be usable in constant expressions.");
+static_assert(constTransform(constInverse(2.0f * Matrix44f::identity()), Coord3f{2, 4, 6}, 0.0f) == Coord3f{1, 2, 3}, "Matrix must be usable in constant expressions.");
@@ -1,122 +1,515 @@
 #pragma once
 
 #include "ptr.h"
-#include <map>
+#include "worker_pool.h"
+#include <unordered_map>
+#include <unordered_set>
+#include <list>
+#include <limits>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
-// Generic object cache.
+// Generic object cache. Names are interned into Keys, so a caller can get the Key for a name once and then do lookups without hashing or comparing strings.
+// Each object has a byte cost, and when the total goes over the budget, the least recently used objects that aren't referenced outside of the cache are evicted.
+// The cache is told when the last Ptr to an object is dropped, so it keeps a list of the unreferenced objects and evicting never passes over objects that are in use.
+// Objects can also be loaded in the background with loadAsync. Except for the work done by loadAsync's prepare function, the cache must only be used from one thread.
 template <typename Object>
 class ObjectCache
 {
 public:
+	// An interned name. It is only a pointer to the cache's copy of the name, so it is cheap to copy, hash, and compare.
+	// A Key is only valid with the cache that made it, and it stays valid for the life of that cache, even after its object is cleaned.
+	class Key
+	{
+	public:
+		// Constructs to a key that refers to no name.
+		Key();
+
+		// Returns true if this refers to a name.
+		bool isValid() const;
+
+		// Returns the name. The key must be valid.
+		std::string const & getName() const;
+
+		// Returns true if the keys refer to the same name.
+		bool operator == (Key const & key) const;
+
+	private:
+		std::string const * name;
+
+		template <typename Y> friend class ObjectCache;
+	};
+
+	// Counters of how the cache has been used.
+	class Stats
+	{
+	public:
+		unsigned int hits = 0; // Number of get or load calls that found the object.
+		unsigned int misses = 0; // Number of get or load calls that didn't find the object.
+		unsigned int loads = 0; // Number of objects constructed by load.
+		unsigned int evictions = 0; // Number of objects evicted to keep under the budget.
+		double loadSeconds = 0; // Total time spent constructing objects in load and finishLoads. The background work of loadAsync isn't included.
+	};
+
 	// Constructor. O(1)
 	ObjectCache();
 
-	// Destructor. Cleans. Throws an exception if it still has any objects. O(number of loaded objects)
+	// Destructor. Waits for any background loads, then cleans. Throws an exception if it still has any objects. O(number of loaded objects)
 	~ObjectCache();
 
-	// Returns true if an object with the given name is in the cache. O(log number of loaded objects)
+	// Returns the key for the name, interning the name if it is new. O(length of name)
+	Key getKey(std::string const & name);
+
+	// Returns true if an object with the given key is in the cache. O(1)
+	bool has(Key const & key) const;
+
+	// Returns true if an object with the given name is in the cache. O(length of name)
 	bool has(std::string const & name) const;
 
-	// Returns a Ptr of the object of the given name. If an object with the given name isn't already in the cache, throws an exception. O(log number of loaded objects)
+	// Returns a Ptr of the object of the given key. If an object with the given key isn't already in the cache, throws an exception. O(1)
+	Ptr<Object> get(Key const & key) const;
+
+	// Returns a Ptr of the object of the given name. If an object with the given name isn't already in the cache, throws an exception. O(length of name)
 	Ptr<Object> get(std::string const & name) const;
 
-	// Returns a Ptr of the object of the given name. If an object with the given name isn't already in the cache, loads the object. O(log number of loaded objects)
-	template <typename... Args> Ptr<Object> load(std::string const & name, Args... args);
+	// Returns a Ptr of the object of the given key. If an object with the given key isn't already in the cache, loads the object. O(1), plus the construction.
+	template <typename... Args> Ptr<Object> load(Key const & key, Args && ... args);
 
-	// Removes and destroys the objects that aren't referenced outside of the cache. O(number of loaded objects).
+	// Returns a Ptr of the object of the given name. If an object with the given name isn't already in the cache, loads the object. O(length of name), plus the construction.
+	template <typename... Args> Ptr<Object> load(std::string const & name, Args && ... args);
+
+	// Adds an already constructed object under the given name and returns a Ptr to it. An AtomicOwnPtr made on a loader thread can be moved in once that thread is done with it. If an object with the given name is already in the cache, throws an exception. O(length of name)
+	Ptr<Object> add(std::string const & name, OwnPtr<Object> object);
+
+	// Sets the pool that loadAsync runs its work on. The pool must outlive the cache.
+	void setWorkerPool(Ptr<WorkerPool> pool);
+
+	// Starts loading an object in the background and returns its key, which can be polled with has, isLoading, and getLoadError. O(length of name)
+	// Prepare runs on a worker thread and returns the data that the object is made from, like decoded pixels or a parsed file.
+	// Finish then runs in finishLoads, on the thread that owns the GL context, and constructs the object from the data.
+	// If the object is already in the cache or being loaded, nothing new is started, so duplicate requests share one load. A failed load is started again.
+	template <typename Data> Key loadAsync(std::string const & name, std::function<Data ()> prepare, std::function<OwnPtr<Object> (Data & data)> finish);
+
+	// Returns true if an object with the given key is being loaded in the background. O(1)
+	bool isLoading(Key const & key) const;
+
+	// Constructs the objects whose background work is done and adds them to the cache. Call it regularly (e.g. every frame) from the GL thread.
+	// Returns the number of objects added. The errors of those that failed to load are kept for getLoadError.
+	unsigned int finishLoads();
+
+	// Returns the error of the last background load of the key, or an empty string if it didn't fail. The error is kept until the key is loaded again. O(1)
+	std::string const & getLoadError(Key const & key) const;
+
+	// Removes and destroys the objects that aren't referenced outside of the cache. O(number of unreferenced objects).
 	void clean();
 
+	// Sets the function that returns the byte cost of an object. It is called once when the object is added. Without one, every object costs 1, so the budget is a number of objects.
+	void setCostFunction(std::function<size_t (Object const & object)> function);
+
+	// Sets the budget in bytes and evicts objects until the cache is under it. The default is no limit.
+	void setBudget(size_t bytes);
+
+	// Returns the budget in bytes.
+	size_t getBudget() const;
+
+	// Returns the total byte cost of the objects in the cache.
+	size_t getCost() const;
+
 	// Gets a list of objects in the cache by name.
 	std::vector<std::string> getObjectKeys();
 
+	// Returns the counters of how the cache has been used.
+	Stats const & getStats() const;
+
+	// Resets the counters to zero.
+	void resetStats();
+
 private:
-	std::map<std::string, OwnPtr<Object>> objects;
+	class KeyHash
+	{
+	public:
+		size_t operator () (Key const & key) const;
+	};
+
+	// An object in the cache, with its cost and place in the usage order.
+	class Entry
+	{
+	public:
+		OwnPtr<Object> object;
+		size_t cost;
+		mutable typename std::list<Key>::iterator usage; // The end of the usage order while the object is referenced.
+		ObjectCache * cache; // For unreferenced.
+		Key key; // For unreferenced.
+	};
+
+	// A load whose background work is done, waiting for finishLoads.
+	class FinishedLoad
+	{
+	public:
+		Key key;
+		std::function<OwnPtr<Object> ()> finish;
+		std::string error;
+	};
+
+	Key findKey(std::string const & name) const;
+
+	// Adds the object to the cache as the most recently used. The key must not already have an object.
+	Ptr<Object> insert(Key const & key, OwnPtr<Object> object);
+
+	// Removes the entry from the cache and the usage order.
+	void remove(typename std::unordered_map<Key, Entry, KeyHash>::iterator it);
+
+	// Takes the entry out of the usage order, since a Ptr to it is being handed out. O(1)
+	void markReferenced(Entry const & entry) const;
+
+	// Called by the entry's object when its last Ptr is dropped. Adds the entry to the most recently used end of the usage order. O(1)
+	static void unreferenced(void * entry);
+
+	// Evicts unreferenced objects, least recently used first, until the cost is within the budget. O(number evicted)
+	void evict();
+
+	std::unordered_set<std::string> names; // The interned names. They are never removed, so that keys stay valid.
+	std::unordered_map<Key, Entry, KeyHash> objects;
+	mutable std::list<Key> usage; // The keys of the unreferenced objects, from least to most recently used.
+	std::function<size_t (Object const & object)> costFunction;
+	size_t cost;
+	size_t budget;
+	mutable Stats stats;
+
+	Ptr<WorkerPool> workerPool;
+	std::unordered_set<Key, KeyHash> loading; // Keys given to loadAsync that finishLoads hasn't handled yet.
+	std::unordered_map<Key, std::string, KeyHash> loadErrors; // The errors of the background loads that failed.
+	std::vector<FinishedLoad> finishedLoads; // Filled by the worker threads. Guarded by finishedLoadsMutex.
+	std::mutex finishedLoadsMutex;
+	std::condition_variable loadFinished;
 };
 
 // Template Implementations
 
+template <typename Object>
+ObjectCache<Object>::Key::Key()
+{
+	name = nullptr;
+}
+
+template <typename Object>
+bool ObjectCache<Object>::Key::isValid() const
+{
+	return name != nullptr;
+}
+
+template <typename Object>
+std::string const & ObjectCache<Object>::Key::getName() const
+{
+	if(name == nullptr)
+	{
+		throw std::runtime_error("Invalid cache key.");
+	}
+	return *name;
+}
+
+template <typename Object>
+bool ObjectCache<Object>::Key::operator == (Key const & key) const
+{
+	return name == key.name;
+}
+
 template <typename Object>
 ObjectCache<Object>::ObjectCache()
 {
+	cost = 0;
+	budget = std::numeric_limits<size_t>::max();
 }
 
 template <typename Object>
 ObjectCache<Object>::~ObjectCache()
 {
+	{
+		// The workers refer to this cache, so wait for them. Their objects are dropped.
+		std::unique_lock<std::mutex> lock(finishedLoadsMutex);
+		loadFinished.wait(lock, [this]()
+		{
+			return finishedLoads.size() == loading.size();
+		});
+		finishedLoads.clear();
+		loading.clear();
+	}
 	clean();
 	if(!objects.empty())
 	{
 		std::string message = "There are still objects referenced:\n";
 		for(auto const & pair : objects)
 		{
-			message += pair.first + "\n";
+			message += *pair.first.name + "\n";
 		}
 		throw std::runtime_error(message);
 	}
 }
 
+template <typename Object>
+typename ObjectCache<Object>::Key ObjectCache<Object>::getKey(std::string const & name)
+{
+	Key key;
+	key.name = &*names.insert(name).first;
+	return key;
+}
+
+template <typename Object>
+bool ObjectCache<Object>::has(Key const & key) const
+{
+	return objects.find(key) != objects.end();
+}
+
 template <typename Object>
 bool ObjectCache<Object>::has(std::string const & name) const
 {
-	return objects.find(name) != objects.end();
+	return has(findKey(name));
 }
 
 template <typename Object>
-Ptr<Object> ObjectCache<Object>::get(std::string const & name) const
+Ptr<Object> ObjectCache<Object>::get(Key const & key) const
 {
-	auto it = objects.find(name);
+	auto it = objects.find(key);
 	if(it != objects.end())
 	{
-		return it->second;
+		stats.hits++;
+		markReferenced(it->second);
+		return it->second.object;
 	}
 	else
 	{
+		stats.misses++;
+		throw std::runtime_error("'" + (key.isValid() ? *key.name : std::string()) + "' was not found in the cache.");
+	}
+}
+
+template <typename Object>
+Ptr<Object> ObjectCache<Object>::get(std::string const & name) const
+{
+	Key key = findKey(name);
+	if(!key.isValid())
+	{
+		stats.misses++;
 		throw std::runtime_error("'" + name + "' was not found in the cache.");
 	}
+	return get(key);
 }
 
 template <typename Object>
 template <typename... Args>
-Ptr<Object> ObjectCache<Object>::load(std::string const & name, Args... args)
+Ptr<Object> ObjectCache<Object>::load(Key const & key, Args && ... args)
 {
-	auto it = objects.find(name);
+	if(!key.isValid())
+	{
+		throw std::runtime_error("Invalid cache key.");
+	}
+	auto it = objects.find(key);
 	if(it != objects.end())
 	{
-		return it->second;
+		stats.hits++;
+		markReferenced(it->second);
+		return it->second.object;
 	}
 	else
 	{
+		stats.misses++;
 		OwnPtr<Object> object;
+		auto start = std::chrono::steady_clock::now();
 		try
 		{
-			object.setNew(args...);
+			object.setNew(std::forward<Args>(args)...);
 		}
 		catch(std::runtime_error const & e)
 		{
-			throw std::runtime_error("Error while constructing '" + name + "': " + e.what());
+			throw std::runtime_error("Error while constructing '" + *key.name + "': " + e.what());
 		}
-		objects[name] = object;
-		return object;
+		stats.loads++;
+		stats.loadSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		Ptr<Object> ptr = insert(key, std::move(object));
+		evict(); // The new object is referenced by ptr, so it stays.
+		return ptr;
 	}
 }
 
 template <typename Object>
-void ObjectCache<Object>::clean()
+template <typename... Args>
+Ptr<Object> ObjectCache<Object>::load(std::string const & name, Args && ... args)
+{
+	return load(getKey(name), std::forward<Args>(args)...);
+}
+
+template <typename Object>
+Ptr<Object> ObjectCache<Object>::add(std::string const & name, OwnPtr<Object> object)
+{
+	if(!object.isValid())
+	{
+		throw std::runtime_error("'" + name + "' is not a valid object.");
+	}
+	Key key = getKey(name);
+	if(has(key))
+	{
+		throw std::runtime_error("'" + name + "' is already in the cache.");
+	}
+	Ptr<Object> ptr = insert(key, std::move(object));
+	evict();
+	return ptr;
+}
+
+template <typename Object>
+void ObjectCache<Object>::setWorkerPool(Ptr<WorkerPool> pool)
+{
+	workerPool = pool;
+}
+
+template <typename Object>
+template <typename Data>
+typename ObjectCache<Object>::Key ObjectCache<Object>::loadAsync(std::string const & name, std::function<Data ()> prepare, std::function<OwnPtr<Object> (Data & data)> finish)
 {
-	for(auto it = objects.begin(); it != objects.end();)
+	if(!workerPool.isValid())
 	{
-		if(!it->second.isReferenced())
+		throw std::runtime_error("Could not load '" + name + "' in the background, since the cache has no worker pool.");
+	}
+	Key key = getKey(name);
+	if(has(key) || isLoading(key))
+	{
+		stats.hits++;
+		return key;
+	}
+	stats.misses++;
+	loadErrors.erase(key);
+	loading.insert(key);
+	workerPool->run([this, key, prepare, finish]()
+	{
+		FinishedLoad finishedLoad;
+		finishedLoad.key = key;
+		try
+		{
+			// The data is made on this thread and used on the GL thread, so its counts must be atomic.
+			AtomicOwnPtr<Data> data = AtomicOwnPtr<Data>::createNew(prepare());
+			finishedLoad.finish = [data, finish]()
+			{
+				return finish(*data);
+			};
+		}
+		catch(std::exception const & e)
+		{
+			finishedLoad.error = e.what();
+		}
+		catch(...)
+		{
+			finishedLoad.error = "Unknown error.";
+		}
+		std::lock_guard<std::mutex> lock(finishedLoadsMutex);
+		finishedLoads.push_back(std::move(finishedLoad));
+		loadFinished.notify_all();
+	});
+	return key;
+}
+
+template <typename Object>
+bool ObjectCache<Object>::isLoading(Key const & key) const
+{
+	return loading.find(key) != loading.end();
+}
+
+template <typename Object>
+unsigned int ObjectCache<Object>::finishLoads()
+{
+	if(loading.empty())
+	{
+		return 0;
+	}
+	std::vector<FinishedLoad> loads;
+	{
+		std::lock_guard<std::mutex> lock(finishedLoadsMutex);
+		loads.swap(finishedLoads);
+		for(FinishedLoad const & load : loads)
+		{
+			loading.erase(load.key);
+		}
+	}
+	std::vector<Ptr<Object>> added; // Keeps the new objects referenced so that the evict below doesn't remove them.
+	for(FinishedLoad & load : loads)
+	{
+		if(has(load.key))
+		{
+			continue; // It was loaded with load while the background work was going on.
+		}
+		if(load.error.empty())
 		{
-			it = objects.erase(it);
+			auto start = std::chrono::steady_clock::now();
+			try
+			{
+				OwnPtr<Object> object = load.finish();
+				if(!object.isValid())
+				{
+					throw std::runtime_error("No object was made.");
+				}
+				added.push_back(insert(load.key, std::move(object)));
+				stats.loads++;
+				stats.loadSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			}
+			catch(std::exception const & e)
+			{
+				load.error = e.what();
+			}
 		}
-		else
+		if(!load.error.empty())
 		{
-			it++;
+			loadErrors[load.key] = "Error while constructing '" + *load.key.name + "': " + load.error;
 		}
 	}
+	evict();
+	return (unsigned int)added.size();
+}
+
+template <typename Object>
+std::string const & ObjectCache<Object>::getLoadError(Key const & key) const
+{
+	static std::string const noError;
+	auto it = loadErrors.find(key);
+	return it != loadErrors.end() ? it->second : noError;
+}
+
+template <typename Object>
+void ObjectCache<Object>::clean()
+{
+	// Destroying an object can drop its Ptrs to other objects here, which adds them to the usage order, so they are removed too.
+	while(!usage.empty())
+	{
+		remove(objects.find(usage.front()));
+	}
+}
+
+template <typename Object>
+void ObjectCache<Object>::setCostFunction(std::function<size_t (Object const & object)> function)
+{
+	costFunction = function;
+}
+
+template <typename Object>
+void ObjectCache<Object>::setBudget(size_t bytes)
+{
+	budget = bytes;
+	evict();
+}
+
+template <typename Object>
+size_t ObjectCache<Object>::getBudget() const
+{
+	return budget;
+}
+
+template <typename Object>
+size_t ObjectCache<Object>::getCost() const
+{
+	return cost;
 }
 
 template <typename Object>
@@ -125,8 +518,92 @@ std::vector<std::string> ObjectCache<Object>::getObjectKeys()
 	std::vector<std::string> keys;
 	for(auto const & pair : objects)
 	{
-		keys.push_back(pair.first);
+		keys.push_back(*pair.first.name);
 	}
 	return keys;
 }
 
+template <typename Object>
+typename ObjectCache<Object>::Stats const & ObjectCache<Object>::getStats() const
+{
+	return stats;
+}
+
+template <typename Object>
+void ObjectCache<Object>::resetStats()
+{
+	stats = Stats();
+}
+
+template <typename Object>
+size_t ObjectCache<Object>::KeyHash::operator () (Key const & key) const
+{
+	return std::hash<std::string const *>()(key.name);
+}
+
+template <typename Object>
+Ptr<Object> ObjectCache<Object>::insert(Key const & key, OwnPtr<Object> object)
+{
+	Entry entry;
+	entry.cost = costFunction ? costFunction(*object) : 1;
+	entry.object = std::move(object);
+	entry.usage = usage.end();
+	entry.cache = this;
+	entry.key = key;
+	loadErrors.erase(key); // It may have failed in the background before being loaded another way.
+	Entry & inserted = objects[key];
+	inserted = std::move(entry);
+	cost += inserted.cost;
+	// The entries of an unordered_map don't move, so the entry can be the context. It joins the usage order when the returned Ptr is dropped.
+	inserted.object.setUnreferencedFunction(&unreferenced, &inserted);
+	return inserted.object;
+}
+
+template <typename Object>
+void ObjectCache<Object>::remove(typename std::unordered_map<Key, Entry, KeyHash>::iterator it)
+{
+	cost -= it->second.cost;
+	markReferenced(it->second);
+	it->second.object.setUnreferencedFunction(nullptr, nullptr);
+	objects.erase(it);
+}
+
+template <typename Object>
+void ObjectCache<Object>::markReferenced(Entry const & entry) const
+{
+	if(entry.usage != usage.end())
+	{
+		usage.erase(entry.usage);
+		entry.usage = usage.end();
+	}
+}
+
+template <typename Object>
+void ObjectCache<Object>::unreferenced(void * entry)
+{
+	Entry * e = static_cast<Entry *>(entry);
+	e->usage = e->cache->usage.insert(e->cache->usage.end(), e->key);
+}
+
+template <typename Object>
+void ObjectCache<Object>::evict()
+{
+	// Only unreferenced objects are in the usage order, so when everything is in use, this does nothing.
+	while(cost > budget && !usage.empty())
+	{
+		remove(objects.find(usage.front()));
+		stats.evictions++;
+	}
+}
+
+template <typename Object>
+typename ObjectCache<Object>::Key ObjectCache<Object>::findKey(std::string const & name) const
+{
+	Key key;
+	auto it = names.find(name);
+	if(it != names.end())
+	{
+		key.name = &*it;
+	}
+	return key;
+}
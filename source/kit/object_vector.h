@@ -1,80 +1,123 @@
 #pragma once
 
-#include <list>
-#include <unordered_set>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
 #include <functional>
 
+/*
+A vector of items that can be removed from while it is being iterated over.
+The items are contiguous in memory. Removing an item only marks it, and the item stays in place until processRemoves is called, so iterators stay valid and
+loops over the items see every item, even those removed during the loop. Use isRemoved to skip them. Marking an item by its iterator with removeAt is O(1).
+By default processRemoves moves the last items into the removed places, which is O(number of removes) but changes the order.
+In stable order mode, processRemoves keeps the order of the remaining items, which is O(number of items).
+Adding or inserting items invalidates iterators, as with a std::vector, so it shouldn't be done while iterating.
+*/
 template <typename T>
 class ObjectVector
 {
 public:
+	typedef typename std::vector<T>::iterator iterator;
+	typedef typename std::vector<T>::const_iterator const_iterator;
+	typedef typename std::vector<T>::reverse_iterator reverse_iterator;
+	typedef typename std::vector<T>::const_reverse_iterator const_reverse_iterator;
+
 	// Default constructor.
 	ObjectVector();
 
 	// Initializer list constructor.
 	ObjectVector(std::initializer_list<T> il);
 
-	// Finds an element based on another type.
+	// Sets whether processRemoves keeps the order of the remaining items. Default is false.
+	void setStableOrder(bool stableOrder);
+
+	// Returns true if processRemoves keeps the order of the remaining items.
+	bool isStableOrder() const;
+
+	// Finds an item that isn't removed, based on another type. Throws an exception if not found. O(number of items)
 	template <typename Y> T & find(Y const & item);
 
-	// Finds an element based on another type.
+	// Finds an item that isn't removed, based on another type. Throws an exception if not found. O(number of items)
 	template <typename Y> T const & find(Y const & item) const;
 
-	// Adds an item at the end.
+	// Adds an item at the end. O(1) amortized.
 	void add(T const & item);
 
-	// Inserts an item before another item.
+	// Inserts an item before another item. O(number of items)
 	template <typename Y> void insertBefore(Y const & beforeItem, T const & item);
 
-	// Removes an item.
+	// Marks an item for removal, based on another type, and returns it. Throws an exception if not found. O(number of items)
 	template <typename Y> T const & remove(Y const & item);
 
-	// Removes all items.
+	// Marks the item at the iterator for removal. O(1)
+	void removeAt(const_iterator it);
+
+	// Returns true if the item at the iterator is marked for removal. O(1)
+	bool isRemoved(const_iterator it) const;
+
+	// Marks all items for removal. O(number of items)
 	void clear();
 
-	// Processes any removes that have accumulated since the last call.
+	// Removes the items that have been marked since the last call.
 	void processRemoves();
 
+	// Returns the number of items, including those marked for removal. O(1)
+	unsigned int size() const;
+
+	// Returns true if there are no items, including those marked for removal. O(1)
+	bool empty() const;
+
 	// The iterators.
-	typename std::list<T>::iterator begin();
-	typename std::list<T>::iterator end();
-	typename std::list<T>::const_iterator begin() const;
-	typename std::list<T>::const_iterator end() const;
-	typename std::list<T>::reverse_iterator rbegin();
-	typename std::list<T>::reverse_iterator rend();
-	typename std::list<T>::const_reverse_iterator rbegin() const;
-	typename std::list<T>::const_reverse_iterator rend() const;
+	iterator begin();
+	iterator end();
+	const_iterator begin() const;
+	const_iterator end() const;
+	reverse_iterator rbegin();
+	reverse_iterator rend();
+	const_reverse_iterator rbegin() const;
+	const_reverse_iterator rend() const;
 
 private:
-	class IteratorHash;
-	std::list<T> items;
-	std::unordered_set<typename std::list<T>::const_iterator, IteratorHash> removes;
+	std::vector<T> items;
+	std::vector<bool> removed; // Whether each item is marked for removal.
+	std::vector<unsigned int> removes; // The indices of the items marked for removal.
+	bool stableOrder;
 };
 
-// Internal Implementation
+// Template Implementation
 
 template <typename T>
 ObjectVector<T>::ObjectVector()
 {
+	stableOrder = false;
 }
 
 template <typename T>
-ObjectVector<T>::ObjectVector(std::initializer_list<T> il)
+ObjectVector<T>::ObjectVector(std::initializer_list<T> il) : items(il), removed(il.size(), false)
 {
-	for(auto const & item : il)
-	{
-		items.push_back(item);
-	}
+	stableOrder = false;
+}
+
+template <typename T>
+void ObjectVector<T>::setStableOrder(bool stableOrder_)
+{
+	stableOrder = stableOrder_;
+}
+
+template <typename T>
+bool ObjectVector<T>::isStableOrder() const
+{
+	return stableOrder;
 }
 
 template <typename T> template <typename Y>
 T & ObjectVector<T>::find(Y const & item)
 {
-	for(auto & t : items)
+	for(unsigned int i = 0; i < items.size(); i++)
 	{
-		if(t == item)
+		if(!removed[i] && items[i] == item)
 		{
-			return t;
+			return items[i];
 		}
 	}
 	throw std::exception();
@@ -83,11 +126,11 @@ T & ObjectVector<T>::find(Y const & item)
 template <typename T> template <typename Y>
 T const & ObjectVector<T>::find(Y const & item) const
 {
-	for(auto const & t : items)
+	for(unsigned int i = 0; i < items.size(); i++)
 	{
-		if(t == item)
+		if(!removed[i] && items[i] == item)
 		{
-			return t;
+			return items[i];
 		}
 	}
 	throw std::exception();
@@ -97,16 +140,33 @@ template <typename T>
 void ObjectVector<T>::add(T const & item)
 {
 	items.push_back(item);
+	try
+	{
+		removed.push_back(false);
+	}
+	catch(...)
+	{
+		items.pop_back();
+		throw;
+	}
 }
 
 template <typename T> template <typename Y>
 void ObjectVector<T>::insertBefore(Y const & beforeItem, T const & item)
 {
-	for(auto it = items.begin(); it != items.end(); ++it)
+	for(unsigned int i = 0; i < items.size(); i++)
 	{
-		if(*it == beforeItem)
+		if(!removed[i] && items[i] == beforeItem)
 		{
-			items.insert(it, item);
+			items.insert(items.begin() + i, item);
+			removed.insert(removed.begin() + i, false);
+			for(auto & index : removes)
+			{
+				if(index >= i)
+				{
+					index++;
+				}
+			}
 			return;
 		}
 	}
@@ -116,91 +176,140 @@ void ObjectVector<T>::insertBefore(Y const & beforeItem, T const & item)
 template <typename T> template <typename Y>
 T const & ObjectVector<T>::remove(Y const & item)
 {
-	for(auto it = items.begin(); it != items.end(); ++it)
+	for(unsigned int i = 0; i < items.size(); i++)
 	{
-		if(*it == item)
+		if(!removed[i] && items[i] == item)
 		{
-			removes.insert(it);
-			return *it;
+			removeAt(items.cbegin() + i);
+			return items[i];
 		}
 	}
 	throw std::exception();
 }
 
+template <typename T>
+void ObjectVector<T>::removeAt(const_iterator it)
+{
+	unsigned int index = (unsigned int)(it - items.cbegin());
+	if(!removed[index])
+	{
+		removes.push_back(index);
+		removed[index] = true;
+	}
+}
+
+template <typename T>
+bool ObjectVector<T>::isRemoved(const_iterator it) const
+{
+	return removed[it - items.cbegin()];
+}
+
 template <typename T>
 void ObjectVector<T>::clear()
 {
-	for(auto it = items.begin(); it != items.end(); ++it)
+	for(auto it = items.cbegin(); it != items.cend(); ++it)
 	{
-		removes.push_back(it);
+		removeAt(it);
 	}
 }
 
 template <typename T>
 void ObjectVector<T>::processRemoves()
 {
-	for(auto it : removes)
+	if(removes.empty())
+	{
+		return;
+	}
+	if(stableOrder)
+	{
+		// Shift the kept items down over the removed ones, starting at the first removed one.
+		unsigned int first = *std::min_element(removes.begin(), removes.end());
+		unsigned int kept = first;
+		for(unsigned int i = first; i < items.size(); i++)
+		{
+			if(!removed[i])
+			{
+				items[kept] = std::move(items[i]);
+				kept++;
+			}
+		}
+		items.erase(items.begin() + kept, items.end());
+		removed.assign(items.size(), false);
+	}
+	else
 	{
-		l.erase(it);
+		// Going from the back, so that the last item is never one still to be removed.
+		std::sort(removes.begin(), removes.end(), std::greater<unsigned int>());
+		for(auto index : removes)
+		{
+			if(index != items.size() - 1)
+			{
+				items[index] = std::move(items.back());
+				removed[index] = false;
+			}
+			items.pop_back();
+			removed.pop_back();
+		}
 	}
 	removes.clear();
 }
 
 template <typename T>
-typename std::list<T>::iterator ObjectVector<T>::begin()
+unsigned int ObjectVector<T>::size() const
+{
+	return (unsigned int)items.size();
+}
+
+template <typename T>
+bool ObjectVector<T>::empty() const
+{
+	return items.empty();
+}
+
+template <typename T>
+typename ObjectVector<T>::iterator ObjectVector<T>::begin()
 {
 	return items.begin();
 }
 
 template <typename T>
-typename std::list<T>::iterator ObjectVector<T>::end()
+typename ObjectVector<T>::iterator ObjectVector<T>::end()
 {
 	return items.end();
 }
 
 template <typename T>
-typename std::list<T>::const_iterator ObjectVector<T>::begin() const
+typename ObjectVector<T>::const_iterator ObjectVector<T>::begin() const
 {
 	return items.cbegin();
 }
 
 template <typename T>
-typename std::list<T>::const_iterator ObjectVector<T>::end() const
+typename ObjectVector<T>::const_iterator ObjectVector<T>::end() const
 {
 	return items.cend();
 }
 
 template <typename T>
-typename std::list<T>::reverse_iterator ObjectVector<T>::rbegin()
+typename ObjectVector<T>::reverse_iterator ObjectVector<T>::rbegin()
 {
 	return items.rbegin();
 }
 
 template <typename T>
-typename std::list<T>::reverse_iterator ObjectVector<T>::rend()
+typename ObjectVector<T>::reverse_iterator ObjectVector<T>::rend()
 {
 	return items.rend();
 }
 
 template <typename T>
-typename std::list<T>::const_reverse_iterator ObjectVector<T>::rbegin() const
+typename ObjectVector<T>::const_reverse_iterator ObjectVector<T>::rbegin() const
 {
 	return items.crbegin();
 }
 
 template <typename T>
-typename std::list<T>::const_reverse_iterator ObjectVector<T>::rend() const
+typename ObjectVector<T>::const_reverse_iterator ObjectVector<T>::rend() const
 {
 	return items.crend();
 }
-
-template <typename T>
-class ObjectVector<T>::IteratorHash
-{
-public:
-	size_t operator () (typename std::list<T>::const_iterator const & it)
-	{
-		return (unsigned int)(*it);
-	}
-};
-
@@ -0,0 +1,124 @@
+#include "packed.h"
+#include <cstring>
+
+namespace
+{
+	uint32_t bitsOf(float f)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &f, sizeof(bits));
+		return bits;
+	}
+
+	float floatOf(uint32_t bits)
+	{
+		float f;
+		std::memcpy(&f, &bits, sizeof(f));
+		return f;
+	}
+
+	// Returns f clamped to [min, max]. A NaN becomes min, as with the SIMD versions.
+	float clamp(float f, float min, float max)
+	{
+		f = f > min ? f : min;
+		return f < max ? f : max;
+	}
+
+	// Returns the nearest integer to f, rounding to even.
+	int roundToInt(float f)
+	{
+		return (int)std::nearbyint(f);
+	}
+}
+
+Half::Half(float f)
+{
+	// The bit manipulation of Fabian Giesen's float_to_half_fast3_rtne. The SIMD version in packed_batch.cpp matches it.
+	uint32_t sign = bitsOf(f) & 0x80000000u;
+	uint32_t abs = bitsOf(f) ^ sign;
+	uint32_t r;
+	if(abs >= (127u + 16u) << 23) // Infinity or NaN, or too large for a half.
+	{
+		r = abs > 0x7f800000u ? 0x7e00u : 0x7c00u;
+	}
+	else if(abs < 113u << 23) // Subnormal or zero. Adding 0.5 aligns the bits at the bottom of the float and rounds to even.
+	{
+		r = bitsOf(floatOf(abs) + 0.5f) - bitsOf(0.5f);
+	}
+	else // Normal. Rebias the exponent and round to even.
+	{
+		r = (abs - (112u << 23) + 0xfffu + ((abs >> 13) & 1u)) >> 13;
+	}
+	bits = (uint16_t)(r | (sign >> 16));
+}
+
+Half::operator float () const
+{
+	// Shifting the bits into place and scaling by 2^112 rebiases the exponent and handles subnormals. Infinity and NaN need their exponent set.
+	uint32_t expMant = bits & 0x7fffu;
+	uint32_t sign = (uint32_t)(bits ^ expMant) << 16;
+	uint32_t scaled = bitsOf(floatOf(expMant << 13) * floatOf((254u - 15u) << 23));
+	uint32_t infNan = expMant > 0x7bffu ? 255u << 23 : 0u;
+	return floatOf(scaled | sign | infNan);
+}
+
+Snorm16::Snorm16(float f)
+{
+	value = (int16_t)roundToInt(clamp(f, -1.0f, 1.0f) * 32767.0f);
+}
+
+Snorm16::operator float () const
+{
+	float f = (float)value / 32767.0f;
+	return f > -1.0f ? f : -1.0f;
+}
+
+Unorm16::Unorm16(float f)
+{
+	value = (uint16_t)roundToInt(clamp(f, 0.0f, 1.0f) * 65535.0f);
+}
+
+Unorm16::operator float () const
+{
+	return (float)value / 65535.0f;
+}
+
+Unorm8::Unorm8(float f)
+{
+	value = (uint8_t)roundToInt(clamp(f, 0.0f, 1.0f) * 255.0f);
+}
+
+Unorm8::operator float () const
+{
+	return (float)value / 255.0f;
+}
+
+Octahedral::Octahedral(Coord3f vector)
+{
+	// Project onto the octahedron |x| + |y| + |z| = 1, and fold the lower half over the upper half along its edges.
+	float l1 = std::abs(vector[0]) + std::abs(vector[1]) + std::abs(vector[2]);
+	float x = vector[0] / l1;
+	float y = vector[1] / l1;
+	if(vector[2] < 0)
+	{
+		float foldedX = std::copysign(1.0f - std::abs(y), x);
+		float foldedY = std::copysign(1.0f - std::abs(x), y);
+		x = foldedX;
+		y = foldedY;
+	}
+	u = Snorm16(x);
+	v = Snorm16(y);
+}
+
+Octahedral::operator Coord3f () const
+{
+	// Unfold, which moves points with a negative z back across the edges, and normalize.
+	float x = (float)u;
+	float y = (float)v;
+	float z = 1.0f - std::abs(x) - std::abs(y);
+	float t = -z > 0 ? -z : 0;
+	x -= std::copysign(t, x);
+	y -= std::copysign(t, y);
+	float n = std::sqrt(x * x + (y * y + z * z));
+	return Coord3f{x / n, y / n, z / n};
+}
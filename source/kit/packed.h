@@ -0,0 +1,105 @@
+#pragma once
+
+#include "coord.h"
+#include <cstdint>
+
+/*
+Compact storage types for vertex data and assets, used as the element type of a Coord, as in Coord<3, Half> or Coord<4, Unorm8>.
+They have no arithmetic. Convert to and from float with the explicit constructors and casts, which also make the converting Coord
+constructor work, or in bulk with the functions in packed_batch.h. Each type has the same layout as the matching OpenGL vertex attribute type.
+*/
+
+// An IEEE 754 half-precision float, with 11 bits of precision and a range of +-65504.
+class Half
+{
+public:
+	// Default constructor. Sets to zero.
+	constexpr Half() : bits(0) {}
+
+	// Constructs from the nearest half to f, rounding to even. Values beyond the range of a half become infinity.
+	explicit Half(float f);
+
+	// Returns the float with the same value.
+	explicit operator float () const;
+
+	// The bits, as stored in memory.
+	uint16_t bits;
+};
+
+// A float in [-1, 1] stored as a 16 bit signed integer, as value / 32767.
+class Snorm16
+{
+public:
+	// Default constructor. Sets to zero.
+	constexpr Snorm16() : value(0) {}
+
+	// Constructs from the nearest value to f, rounding to even. Values outside of [-1, 1] are clamped.
+	explicit Snorm16(float f);
+
+	// Returns the float. Both -32768 and -32767 are -1.
+	explicit operator float () const;
+
+	// The integer, as stored in memory.
+	int16_t value;
+};
+
+// A float in [0, 1] stored as a 16 bit unsigned integer, as value / 65535.
+class Unorm16
+{
+public:
+	// Default constructor. Sets to zero.
+	constexpr Unorm16() : value(0) {}
+
+	// Constructs from the nearest value to f, rounding to even. Values outside of [0, 1] are clamped.
+	explicit Unorm16(float f);
+
+	// Returns the float.
+	explicit operator float () const;
+
+	// The integer, as stored in memory.
+	uint16_t value;
+};
+
+// A float in [0, 1] stored as an 8 bit unsigned integer, as value / 255. Used for colors.
+class Unorm8
+{
+public:
+	// Default constructor. Sets to zero.
+	constexpr Unorm8() : value(0) {}
+
+	// Constructs from the nearest value to f, rounding to even. Values outside of [0, 1] are clamped.
+	explicit Unorm8(float f);
+
+	// Returns the float.
+	explicit operator float () const;
+
+	// The integer, as stored in memory.
+	uint8_t value;
+};
+
+// A unit vector in four bytes. The vector is projected onto an octahedron, whose lower half is folded over the upper half,
+// and the resulting two coordinates are stored as Snorm16s. The angular error is less than 0.04 degrees. Used for normals and tangents.
+class Octahedral
+{
+public:
+	// Default constructor. Sets to the z axis.
+	constexpr Octahedral() {}
+
+	// Constructs from the unit vector, which must not be zero.
+	explicit Octahedral(Coord3f vector);
+
+	// Returns the unit vector.
+	explicit operator Coord3f () const;
+
+	// The two coordinates on the folded octahedron.
+	Snorm16 u;
+	Snorm16 v;
+};
+
+typedef Coord<2, Half> Coord2h;
+typedef Coord<3, Half> Coord3h;
+typedef Coord<4, Half> Coord4h;
+typedef Coord<2, Unorm16> Coord2un16;
+typedef Coord<3, Snorm16> Coord3sn16;
+typedef Coord<4, Snorm16> Coord4sn16;
+typedef Coord<4, Unorm8> Coord4un8;
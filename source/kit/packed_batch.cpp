@@ -0,0 +1,471 @@
+#include "packed_batch.h"
+#include <cstring>
+
+static_assert(sizeof(Half) == 2 && sizeof(Snorm16) == 2 && sizeof(Unorm16) == 2 && sizeof(Unorm8) == 1, "The storage types must be tightly packed.");
+static_assert(sizeof(Octahedral) == 4, "Octahedral arrays must be tightly packed Snorm16 pairs.");
+static_assert(sizeof(Coord3f) == 3 * sizeof(float), "Coord3f arrays must be tightly packed floats.");
+
+#if SIMD_ENABLED
+
+namespace
+{
+	// Four int32s and the few operations the conversions need.
+#if defined(SIMD_SSE)
+	typedef __m128i Int4;
+
+	Int4 splatInt(int32_t x)
+	{
+		return _mm_set1_epi32(x);
+	}
+
+	Int4 bitsOf(Simd::Float4 a)
+	{
+		return _mm_castps_si128(a);
+	}
+
+	Simd::Float4 floatOf(Int4 a)
+	{
+		return _mm_castsi128_ps(a);
+	}
+
+	Int4 add(Int4 a, Int4 b)
+	{
+		return _mm_add_epi32(a, b);
+	}
+
+	Int4 sub(Int4 a, Int4 b)
+	{
+		return _mm_sub_epi32(a, b);
+	}
+
+	Int4 bitAnd(Int4 a, Int4 b)
+	{
+		return _mm_and_si128(a, b);
+	}
+
+	Int4 bitOr(Int4 a, Int4 b)
+	{
+		return _mm_or_si128(a, b);
+	}
+
+	Int4 bitXor(Int4 a, Int4 b)
+	{
+		return _mm_xor_si128(a, b);
+	}
+
+	template <int k> Int4 shiftLeft(Int4 a)
+	{
+		return _mm_slli_epi32(a, k);
+	}
+
+	// Shifts in zeros.
+	template <int k> Int4 shiftRight(Int4 a)
+	{
+		return _mm_srli_epi32(a, k);
+	}
+
+	// Returns all ones where a > b and zeros elsewhere.
+	Int4 greaterThan(Int4 a, Int4 b)
+	{
+		return _mm_cmpgt_epi32(a, b);
+	}
+
+	// Returns a where the mask is all ones and b where it is zeros.
+	Int4 select(Int4 mask, Int4 a, Int4 b)
+	{
+		return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+	}
+
+	// Returns (a0, b0, a1, b1).
+	Int4 zipLow(Int4 a, Int4 b)
+	{
+		return _mm_unpacklo_epi32(a, b);
+	}
+
+	// Returns (a2, b2, a3, b3).
+	Int4 zipHigh(Int4 a, Int4 b)
+	{
+		return _mm_unpackhi_epi32(a, b);
+	}
+
+	// Returns the nearest integers, rounding to even.
+	Int4 roundToInt(Simd::Float4 a)
+	{
+		return _mm_cvtps_epi32(a);
+	}
+
+	Simd::Float4 toFloat(Int4 a)
+	{
+		return _mm_cvtepi32_ps(a);
+	}
+
+	Int4 loadInt16(void const * p)
+	{
+		Int4 a = _mm_loadl_epi64((__m128i const *)p);
+		return _mm_srai_epi32(_mm_unpacklo_epi16(a, a), 16);
+	}
+
+	Int4 loadUInt16(void const * p)
+	{
+		return _mm_unpacklo_epi16(_mm_loadl_epi64((__m128i const *)p), _mm_setzero_si128());
+	}
+
+	Int4 loadUInt8(void const * p)
+	{
+		int32_t x;
+		std::memcpy(&x, p, sizeof(x));
+		Int4 zero = _mm_setzero_si128();
+		return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(x), zero), zero);
+	}
+
+	// Stores the low 16 bits of each.
+	void store16(void * p, Int4 a)
+	{
+		a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16); // Sign extend, so that the saturating pack keeps the bits.
+		_mm_storel_epi64((__m128i *)p, _mm_packs_epi32(a, a));
+	}
+
+	// Stores each, which must be in [0, 255], as a byte.
+	void store8(void * p, Int4 a)
+	{
+		a = _mm_packs_epi32(a, a);
+		int32_t x = _mm_cvtsi128_si32(_mm_packus_epi16(a, a));
+		std::memcpy(p, &x, sizeof(x));
+	}
+#else
+	typedef int32x4_t Int4;
+
+	Int4 splatInt(int32_t x)
+	{
+		return vdupq_n_s32(x);
+	}
+
+	Int4 bitsOf(Simd::Float4 a)
+	{
+		return vreinterpretq_s32_f32(a);
+	}
+
+	Simd::Float4 floatOf(Int4 a)
+	{
+		return vreinterpretq_f32_s32(a);
+	}
+
+	Int4 add(Int4 a, Int4 b)
+	{
+		return vaddq_s32(a, b);
+	}
+
+	Int4 sub(Int4 a, Int4 b)
+	{
+		return vsubq_s32(a, b);
+	}
+
+	Int4 bitAnd(Int4 a, Int4 b)
+	{
+		return vandq_s32(a, b);
+	}
+
+	Int4 bitOr(Int4 a, Int4 b)
+	{
+		return vorrq_s32(a, b);
+	}
+
+	Int4 bitXor(Int4 a, Int4 b)
+	{
+		return veorq_s32(a, b);
+	}
+
+	template <int k> Int4 shiftLeft(Int4 a)
+	{
+		return vshlq_n_s32(a, k);
+	}
+
+	template <int k> Int4 shiftRight(Int4 a)
+	{
+		return vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(a), k));
+	}
+
+	Int4 greaterThan(Int4 a, Int4 b)
+	{
+		return vreinterpretq_s32_u32(vcgtq_s32(a, b));
+	}
+
+	Int4 select(Int4 mask, Int4 a, Int4 b)
+	{
+		return vbslq_s32(vreinterpretq_u32_s32(mask), a, b);
+	}
+
+	Int4 zipLow(Int4 a, Int4 b)
+	{
+		return vzipq_s32(a, b).val[0];
+	}
+
+	Int4 zipHigh(Int4 a, Int4 b)
+	{
+		return vzipq_s32(a, b).val[1];
+	}
+
+	Int4 roundToInt(Simd::Float4 a)
+	{
+		return vcvtnq_s32_f32(a);
+	}
+
+	Simd::Float4 toFloat(Int4 a)
+	{
+		return vcvtq_f32_s32(a);
+	}
+
+	Int4 loadInt16(void const * p)
+	{
+		return vmovl_s16(vld1_s16((int16_t const *)p));
+	}
+
+	Int4 loadUInt16(void const * p)
+	{
+		return vreinterpretq_s32_u32(vmovl_u16(vld1_u16((uint16_t const *)p)));
+	}
+
+	Int4 loadUInt8(void const * p)
+	{
+		uint32_t x;
+		std::memcpy(&x, p, sizeof(x));
+		return vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(x))))));
+	}
+
+	void store16(void * p, Int4 a)
+	{
+		vst1_s16((int16_t *)p, vmovn_s32(a));
+	}
+
+	void store8(void * p, Int4 a)
+	{
+		uint16x4_t h = vmovn_u32(vreinterpretq_u32_s32(a));
+		uint32_t x = vget_lane_u32(vreinterpret_u32_u8(vmovn_u16(vcombine_u16(h, h))), 0);
+		std::memcpy(p, &x, sizeof(x));
+	}
+#endif
+
+	// The same as the Half constructor, for four floats.
+	Int4 toHalf(Simd::Float4 f)
+	{
+		Int4 abs = bitAnd(bitsOf(f), splatInt(0x7fffffff));
+		Int4 sign = bitXor(bitsOf(f), abs);
+		Int4 infNan = select(greaterThan(abs, splatInt(0x7f800000)), splatInt(0x7e00), splatInt(0x7c00));
+		Int4 subnormal = sub(bitsOf(Simd::add(floatOf(abs), Simd::splat(0.5f))), bitsOf(Simd::splat(0.5f)));
+		Int4 normal = add(add(abs, splatInt(0xfff - (112 << 23))), bitAnd(shiftRight<13>(abs), splatInt(1)));
+		normal = shiftRight<13>(normal);
+		Int4 r = select(greaterThan(splatInt(113 << 23), abs), subnormal, normal);
+		r = select(greaterThan(splatInt((127 + 16) << 23), abs), r, infNan);
+		return bitOr(r, shiftRight<16>(sign));
+	}
+
+	// The same as the Half cast to float, for four halves.
+	Simd::Float4 fromHalf(Int4 h)
+	{
+		Int4 expMant = bitAnd(h, splatInt(0x7fff));
+		Int4 sign = shiftLeft<16>(bitXor(h, expMant));
+		Int4 scaled = bitsOf(Simd::mul(floatOf(shiftLeft<13>(expMant)), floatOf(splatInt((254 - 15) << 23))));
+		Int4 infNan = bitAnd(greaterThan(expMant, splatInt(0x7bff)), splatInt(255 << 23));
+		return floatOf(bitOr(scaled, bitOr(sign, infNan)));
+	}
+
+	// The same as the Snorm16 constructor, for four floats.
+	Int4 toSnorm16(Simd::Float4 f)
+	{
+		Simd::Float4 clamped = Simd::min(Simd::max(f, Simd::splat(-1.0f)), Simd::splat(1.0f));
+		return roundToInt(Simd::mul(clamped, Simd::splat(32767.0f)));
+	}
+
+	// The same as the Snorm16 cast to float, for four Snorm16s.
+	Simd::Float4 fromSnorm16(Int4 a)
+	{
+		return Simd::max(Simd::div(toFloat(a), Simd::splat(32767.0f)), Simd::splat(-1.0f));
+	}
+
+	// Returns f clamped to [0, 1], scaled by max, and rounded, as with the Unorm16 and Unorm8 constructors.
+	Int4 toUnorm(Simd::Float4 f, float max)
+	{
+		Simd::Float4 clamped = Simd::min(Simd::max(f, Simd::splat(0.0f)), Simd::splat(1.0f));
+		return roundToInt(Simd::mul(clamped, Simd::splat(max)));
+	}
+
+	Simd::Float4 abs(Simd::Float4 a)
+	{
+		return Simd::mulSign(a, a);
+	}
+}
+
+#endif
+
+void Batch::pack(float const * values, Half * results, unsigned int count)
+{
+	unsigned int i = 0;
+#if SIMD_ENABLED
+	for(; i + 4 <= count; i += 4)
+	{
+		store16(results + i, toHalf(Simd::load(values + i)));
+	}
+#endif
+	for(; i < count; i++)
+	{
+		results[i] = Half(values[i]);
+	}
+}
+
+void Batch::unpack(Half const * values, float * results, unsigned int count)
+{
+	unsigned int i = 0;
+#if SIMD_ENABLED
+	for(; i + 4 <= count; i += 4)
+	{
+		Simd::store(results + i, fromHalf(loadUInt16(values + i)));
+	}
+#endif
+	for(; i < count; i++)
+	{
+		results[i] = (float)values[i];
+	}
+}
+
+void Batch::pack(float const * values, Snorm16 * results, unsigned int count)
+{
+	unsigned int i = 0;
+#if SIMD_ENABLED
+	for(; i + 4 <= count; i += 4)
+	{
+		store16(results + i, toSnorm16(Simd::load(values + i)));
+	}
+#endif
+	for(; i < count; i++)
+	{
+		results[i] = Snorm16(values[i]);
+	}
+}
+
+void Batch::unpack(Snorm16 const * values, float * results, unsigned int count)
+{
+	unsigned int i = 0;
+#if SIMD_ENABLED
+	for(; i + 4 <= count; i += 4)
+	{
+		Simd::store(results + i, fromSnorm16(loadInt16(values + i)));
+	}
+#endif
+	for(; i < count; i++)
+	{
+		results[i] = (float)values[i];
+	}
+}
+
+void Batch::pack(float const * values, Unorm16 * results, unsigned int count)
+{
+	unsigned int i = 0;
+#if SIMD_ENABLED
+	for(; i + 4 <= count; i += 4)
+	{
+		store16(results + i, toUnorm(Simd::load(values + i), 65535.0f));
+	}
+#endif
+	for(; i < count; i++)
+	{
+		results[i] = Unorm16(values[i]);
+	}
+}
+
+void Batch::unpack(Unorm16 const * values, float * results, unsigned int count)
+{
+	unsigned int i = 0;
+#if SIMD_ENABLED
+	for(; i + 4 <= count; i += 4)
+	{
+		Simd::store(results + i, Simd::div(toFloat(loadUInt16(values + i)), Simd::splat(65535.0f)));
+	}
+#endif
+	for(; i < count; i++)
+	{
+		results[i] = (float)values[i];
+	}
+}
+
+void Batch::pack(float const * values, Unorm8 * results, unsigned int count)
+{
+	unsigned int i = 0;
+#if SIMD_ENABLED
+	for(; i + 4 <= count; i += 4)
+	{
+		store8(results + i, toUnorm(Simd::load(values + i), 255.0f));
+	}
+#endif
+	for(; i < count; i++)
+	{
+		results[i] = Unorm8(values[i]);
+	}
+}
+
+void Batch::unpack(Unorm8 const * values, float * results, unsigned int count)
+{
+	unsigned int i = 0;
+#if SIMD_ENABLED
+	for(; i + 4 <= count; i += 4)
+	{
+		Simd::store(results + i, Simd::div(toFloat(loadUInt8(values + i)), Simd::splat(255.0f)));
+	}
+#endif
+	for(; i < count; i++)
+	{
+		results[i] = (float)values[i];
+	}
+}
+
+void Batch::pack(Coord3f const * vectors, Octahedral * results, unsigned int count)
+{
+	unsigned int i = 0;
+#if SIMD_ENABLED
+	Simd::Float4 zero = Simd::splat(0.0f);
+	Simd::Float4 one = Simd::splat(1.0f);
+	for(; i + 4 <= count; i += 4)
+	{
+		// The same as the Octahedral constructor.
+		Simd::Float4 x, y, z;
+		Simd::loadInterleaved3(vectors[i].ptr(), x, y, z);
+		Simd::Float4 l1 = Simd::add(Simd::add(abs(x), abs(y)), abs(z));
+		x = Simd::div(x, l1);
+		y = Simd::div(y, l1);
+		Simd::Float4 foldedX = Simd::mulSign(Simd::sub(one, abs(y)), x);
+		Simd::Float4 foldedY = Simd::mulSign(Simd::sub(one, abs(x)), y);
+		Int4 u = toSnorm16(Simd::ifLessEqual(zero, z, x, foldedX));
+		Int4 v = toSnorm16(Simd::ifLessEqual(zero, z, y, foldedY));
+		store16(results + i, zipLow(u, v));
+		store16(results + i + 2, zipHigh(u, v));
+	}
+#endif
+	for(; i < count; i++)
+	{
+		results[i] = Octahedral(vectors[i]);
+	}
+}
+
+void Batch::unpack(Octahedral const * values, Coord3f * results, unsigned int count)
+{
+	unsigned int i = 0;
+#if SIMD_ENABLED
+	Simd::Float4 zero = Simd::splat(0.0f);
+	Simd::Float4 one = Simd::splat(1.0f);
+	for(; i + 4 <= count; i += 4)
+	{
+		// The same as the Octahedral cast to Coord3f.
+		Simd::Float4 x, y;
+		Simd::unzip(fromSnorm16(loadInt16(values + i)), fromSnorm16(loadInt16(values + i + 2)), x, y);
+		Simd::Float4 z = Simd::sub(Simd::sub(one, abs(x)), abs(y));
+		Simd::Float4 t = Simd::max(Simd::sub(zero, z), zero);
+		x = Simd::sub(x, Simd::mulSign(t, x));
+		y = Simd::sub(y, Simd::mulSign(t, y));
+		Simd::Float4 n = Simd::sqrt(Simd::mulAdd(x, x, Simd::mulAdd(y, y, Simd::mul(z, z))));
+		Simd::storeInterleaved3(results[i].ptr(), Simd::div(x, n), Simd::div(y, n), Simd::div(z, n));
+	}
+#endif
+	for(; i < count; i++)
+	{
+		results[i] = (Coord3f)values[i];
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "packed.h"
+
+/*
+Functions that convert many floats to and from the storage types in packed.h at once, for loading assets and filling vertex buffers.
+As in transform_batch.h, the inner loops work on four values at a time with SIMD when it is enabled.
+The results are the same as converting each value with the constructors and casts of the types.
+The Coord versions convert every element of every Coord, so count is the number of Coords.
+*/
+namespace Batch
+{
+	// Sets results[i] to Half(values[i]).
+	void pack(float const * values, Half * results, unsigned int count);
+
+	// Sets results[i] to (float)values[i].
+	void unpack(Half const * values, float * results, unsigned int count);
+
+	// Sets results[i] to Snorm16(values[i]).
+	void pack(float const * values, Snorm16 * results, unsigned int count);
+
+	// Sets results[i] to (float)values[i].
+	void unpack(Snorm16 const * values, float * results, unsigned int count);
+
+	// Sets results[i] to Unorm16(values[i]).
+	void pack(float const * values, Unorm16 * results, unsigned int count);
+
+	// Sets results[i] to (float)values[i].
+	void unpack(Unorm16 const * values, float * results, unsigned int count);
+
+	// Sets results[i] to Unorm8(values[i]).
+	void pack(float const * values, Unorm8 * results, unsigned int count);
+
+	// Sets results[i] to (float)values[i].
+	void unpack(Unorm8 const * values, float * results, unsigned int count);
+
+	// Sets results[i] to Octahedral(vectors[i]). The vectors must be normalized.
+	void pack(Coord3f const * vectors, Octahedral * results, unsigned int count);
+
+	// Sets results[i] to (Coord3f)values[i].
+	void unpack(Octahedral const * values, Coord3f * results, unsigned int count);
+
+	// Sets results[i] to Coord<dim, T>(coords[i]).
+	template <unsigned int dim, typename T> void pack(Coord<dim, float> const * coords, Coord<dim, T> * results, unsigned int count);
+
+	// Sets results[i] to Coord<dim, float>(coords[i]).
+	template <unsigned int dim, typename T> void unpack(Coord<dim, T> const * coords, Coord<dim, float> * results, unsigned int count);
+}
+
+// Template Implementations
+
+template <unsigned int dim, typename T>
+void Batch::pack(Coord<dim, float> const * coords, Coord<dim, T> * results, unsigned int count)
+{
+	static_assert(sizeof(Coord<dim, float>) == dim * sizeof(float) && sizeof(Coord<dim, T>) == dim * sizeof(T), "Coord arrays must be tightly packed.");
+	pack(reinterpret_cast<float const *>(coords), reinterpret_cast<T *>(results), dim * count);
+}
+
+template <unsigned int dim, typename T>
+void Batch::unpack(Coord<dim, T> const * coords, Coord<dim, float> * results, unsigned int count)
+{
+	static_assert(sizeof(Coord<dim, float>) == dim * sizeof(float) && sizeof(Coord<dim, T>) == dim * sizeof(T), "Coord arrays must be tightly packed.");
+	unpack(reinterpret_cast<T const *>(coords), reinterpret_cast<float *>(results), dim * count);
+}
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <atomic>
 #include <exception>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 /*
 Although using smart pointers provides many benefits, I've come to the conclusion that just
@@ -19,11 +23,23 @@ Also, I would like to make OwnPtr be a subclass of Ptr if I can.
 
 */
 
+// When PTR_CHECKS is 1, dereferencing a null OwnPtr or a Ptr whose object has been destroyed throws a nullptr_exception.
+// When it is 0, dereferencing is just a raw pointer access with no checks. It defaults to 1 in debug builds and 0 in release (NDEBUG) builds.
+// Reference counting still happens in both modes, since isValid, isReferenced, and the Ptr guarantees depend on it.
+// The checks are most of the cost of a dereference, while the counts only cost when a Ptr is copied or destroyed (see bench/bench_ptr.cpp).
+#ifndef PTR_CHECKS
+#ifdef NDEBUG
+#define PTR_CHECKS 0
+#else
+#define PTR_CHECKS 1
+#endif
+#endif
+
 // Forward declarations
-template <class T>
+template <class T, bool atomic = false>
 class OwnPtr;
 
-template <class T>
+template <class T, bool atomic = false>
 class Ptr;
 
 class _PtrCounter;
@@ -45,30 +61,42 @@ public:
 	}
 };
 
-// OwnPtr is a smart pointer that controls ownership. It is copyable and maintains an OwnPtr reference count, that when the last OwnPtr reference of a particular object is deconstructed, the pointer is destroyed. When the last OwnPtr of a pointer is being destroyed, there must be no UsePtrs pointing to it. If there are, it will fail an assertion. This ensures that the OwnPtr and object always exist at least as long as the UsePtrs. OwnPtr can take a destroy function that must dispose of the pointer appropriately.
-template <class T> class OwnPtr
+// OwnPtr is a smart pointer that controls ownership. It is copyable and maintains an OwnPtr reference count, that when the last OwnPtr reference of a particular object is deconstructed, the pointer is destroyed. When the last OwnPtr of a pointer is being destroyed, there must be no UsePtrs pointing to it. If there are, it will fail an assertion. This ensures that the OwnPtr and object always exist at least as long as the UsePtrs. OwnPtr can take a destroy function that must dispose of the pointer appropriately. The reference counts are not thread-safe unless atomic is true (see AtomicOwnPtr).
+template <class T, bool atomic> class OwnPtr
 {
 public:
 	// Default constructor. Initializes the pointer to null. It can take a function that destroys the object(default is the standard delete operator).
 	OwnPtr();
 
 	// Default copy constructor. Needed otherwise C++ will create its own.
-	OwnPtr(OwnPtr<T> const & ptr);
+	OwnPtr(OwnPtr<T, atomic> const & ptr);
 
 	// Templated copy constructor. It can take a pointer that has a type that is a subclass of T.
-	template <class Y> OwnPtr(OwnPtr<Y> const & ptr);
+	template <class Y> OwnPtr(OwnPtr<Y, atomic> const & ptr);
+
+	// Move constructor. Takes over the reference of ptr without touching the counter. Ptr is left null.
+	OwnPtr(OwnPtr<T, atomic> && ptr);
+
+	// Templated move constructor. It can take a pointer that has a type that is a subclass of T. It can also take an OwnPtr with the other counting mode, which is how an object is handed between an AtomicOwnPtr and an OwnPtr. Only do that when no other thread still uses the object's pointers.
+	template <class Y, bool atomicY> OwnPtr(OwnPtr<Y, atomicY> && ptr);
 
 	// Destructor. If this is the last OwnPtr reference to the object, either delete is called or the destroy function is called if it is specified. There must be no UsePtrs pointing to the object. Note that it is not virtual, so don't subclass OwnPtr.
 	~OwnPtr();
 
-	// Returns a newly created OwnPtr. Same as if this were used: OwnPtr<T> ptr; ptr.setNew(args...); return ptr;
-	template <typename ...Args> static OwnPtr<T> createNew(Args... args);
+	// Returns a newly created OwnPtr. Same as if this were used: OwnPtr<T, atomic> ptr; ptr.setNew(args...); return ptr;
+	template <typename ...Args> static OwnPtr<T, atomic> createNew(Args && ... args);
 
 	// Default assignment operator. Needed otherwise C++ will create its own.
-	OwnPtr<T> & operator = (OwnPtr<T> const & ptr);
+	OwnPtr<T, atomic> & operator = (OwnPtr<T, atomic> const & ptr);
 
 	// Templated assignment operator. It can take a pointer that has a type that is a subclass of T.
-	template <class Y> OwnPtr<T> & operator = (OwnPtr<Y> const & ptr);
+	template <class Y> OwnPtr<T, atomic> & operator = (OwnPtr<Y, atomic> const & ptr);
+
+	// Move assignment operator. Takes over the reference of ptr without touching its counter. Ptr is left null.
+	OwnPtr<T, atomic> & operator = (OwnPtr<T, atomic> && ptr);
+
+	// Templated move assignment operator. It can take a pointer that has a type that is a subclass of T, or one with the other counting mode (see the templated move constructor).
+	template <class Y, bool atomicY> OwnPtr<T, atomic> & operator = (OwnPtr<Y, atomicY> && ptr);
 
 	// Returns true if this points to something non-zero.
 	bool isValid() const;
@@ -79,11 +107,11 @@ public:
 	// Point the pointer to newP, which can have a type that is subclass of T. Only pass in something that looks like 'new T()' to ensure that the raw pointer isn't used elsewhere. If there was a previous object pointed to, the same algorithm as the destructor is called.
 	template <class Y> void setRaw(Y * newP, void(*deleteFunction) (Y *) = nullptr);
 
-	// Change the object to a new pointer to an object of type T with arguments. Uses the new operator for allocation. For special allocation, use the function OwnPtr(Y * newP, ...).
-	template <typename... Args> void setNew(Args... args);
+	// Change the object to a new pointer to an object of type T with arguments. The object and its reference counter are placed in a single allocation. For special allocation, use the function setRaw(Y * newP, ...).
+	template <typename... Args> void setNew(Args && ... args);
 
-	// Change the object to a new pointer to an object of type Y with arguments. Uses the new operator for allocation. For special allocation, use the function OwnPtr(Y * newP, ...).
-	template <typename Y, typename... Args> void setNew(Args... args);
+	// Change the object to a new pointer to an object of type Y with arguments. The object and its reference counter are placed in a single allocation. For special allocation, use the function setRaw(Y * newP, ...).
+	template <typename Y, typename... Args> void setNew(Args && ... args);
 
 	// Resets the object to point to nothing. If there was a previous object pointed to, the same algorithm as the destructor is called.
 	void setNull();
@@ -91,13 +119,16 @@ public:
 	// Sets whether all Ptrs pointing to the object are guaranteed existence. This means that destroy will throw an exception if there are still Ptrs pointing to the object. This must be pointing to an object or an exception is thrown.
 	void setGuaranteeForPtrs(bool guarantee);
 
-	// Provides access to the object's members.
+	// Sets a function that is called with context whenever the last Ptr pointing to the object is dropped while the object is still owned, so an owner like a cache can track which objects are unreferenced without checking them all. It is called on the thread that drops the Ptr. Pass nullptr to remove it. This must be pointing to an object or an exception is thrown.
+	void setUnreferencedFunction(void(*function) (void * context), void * context);
+
+	// Provides access to the object's members. Throws a nullptr_exception if this is null and PTR_CHECKS is on.
 	T * operator -> () const;
 
 	// Provides access to the element located at index. Warning: this provides no index out-of-bounds checking.
 	T & operator [] (int index) const;
 
-	// Provides reference access to the object.
+	// Provides reference access to the object. Throws a nullptr_exception if this is null and PTR_CHECKS is on.
 	T & operator * () const;
 
 	// Only to be used for functions that require a pointer. Be careful how you use this.
@@ -107,54 +138,66 @@ public:
 	operator unsigned int() const;
 
 	// Returns a use pointer dynamically casted to Y.
-	template <class Y> OwnPtr<Y> as() const;
+	template <class Y> OwnPtr<Y, atomic> as() const;
 
 	// Returns true if the address of this object is less than the address of ptr's object.
-	template <class Y> bool operator < (OwnPtr<Y> const & ptr) const;
+	template <class Y> bool operator < (OwnPtr<Y, atomic> const & ptr) const;
 
 	// Returns true if the address of this object is less than the address of ptr's object.
-	template <class Y> bool operator < (Ptr<Y> const & ptr) const;
+	template <class Y> bool operator < (Ptr<Y, atomic> const & ptr) const;
 
 	// Returns true if the address of this object is equal to the address of ptr's object.
-	template <class Y> bool operator == (OwnPtr<Y> const & ptr) const;
+	template <class Y> bool operator == (OwnPtr<Y, atomic> const & ptr) const;
 
 	// Returns true if the address of this object is equal to the address of ptr's object.
-	template <class Y> bool operator == (Ptr<Y> const & ptr) const;
+	template <class Y> bool operator == (Ptr<Y, atomic> const & ptr) const;
 
 private:
 	T * p;
 	_PtrCounter * c;
-	template <class Y> friend class OwnPtr;
-	template <class Y> friend class Ptr;
+	template <class Y, bool atomicY> friend class OwnPtr;
+	template <class Y, bool atomicY> friend class Ptr;
 };
 
-// Ptr is a somewhat smart pointer that has no ownership and so never deletes the pointer that it references. If the object it points to is accessed but there are no OwnPtrs, it throws an std::exception.
-template <class T> class Ptr
+// Ptr is a somewhat smart pointer that has no ownership and so never deletes the pointer that it references. If the object it points to is accessed but there are no OwnPtrs, it throws a nullptr_exception (when PTR_CHECKS is on).
+template <class T, bool atomic> class Ptr
 {
 public:
 	// Default constructor. Initializes the pointer to null.
 	Ptr();
 
 	// Default copy constructor. Needed otherwise C++ will create its own.
-	Ptr(Ptr<T> const & ptr);
+	Ptr(Ptr<T, atomic> const & ptr);
 
 	// Templated copy constructor.
-	template <class Y> Ptr(Ptr<Y> const & ptr);
+	template <class Y> Ptr(Ptr<Y, atomic> const & ptr);
+
+	// Move constructor. Takes over the reference of ptr without touching the counter. Ptr is left null.
+	Ptr(Ptr<T, atomic> && ptr);
+
+	// Templated move constructor.
+	template <class Y> Ptr(Ptr<Y, atomic> && ptr);
 
 	// Initializes this to point to the same object that ptr points to.
-	template <class Y> Ptr(OwnPtr<Y> const & ptr);
+	template <class Y> Ptr(OwnPtr<Y, atomic> const & ptr);
 
 	// Destructor.
 	~Ptr();
 
 	// Default assignment operator. Needed, otherwise C++ will create its own.
-	Ptr<T> & operator = (Ptr<T> const & ptr);
+	Ptr<T, atomic> & operator = (Ptr<T, atomic> const & ptr);
 
 	// Templated assignment operator.
-	template <class Y> Ptr<T> & operator = (Ptr<Y> const & ptr);
+	template <class Y> Ptr<T, atomic> & operator = (Ptr<Y, atomic> const & ptr);
+
+	// Move assignment operator. Takes over the reference of ptr without touching its counter. Ptr is left null.
+	Ptr<T, atomic> & operator = (Ptr<T, atomic> && ptr);
+
+	// Templated move assignment operator.
+	template <class Y> Ptr<T, atomic> & operator = (Ptr<Y, atomic> && ptr);
 
 	// Assigns this to point to the same object that ptr points to. If this pointed to a previous object, then that reference is removed.
-	template <class Y> Ptr<T> & operator = (OwnPtr<Y> const & ptr);
+	template <class Y> Ptr<T, atomic> & operator = (OwnPtr<Y, atomic> const & ptr);
 
 	// Returns true if this points to something non-zero.
 	bool isValid() const;
@@ -162,13 +205,13 @@ public:
 	// Makes this point to nothing.
 	void setNull();
 
-	// Provides access to the object's members.
+	// Provides access to the object's members. Throws a nullptr_exception if the object doesn't exist and PTR_CHECKS is on.
 	T * operator -> () const;
 
 	// Provides access to the element located at index. Warning: this provides no index out-of-bounds checking.
 	T & operator [] (int index) const;
 
-	// Provides reference access to the object.
+	// Provides reference access to the object. Throws a nullptr_exception if the object doesn't exist and PTR_CHECKS is on.
 	T & operator * () const;
 
 	// Get the unsigned integer value of the address of the object.
@@ -181,153 +224,298 @@ public:
 	bool isGuaranteed() const;
 
 	// Returns a use pointer dynamically casted to Y.
-	template <class Y> Ptr<Y> as() const;
+	template <class Y> Ptr<Y, atomic> as() const;
 
 	// Returns true if the address of this object is less than the address of ptr's object.
-	template <class Y> bool operator < (OwnPtr<Y> const & ptr) const;
+	template <class Y> bool operator < (OwnPtr<Y, atomic> const & ptr) const;
 
 	// Returns true if the address of this object is less than the address of ptr's object.
-	template <class Y> bool operator < (Ptr<Y> const & ptr) const;
+	template <class Y> bool operator < (Ptr<Y, atomic> const & ptr) const;
 
 	// Returns true if the address of this object is equal to the address of ptr's object.
-	template <class Y> bool operator == (OwnPtr<Y> const & ptr) const;
+	template <class Y> bool operator == (OwnPtr<Y, atomic> const & ptr) const;
 
 	// Returns true if the address of this object is equal to the address of ptr's object.
-	template <class Y> bool operator == (Ptr<Y> const & ptr) const;
+	template <class Y> bool operator == (Ptr<Y, atomic> const & ptr) const;
 
 private:
 	T * p;
 	_PtrCounter * c;
-	template <class Y> friend class OwnPtr;
-	template <class Y> friend class Ptr;
+	template <class Y, bool atomicY> friend class OwnPtr;
+	template <class Y, bool atomicY> friend class Ptr;
 };
 
+// AtomicOwnPtr and AtomicPtr have the same ownership and guarantee semantics as OwnPtr and Ptr, but their reference counts are atomic.
+// Copies of them can be made and destroyed on different threads at the same time. As with Ptr, an AtomicPtr doesn't keep its object alive,
+// so the thread using it must make sure an owner outlives the access. Use them only for objects that cross threads, since every copy costs a
+// locked instruction. An AtomicOwnPtr can be moved into an OwnPtr (and back) once the other threads are done with it.
+template <class T> using AtomicOwnPtr = OwnPtr<T, true>;
+template <class T> using AtomicPtr = Ptr<T, true>;
+
 // Template Implementation.
 
+// The reference counter shared by all OwnPtrs and Ptrs of an object. It is not polymorphic. Instead it holds a plain function that destroys the object, so that destroying doesn't go through a vtable and the counter can share an allocation with the object.
 class _PtrCounter
 {
 public:
-	virtual void destroy() = 0;
+	_PtrCounter(void(*destroyFunction) (_PtrCounter *)) : destroyFunction(destroyFunction)
+	{
+	}
+
+	// Destroys the object, but not the counter.
+	void destroy()
+	{
+		destroyFunction(this);
+	}
 
-	int oc = 0; // OwnPtr reference counter
-	int pc = 0; // Ptr reference counter
+	// Frees the memory of the counter (and the object's memory, if it shares the allocation). The object must already be destroyed.
+	static void release(_PtrCounter * c)
+	{
+		::operator delete(c);
+	}
+
+	// Increments a count. Only the atomic mode uses a locked instruction, the other is a plain load and store.
+	template <bool atomic> static void increment(std::atomic<int> & count)
+	{
+		if(atomic)
+		{
+			count.fetch_add(1, std::memory_order_relaxed);
+		}
+		else
+		{
+			count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		}
+	}
+
+	// Decrements a count and returns the new value.
+	template <bool atomic> static int decrement(std::atomic<int> & count)
+	{
+		if(atomic)
+		{
+			return count.fetch_sub(1, std::memory_order_acq_rel) - 1;
+		}
+		else
+		{
+			int value = count.load(std::memory_order_relaxed) - 1;
+			count.store(value, std::memory_order_relaxed);
+			return value;
+		}
+	}
+
+	// Returns the value of a count.
+	static int get(std::atomic<int> const & count)
+	{
+		return count.load(std::memory_order_acquire);
+	}
+
+	std::atomic<int> oc{0}; // OwnPtr reference counter
+	std::atomic<int> pc{1}; // Ptr reference counter, plus one shared by all of the OwnPtrs. When it reaches zero, nothing references the counter.
 	bool guarantee = false; // Are Ptrs guaranteed access to the object?
+	void(*destroyFunction) (_PtrCounter *); // Destroys the object.
+	void(*unreferencedFunction) (void *) = nullptr; // Called when the Ptr count drops to just the OwnPtrs' share.
+	void * unreferencedContext = nullptr; // Passed to unreferencedFunction.
 };
 
+// A counter for an object that was allocated separately, as with setRaw.
 template <class T>
 class _PtrCounterTyped : public _PtrCounter
 {
 public:
-	_PtrCounterTyped(T * p, void(*deleteFunction) (T *))
+	_PtrCounterTyped(T * p, void(*deleteFunction) (T *)) : _PtrCounter(&destroyTyped)
 	{
 		this->p = p;
 		this->deleteFunction = deleteFunction;
 	}
 
-	void destroy() override
+	// Allocates a counter. It is freed with _PtrCounter::release.
+	static _PtrCounterTyped<T> * create(T * p, void(*deleteFunction) (T *))
 	{
-		if(deleteFunction)
+		return ::new (::operator new(sizeof(_PtrCounterTyped<T>))) _PtrCounterTyped<T>(p, deleteFunction);
+	}
+
+	static void destroyTyped(_PtrCounter * c)
+	{
+		_PtrCounterTyped<T> * typed = static_cast<_PtrCounterTyped<T> *>(c);
+		if(typed->deleteFunction)
 		{
-			deleteFunction(p);
+			typed->deleteFunction(typed->p);
 		}
 		else
 		{
-			delete p;
+			delete typed->p;
 		}
-		deleteFunction = nullptr;
-		p = nullptr;
+		typed->deleteFunction = nullptr;
+		typed->p = nullptr;
 	}
 
 	T * p = 0; // Derived type for correct destruction, even without base virtual destructor.
 	void(*deleteFunction) (T *) = 0; // User-supplied destroy function.
 };
 
+// A counter that has the object placed directly after it in the same allocation, as with setNew and createNew.
+template <class T>
+class _PtrCounterInPlace : public _PtrCounter
+{
+public:
+	_PtrCounterInPlace() : _PtrCounter(&destroyInPlace)
+	{
+	}
+
+	// Allocates a counter and constructs the object in the same block. It is freed with _PtrCounter::release.
+	template <typename... Args> static _PtrCounterInPlace<T> * create(Args && ... args)
+	{
+		void * memory = ::operator new(sizeof(_PtrCounterInPlace<T>));
+		_PtrCounterInPlace<T> * c = ::new (memory) _PtrCounterInPlace<T>();
+		try
+		{
+			::new ((void *)&c->storage) T(std::forward<Args>(args)...);
+		}
+		catch(...)
+		{
+			::operator delete(memory);
+			throw;
+		}
+		return c;
+	}
+
+	T * object()
+	{
+		return reinterpret_cast<T *>(&storage);
+	}
+
+	static void destroyInPlace(_PtrCounter * c)
+	{
+		static_cast<_PtrCounterInPlace<T> *>(c)->object()->~T();
+	}
+
+	typename std::aligned_storage<sizeof(T), std::alignment_of<T>::value>::type storage; // The object itself.
+};
+
 // OwnPtr
 
-template <class T>
-OwnPtr<T>::OwnPtr() : p(nullptr), c(nullptr)
+template <class T, bool atomic>
+OwnPtr<T, atomic>::OwnPtr() : p(nullptr), c(nullptr)
 {
 }
 
-template <class T>
-OwnPtr<T>::OwnPtr(OwnPtr<T> const & ptr) : p(ptr.p), c(ptr.c)
+template <class T, bool atomic>
+OwnPtr<T, atomic>::OwnPtr(OwnPtr<T, atomic> const & ptr) : p(ptr.p), c(ptr.c)
 {
 	if(p != nullptr)
 	{
-		c->oc++;
+		_PtrCounter::increment<atomic>(c->oc);
 	}
 }
 
-template <class T> template <class Y>
-OwnPtr<T>::OwnPtr(OwnPtr<Y> const & ptr) : p(ptr.p), c(ptr.c)
+template <class T, bool atomic> template <class Y>
+OwnPtr<T, atomic>::OwnPtr(OwnPtr<Y, atomic> const & ptr) : p(ptr.p), c(ptr.c)
 {
 	if(p != nullptr)
 	{
-		c->oc++;
+		_PtrCounter::increment<atomic>(c->oc);
 	}
 }
 
-template <class T>
-OwnPtr<T>::~OwnPtr()
+template <class T, bool atomic>
+OwnPtr<T, atomic>::OwnPtr(OwnPtr<T, atomic> && ptr) : p(ptr.p), c(ptr.c)
+{
+	ptr.p = nullptr;
+	ptr.c = nullptr;
+}
+
+template <class T, bool atomic> template <class Y, bool atomicY>
+OwnPtr<T, atomic>::OwnPtr(OwnPtr<Y, atomicY> && ptr) : p(ptr.p), c(ptr.c)
+{
+	ptr.p = nullptr;
+	ptr.c = nullptr;
+}
+
+template <class T, bool atomic>
+OwnPtr<T, atomic>::~OwnPtr()
 {
 	setNull();
 }
 
-template <class T> template <typename ...Args>
-OwnPtr<T> OwnPtr<T>::createNew(Args... args)
+template <class T, bool atomic> template <typename ...Args>
+OwnPtr<T, atomic> OwnPtr<T, atomic>::createNew(Args && ... args)
 {
-	OwnPtr<T> ptr;
-	ptr.setNew(args...);
+	OwnPtr<T, atomic> ptr;
+	ptr.setNew(std::forward<Args>(args)...);
 	return ptr;
 }
 
-template <class T>
-OwnPtr<T> & OwnPtr<T>::operator = (OwnPtr<T> const & ptr)
+template <class T, bool atomic>
+OwnPtr<T, atomic> & OwnPtr<T, atomic>::operator = (OwnPtr<T, atomic> const & ptr)
 {
 	setNull();
 	p = ptr.p;
 	c = ptr.c;
 	if(p != nullptr)
 	{
-		c->oc++;
+		_PtrCounter::increment<atomic>(c->oc);
 	}
 	return *this;
 }
 
-template <class T> template <class Y>
-OwnPtr<T> & OwnPtr<T>::operator = (OwnPtr<Y> const & ptr)
+template <class T, bool atomic> template <class Y>
+OwnPtr<T, atomic> & OwnPtr<T, atomic>::operator = (OwnPtr<Y, atomic> const & ptr)
 {
 	setNull();
 	p = ptr.p;
 	c = ptr.c;
 	if(p != nullptr)
 	{
-		c->oc++;
+		_PtrCounter::increment<atomic>(c->oc);
 	}
 	return *this;
 }
 
-template <class T>
-bool OwnPtr<T>::isValid() const
+template <class T, bool atomic>
+OwnPtr<T, atomic> & OwnPtr<T, atomic>::operator = (OwnPtr<T, atomic> && ptr)
+{
+	if(this != &ptr)
+	{
+		setNull();
+		p = ptr.p;
+		c = ptr.c;
+		ptr.p = nullptr;
+		ptr.c = nullptr;
+	}
+	return *this;
+}
+
+template <class T, bool atomic> template <class Y, bool atomicY>
+OwnPtr<T, atomic> & OwnPtr<T, atomic>::operator = (OwnPtr<Y, atomicY> && ptr)
+{
+	setNull();
+	p = ptr.p;
+	c = ptr.c;
+	ptr.p = nullptr;
+	ptr.c = nullptr;
+	return *this;
+}
+
+template <class T, bool atomic>
+bool OwnPtr<T, atomic>::isValid() const
 {
 	return p != nullptr;
 }
 
-template <class T>
-bool OwnPtr<T>::isReferenced() const
+template <class T, bool atomic>
+bool OwnPtr<T, atomic>::isReferenced() const
 {
-	return p != nullptr && c->pc != 0;
+	return p != nullptr && _PtrCounter::get(c->pc) > 1;
 }
 
-template <class T> template <class Y>
-void OwnPtr<T>::setRaw(Y * newP, void(*deleteFunction) (Y *))
+template <class T, bool atomic> template <class Y>
+void OwnPtr<T, atomic>::setRaw(Y * newP, void(*deleteFunction) (Y *))
 {
 	setNull();
 	p = newP;
 	if(p != nullptr)
 	{
-		c = new _PtrCounterTyped<Y>(newP, deleteFunction);
-		c->oc++;
+		c = _PtrCounterTyped<Y>::create(newP, deleteFunction);
+		_PtrCounter::increment<atomic>(c->oc);
 	}
 	else
 	{
@@ -335,35 +523,47 @@ void OwnPtr<T>::setRaw(Y * newP, void(*deleteFunction) (Y *))
 	}
 }
 
-template <class T> template <typename... Args>
-void OwnPtr<T>::setNew(Args... args)
+template <class T, bool atomic> template <typename... Args>
+void OwnPtr<T, atomic>::setNew(Args && ... args)
 {
-	setRaw(new T(args...));
+	setNew<T, Args...>(std::forward<Args>(args)...); // All of the template arguments are given, so that a single T argument doesn't also match this overload.
 }
 
-template <class T> template <typename Y, typename... Args>
-void OwnPtr<T>::setNew(Args... args)
+template <class T, bool atomic> template <typename Y, typename... Args>
+void OwnPtr<T, atomic>::setNew(Args && ... args)
 {
-	setRaw(new Y(args...));
+	_PtrCounterInPlace<Y> * newC = _PtrCounterInPlace<Y>::create(std::forward<Args>(args)...); // Constructed before setNull so that args may refer to the old object.
+	try
+	{
+		setNull();
+	}
+	catch(...)
+	{
+		newC->destroy();
+		_PtrCounter::release(newC);
+		throw;
+	}
+	p = newC->object();
+	c = newC;
+	_PtrCounter::increment<atomic>(c->oc);
 }
 
-template <class T>
-void OwnPtr<T>::setNull()
+template <class T, bool atomic>
+void OwnPtr<T, atomic>::setNull()
 {
 	if(p != nullptr)
 	{
-		c->oc--;
-		if(c->oc == 0)
+		if(_PtrCounter::decrement<atomic>(c->oc) == 0)
 		{
-			if(c->pc > 0 && c->guarantee)
+			if(c->guarantee && _PtrCounter::get(c->pc) > 1)
 			{
-				c->oc++; // Rewind function.
+				_PtrCounter::increment<atomic>(c->oc); // Rewind function.
 				throw std::exception(); // This OwnPtr still has guaranteed Ptrs out there, so it can't be deleted.
 			}
 			c->destroy();
-			if(c->pc == 0) // If there are Ptrs still out there, keep the counter around. They'll take care of deleting it.
+			if(_PtrCounter::decrement<atomic>(c->pc) == 0) // Drop the OwnPtrs' share. If there are Ptrs still out there, keep the counter around. They'll take care of deleting it.
 			{
-				delete c;
+				_PtrCounter::release(c);
 			}
 		}
 		p = nullptr;
@@ -371,8 +571,8 @@ void OwnPtr<T>::setNull()
 	}
 }
 
-template <class T>
-void OwnPtr<T>::setGuaranteeForPtrs(bool guarantee)
+template <class T, bool atomic>
+void OwnPtr<T, atomic>::setGuaranteeForPtrs(bool guarantee)
 {
 	if(p == nullptr)
 	{
@@ -381,222 +581,288 @@ void OwnPtr<T>::setGuaranteeForPtrs(bool guarantee)
 	c->guarantee = guarantee;
 }
 
-template <class T>
-T * OwnPtr<T>::operator -> () const
+template <class T, bool atomic>
+void OwnPtr<T, atomic>::setUnreferencedFunction(void(*function) (void * context), void * context)
 {
 	if(p == nullptr)
 	{
 		throw nullptr_exception();
 	}
+	c->unreferencedFunction = function;
+	c->unreferencedContext = context;
+}
+
+template <class T, bool atomic>
+T * OwnPtr<T, atomic>::operator -> () const
+{
+#if PTR_CHECKS
+	if(p == nullptr)
+	{
+		throw nullptr_exception();
+	}
+#endif
 	return p;
 }
 
-template <class T>
-T & OwnPtr<T>::operator [] (int index) const
+template <class T, bool atomic>
+T & OwnPtr<T, atomic>::operator [] (int index) const
 {
+#if PTR_CHECKS
 	if(p == nullptr)
 	{
 		throw nullptr_exception();
 	}
+#endif
 	return p[index];
 }
 
-template <class T>
-T & OwnPtr<T>::operator * () const
+template <class T, bool atomic>
+T & OwnPtr<T, atomic>::operator * () const
 {
+#if PTR_CHECKS
 	if(p == nullptr)
 	{
 		throw nullptr_exception();
 	}
+#endif
 	return *p;
 }
 
-template <class T>
-T * OwnPtr<T>::raw() const
+template <class T, bool atomic>
+T * OwnPtr<T, atomic>::raw() const
 {
 	return p;
 }
 
-template <class T>
-OwnPtr<T>::operator unsigned int() const
+template <class T, bool atomic>
+OwnPtr<T, atomic>::operator unsigned int() const
 {
 	return (unsigned int)p;
 }
 
-template <class T> template <class Y> OwnPtr<Y> OwnPtr<T>::as() const
+template <class T, bool atomic> template <class Y> OwnPtr<Y, atomic> OwnPtr<T, atomic>::as() const
 {
-	OwnPtr<Y> up;
+	OwnPtr<Y, atomic> up;
 	up.p = dynamic_cast<Y *>(p);
 	up.c = c;
 	if(p != nullptr)
 	{
-		c->oc++;
+		_PtrCounter::increment<atomic>(c->oc);
 	}
 	return up;
 }
 
-template <class T> template <class Y>
-bool OwnPtr<T>::operator < (OwnPtr<Y> const & ptr) const
+template <class T, bool atomic> template <class Y>
+bool OwnPtr<T, atomic>::operator < (OwnPtr<Y, atomic> const & ptr) const
 {
 	return (void const *)p < (void const *)ptr.p;
 }
 
-template <class T> template <class Y>
-bool OwnPtr<T>::operator < (Ptr<Y> const & ptr) const
+template <class T, bool atomic> template <class Y>
+bool OwnPtr<T, atomic>::operator < (Ptr<Y, atomic> const & ptr) const
 {
 	return (void const *)p < (void const *)ptr.p;
 }
 
-template <class T> template <class Y>
-bool OwnPtr<T>::operator == (OwnPtr<Y> const & ptr) const
+template <class T, bool atomic> template <class Y>
+bool OwnPtr<T, atomic>::operator == (OwnPtr<Y, atomic> const & ptr) const
 {
 	return (void const *)p == (void const *)ptr.p;
 }
 
-template <class T> template <class Y>
-bool OwnPtr<T>::operator == (Ptr<Y> const & ptr) const
+template <class T, bool atomic> template <class Y>
+bool OwnPtr<T, atomic>::operator == (Ptr<Y, atomic> const & ptr) const
 {
 	return (void const *)p == (void const *)ptr.p;
 }
 
 // Ptr
 
-template <class T>
-Ptr<T>::Ptr() : p(nullptr), c(nullptr)
+template <class T, bool atomic>
+Ptr<T, atomic>::Ptr() : p(nullptr), c(nullptr)
 {
 }
 
-template <class T>
-Ptr<T>::Ptr(Ptr<T> const & ptr) : p(ptr.p), c(ptr.c)
+template <class T, bool atomic>
+Ptr<T, atomic>::Ptr(Ptr<T, atomic> const & ptr) : p(ptr.p), c(ptr.c)
 {
 	if(p != nullptr)
 	{
-		c->pc++;
+		_PtrCounter::increment<atomic>(c->pc);
 	}
 }
 
-template <class T> template <class Y>
-Ptr<T>::Ptr(Ptr<Y> const & ptr) : p(ptr.p), c(ptr.c)
+template <class T, bool atomic> template <class Y>
+Ptr<T, atomic>::Ptr(Ptr<Y, atomic> const & ptr) : p(ptr.p), c(ptr.c)
 {
 	if(p != nullptr)
 	{
-		c->pc++;
+		_PtrCounter::increment<atomic>(c->pc);
 	}
 }
 
-template <class T> template <class Y>
-Ptr<T>::Ptr(OwnPtr<Y> const & ptr) : p(ptr.p), c(ptr.c)
+template <class T, bool atomic> template <class Y>
+Ptr<T, atomic>::Ptr(OwnPtr<Y, atomic> const & ptr) : p(ptr.p), c(ptr.c)
 {
 	if(p != nullptr)
 	{
-		c->pc++;
+		_PtrCounter::increment<atomic>(c->pc);
 	}
 }
 
-template <class T>
-Ptr<T>::~Ptr()
+template <class T, bool atomic>
+Ptr<T, atomic>::Ptr(Ptr<T, atomic> && ptr) : p(ptr.p), c(ptr.c)
+{
+	ptr.p = nullptr;
+	ptr.c = nullptr;
+}
+
+template <class T, bool atomic> template <class Y>
+Ptr<T, atomic>::Ptr(Ptr<Y, atomic> && ptr) : p(ptr.p), c(ptr.c)
+{
+	ptr.p = nullptr;
+	ptr.c = nullptr;
+}
+
+template <class T, bool atomic>
+Ptr<T, atomic>::~Ptr()
 {
 	setNull();
 }
 
-template <class T>
-Ptr<T> & Ptr<T>::operator = (Ptr<T> const & ptr)
+template <class T, bool atomic>
+Ptr<T, atomic> & Ptr<T, atomic>::operator = (Ptr<T, atomic> const & ptr)
 {
 	setNull();
 	p = ptr.p;
 	c = ptr.c;
 	if(p != nullptr)
 	{
-		c->pc++;
+		_PtrCounter::increment<atomic>(c->pc);
 	}
 	return *this;
 }
 
-template <class T> template <class Y>
-Ptr<T> & Ptr<T>::operator = (Ptr<Y> const & ptr)
+template <class T, bool atomic> template <class Y>
+Ptr<T, atomic> & Ptr<T, atomic>::operator = (Ptr<Y, atomic> const & ptr)
 {
 	setNull();
 	p = ptr.p;
 	c = ptr.c;
 	if(p != nullptr)
 	{
-		c->pc++;
+		_PtrCounter::increment<atomic>(c->pc);
 	}
 	return *this;
 }
 
-template <class T> template <class Y>
-Ptr<T> & Ptr<T>::operator = (OwnPtr<Y> const & ptr)
+template <class T, bool atomic> template <class Y>
+Ptr<T, atomic> & Ptr<T, atomic>::operator = (OwnPtr<Y, atomic> const & ptr)
 {
 	setNull();
 	p = ptr.p;
 	c = ptr.c;
 	if(p != nullptr)
 	{
-		c->pc++;
+		_PtrCounter::increment<atomic>(c->pc);
 	}
 	return *this;
 }
 
-template <class T>
-bool Ptr<T>::isValid() const
+template <class T, bool atomic>
+Ptr<T, atomic> & Ptr<T, atomic>::operator = (Ptr<T, atomic> && ptr)
 {
-	return p != nullptr && c->oc != 0;
+	if(this != &ptr)
+	{
+		setNull();
+		p = ptr.p;
+		c = ptr.c;
+		ptr.p = nullptr;
+		ptr.c = nullptr;
+	}
+	return *this;
 }
 
-template <class T>
-void Ptr<T>::setNull()
+template <class T, bool atomic> template <class Y>
+Ptr<T, atomic> & Ptr<T, atomic>::operator = (Ptr<Y, atomic> && ptr)
+{
+	setNull();
+	p = ptr.p;
+	c = ptr.c;
+	ptr.p = nullptr;
+	ptr.c = nullptr;
+	return *this;
+}
+
+template <class T, bool atomic>
+bool Ptr<T, atomic>::isValid() const
+{
+	return p != nullptr && _PtrCounter::get(c->oc) != 0;
+}
+
+template <class T, bool atomic>
+void Ptr<T, atomic>::setNull()
 {
 	if(p != nullptr)
 	{
-		c->pc--;
-		if(c->pc == 0 && c->oc == 0) // If there are no OwnPtrs around, that means this the last to reference the Counter.
+		int count = _PtrCounter::decrement<atomic>(c->pc);
+		if(count == 0) // The OwnPtrs have dropped their share, so this is the last to reference the Counter.
 		{
-			delete c;
+			_PtrCounter::release(c);
+		}
+		else if(count == 1 && c->unreferencedFunction != nullptr && _PtrCounter::get(c->oc) > 0) // Only the OwnPtrs' share is left, and the object is still owned.
+		{
+			c->unreferencedFunction(c->unreferencedContext);
 		}
 		p = nullptr;
 		c = nullptr;
 	}
 }
 
-template <class T>
-T * Ptr<T>::operator -> () const
+template <class T, bool atomic>
+T * Ptr<T, atomic>::operator -> () const
 {
-	if(p == nullptr || c->oc == 0)
+#if PTR_CHECKS
+	if(p == nullptr || _PtrCounter::get(c->oc) == 0)
 	{
 		throw nullptr_exception();
 	}
+#endif
 	return p;
 }
 
-template <class T>
-T & Ptr<T>::operator [] (int index) const
+template <class T, bool atomic>
+T & Ptr<T, atomic>::operator [] (int index) const
 {
-	if(p == nullptr || c->oc == 0)
+#if PTR_CHECKS
+	if(p == nullptr || _PtrCounter::get(c->oc) == 0)
 	{
 		throw nullptr_exception();
 	}
+#endif
 	return p[index];
 }
 
-template <class T>
-T & Ptr<T>::operator * () const
+template <class T, bool atomic>
+T & Ptr<T, atomic>::operator * () const
 {
-	if(p == nullptr || c->oc == 0)
+#if PTR_CHECKS
+	if(p == nullptr || _PtrCounter::get(c->oc) == 0)
 	{
 		throw nullptr_exception();
 	}
+#endif
 	return *p;
 }
 
-template <class T>
-T * Ptr<T>::raw() const
+template <class T, bool atomic>
+T * Ptr<T, atomic>::raw() const
 {
 	return p;
 }
 
-template <class T>
-bool Ptr<T>::isGuaranteed() const
+template <class T, bool atomic>
+bool Ptr<T, atomic>::isGuaranteed() const
 {
 	if(p == nullptr)
 	{
@@ -605,44 +871,44 @@ bool Ptr<T>::isGuaranteed() const
 	return c->guarantee;
 }
 
-template <class T>
-Ptr<T>::operator unsigned int() const
+template <class T, bool atomic>
+Ptr<T, atomic>::operator unsigned int() const
 {
 	return (unsigned int)p;
 }
 
-template <class T> template <class Y> Ptr<Y> Ptr<T>::as() const
+template <class T, bool atomic> template <class Y> Ptr<Y, atomic> Ptr<T, atomic>::as() const
 {
-	Ptr<Y> pp;
+	Ptr<Y, atomic> pp;
 	pp.p = dynamic_cast<Y *>(p);
 	pp.c = c;
 	if(p != nullptr)
 	{
-		c->pc++;
+		_PtrCounter::increment<atomic>(c->pc);
 	}
 	return pp;
 }
 
-template <class T> template <class Y>
-bool Ptr<T>::operator < (OwnPtr<Y> const & ptr) const
+template <class T, bool atomic> template <class Y>
+bool Ptr<T, atomic>::operator < (OwnPtr<Y, atomic> const & ptr) const
 {
 	return (void const *)p < (void const *)ptr.p;
 }
 
-template <class T> template <class Y>
-bool Ptr<T>::operator < (Ptr<Y> const & ptr) const
+template <class T, bool atomic> template <class Y>
+bool Ptr<T, atomic>::operator < (Ptr<Y, atomic> const & ptr) const
 {
 	return (void const *)p < (void const *)ptr.p;
 }
 
-template <class T> template <class Y>
-bool Ptr<T>::operator == (OwnPtr<Y> const & ptr) const
+template <class T, bool atomic> template <class Y>
+bool Ptr<T, atomic>::operator == (OwnPtr<Y, atomic> const & ptr) const
 {
 	return (void const *)p == (void const *)ptr.p;
 }
 
-template <class T> template <class Y>
-bool Ptr<T>::operator == (Ptr<Y> const & ptr) const
+template <class T, bool atomic> template <class Y>
+bool Ptr<T, atomic>::operator == (Ptr<Y, atomic> const & ptr) const
 {
 	return (void const *)p == (void const *)ptr.p;
 }
@@ -1,31 +1,57 @@
 #pragma once
 
 #include "ptr.h"
-#include <set>
-#include <map>
-
-// Generic container for handling OwnPtr and Ptr objects. It's needed because std::map/set<OwnPtr>::find can't accept Ptrs, even though a less operator is called.
-// This may be fixed in C++14
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <utility>
+
+// Generic container for handling OwnPtr and Ptr objects. The objects are kept contiguous in a vector, with a hash lookup from the pointer to its place, so
+// insert, erase, and find are O(1). Erase moves the last object into the erased place, so the order is only the Compare order right after a call to sort.
+// Sort only does the work when something has changed since the last sort, so it can be called every frame before an iteration that needs the order.
+// Unlike with a std::set, insert, erase, clear, and sort invalidate every iterator, so the set must not be changed while it is being iterated, even by
+// code called from the loop, such as a handler. Erasing with the iterator returned by erase is the only exception. To let the loop body change the set,
+// iterate over a copy of the objects as Ptrs instead, and skip those that are no longer valid.
 template <class T, class Compare = std::less<OwnPtr<T>>> class PtrSet
 {
 public:
-	typedef typename std::set<OwnPtr<T>, Compare>::iterator iterator;
-	typedef typename std::set<OwnPtr<T>, Compare>::const_iterator const_iterator;
-	typedef typename std::set<OwnPtr<T>, Compare>::size_type size_type;
+	// The iterators are const, as with a std::set, so that the objects can't be replaced without updating the lookup.
+	typedef typename std::vector<OwnPtr<T>>::const_iterator iterator;
+	typedef typename std::vector<OwnPtr<T>>::const_iterator const_iterator;
+	typedef typename std::vector<OwnPtr<T>>::size_type size_type;
+
+	// Constructor. Compare is used for the sort order.
+	PtrSet(Compare const & compare = Compare());
 
+	// Adds the object at the end and returns an iterator to it. If the object is already in the set, returns an iterator to the existing one. O(1) amortized.
 	iterator insert(OwnPtr<T> object);
 
-	iterator erase(Ptr<T> object);
+	// Removes the object and returns an iterator to the object that took its place, so that a loop can erase the current object and continue from the result. O(1)
+	iterator erase(Ptr<T> const & object);
 
+	// Removes all of the objects. O(number of objects)
 	void clear();
 
+	// Returns true if there are no objects. O(1)
 	bool empty() const;
 
+	// Returns the number of objects. O(1)
 	size_type size() const;
 
-	iterator find(Ptr<T> object);
+	// Returns an iterator to the object, or end() if it isn't in the set. O(1)
+	iterator find(Ptr<T> const & object);
+
+	// Returns an iterator to the object, or end() if it isn't in the set. O(1)
+	const_iterator find(Ptr<T> const & object) const;
+
+	// Sorts the objects by Compare if they have changed since the last sort. O(1) if nothing changed, otherwise O(n log n).
+	void sort();
+
+	// Marks the objects as needing a sort. Call it when something that Compare depends on has changed.
+	void setUnsorted();
 
-	const_iterator find(Ptr<T> object) const;
+	// Returns true if the objects are currently in the Compare order. O(1)
+	bool isSorted() const;
 
 	iterator begin();
 
@@ -36,35 +62,63 @@ public:
 	const_iterator end() const;
 
 private:
-	std::set<OwnPtr<T>, Compare> objects;
-	std::map<Ptr<T>, typename std::set<OwnPtr<T>, Compare>::iterator> objectLookup;
+	std::vector<OwnPtr<T>> objects;
+	std::unordered_map<void const *, size_type> objectLookup; // The index in objects of each object.
+	Compare compare;
+	bool sorted;
 };
 
 // Template Implementation
 
+template <class T, class Compare>
+PtrSet<T, Compare>::PtrSet(Compare const & compare_) : compare(compare_)
+{
+	sorted = true;
+}
+
 template <class T, class Compare>
 typename PtrSet<T, Compare>::iterator PtrSet<T, Compare>::insert(OwnPtr<T> object)
 {
-	auto iterator = objects.insert(object);
-	objectLookup[object] = iterator.first;
-	return iterator.first;
+	auto result = objectLookup.insert(std::make_pair((void const *)object.raw(), objects.size()));
+	if(!result.second)
+	{
+		return objects.begin() + result.first->second;
+	}
+	if(sorted && !objects.empty() && compare(object, objects.back()))
+	{
+		sorted = false;
+	}
+	try
+	{
+		objects.push_back(std::move(object));
+	}
+	catch(...)
+	{
+		objectLookup.erase(result.first);
+		throw;
+	}
+	return objects.end() - 1;
 }
 
 template <class T, class Compare>
-typename PtrSet<T, Compare>::iterator PtrSet<T, Compare>::erase(Ptr<T> object)
+typename PtrSet<T, Compare>::iterator PtrSet<T, Compare>::erase(Ptr<T> const & object)
 {
-	auto iterator = objectLookup.find(object);
-	typename std::set<OwnPtr<T>, Compare>::iterator returnIterator;
-	if(iterator != objectLookup.end())
+	auto it = objectLookup.find((void const *)object.raw());
+	if(it == objectLookup.end())
 	{
-		returnIterator = objects.erase(iterator->second);
-		objectLookup.erase(iterator);
+		return objects.end();
 	}
-	else
+	size_type index = it->second;
+	objectLookup.erase(it);
+	OwnPtr<T> erased = std::move(objects[index]); // Destroyed at the end, after the set is consistent again.
+	if(index != objects.size() - 1)
 	{
-		returnIterator = objects.end();
+		objects[index] = std::move(objects.back());
+		objectLookup[(void const *)objects[index].raw()] = index;
+		sorted = false;
 	}
-	return returnIterator;
+	objects.pop_back();
+	return objects.begin() + index;
 }
 
 template <class T, class Compare>
@@ -72,6 +126,7 @@ void PtrSet<T, Compare>::clear()
 {
 	objectLookup.clear();
 	objects.clear();
+	sorted = true;
 }
 
 template <class T, class Compare>
@@ -87,27 +142,54 @@ typename PtrSet<T, Compare>::size_type PtrSet<T, Compare>::size() const
 }
 
 template <class T, class Compare>
-typename PtrSet<T, Compare>::iterator PtrSet<T, Compare>::find(Ptr<T> object)
+typename PtrSet<T, Compare>::iterator PtrSet<T, Compare>::find(Ptr<T> const & object)
 {
-	auto iterator = objectLookup.find(object);
-	if(iterator != objectLookup.end())
+	auto it = objectLookup.find((void const *)object.raw());
+	if(it != objectLookup.end())
 	{
-		return iterator->second;
+		return objects.begin() + it->second;
 	}
 	return objects.end();
 }
 
 template <class T, class Compare>
-typename PtrSet<T, Compare>::const_iterator PtrSet<T, Compare>::find(Ptr<T> object) const
+typename PtrSet<T, Compare>::const_iterator PtrSet<T, Compare>::find(Ptr<T> const & object) const
 {
-	auto iterator = objectLookup.find(object);
-	if(iterator != objectLookup.end())
+	auto it = objectLookup.find((void const *)object.raw());
+	if(it != objectLookup.end())
 	{
-		return iterator->second;
+		return objects.begin() + it->second;
 	}
 	return objects.end();
 }
 
+template <class T, class Compare>
+void PtrSet<T, Compare>::sort()
+{
+	if(sorted)
+	{
+		return;
+	}
+	std::stable_sort(objects.begin(), objects.end(), compare);
+	for(size_type i = 0; i < objects.size(); i++)
+	{
+		objectLookup[(void const *)objects[i].raw()] = i;
+	}
+	sorted = true;
+}
+
+template <class T, class Compare>
+void PtrSet<T, Compare>::setUnsorted()
+{
+	sorted = false;
+}
+
+template <class T, class Compare>
+bool PtrSet<T, Compare>::isSorted() const
+{
+	return sorted;
+}
+
 template <class T, class Compare>
 typename PtrSet<T, Compare>::iterator PtrSet<T, Compare>::begin()
 {
@@ -131,4 +213,3 @@ typename PtrSet<T, Compare>::const_iterator PtrSet<T, Compare>::end() const
 {
 	return objects.end();
 }
-
@@ -6,11 +6,11 @@ template <typename T>
 class Quaternion
 {
 public:
-	Quaternion();
+	constexpr Quaternion();
 
-	Quaternion(T r, T i, T j, T k);
+	constexpr Quaternion(T r, T i, T j, T k);
 
-	Quaternion(T r, Coord<3, T> ijk);
+	constexpr Quaternion(T r, Coord<3, T> ijk);
 
 	Quaternion(T angle, Coord<3, T> const & axis, bool axisIsNormalized);
 
@@ -18,23 +18,23 @@ public:
 
 	Quaternion(T yaw, T pitch, T roll);
 
-	Quaternion<T> conjugate() const;
+	constexpr Quaternion<T> conjugate() const;
 
-	Quaternion<T> inverse() const;  // alias for conjugate
+	constexpr Quaternion<T> inverse() const;  // alias for conjugate
 
-	Quaternion<T> reciprocal() const;
+	constexpr Quaternion<T> reciprocal() const;
 
 	T norm() const;
 
-	T normSq() const;
+	constexpr T normSq() const;
 
 	void normalize();
 
-	Coord<3, T> rotate(Coord<3, T> const & v) const;  // assumes this is normalized
+	constexpr Coord<3, T> rotate(Coord<3, T> const & v) const;  // assumes this is normalized
 
-	Coord<3, T> getAxis(unsigned int i) const;  // assumes this is normalized
+	constexpr Coord<3, T> getAxis(unsigned int i) const;  // assumes this is normalized
 
-	Matrix<3, 3, T> getMatrix() const;  // for pre multiplying, assumes this is normalized
+	constexpr Matrix<3, 3, T> getMatrix() const;  // for pre multiplying, assumes this is normalized
 
 	T r;
 
@@ -45,51 +45,52 @@ typedef Quaternion<float> Quaternionf;
 typedef Quaternion<double> Quaterniond;
 
 template <typename T>
-Quaternion<T> operator + (Quaternion<T> const & q_lhs, Quaternion<T> const & q_rhs);
+constexpr Quaternion<T> operator + (Quaternion<T> const & q_lhs, Quaternion<T> const & q_rhs);
 
 template <typename T>
-Quaternion<T> operator - (Quaternion<T> const & q_lhs, Quaternion<T> const & q_rhs);
+constexpr Quaternion<T> operator - (Quaternion<T> const & q_lhs, Quaternion<T> const & q_rhs);
 
 template <typename T>
-Quaternion<T> operator * (Quaternion<T> const & q_lhs, Quaternion<T> const & q_rhs);
+constexpr Quaternion<T> operator * (Quaternion<T> const & q_lhs, Quaternion<T> const & q_rhs);
 
 template <typename T>
-Quaternion<T> operator * (Quaternion<T> const & q, T t);
+constexpr Quaternion<T> operator * (Quaternion<T> const & q, T t);
 
 template <typename T>
-Quaternion<T> operator * (T t, Quaternion<T> const & q);
+constexpr Quaternion<T> operator * (T t, Quaternion<T> const & q);
+
+// Returns the normalized linear interpolation from q0 to q1 by t, along the shorter path. Both must be normalized.
+template <typename T>
+Quaternion<T> nlerp(Quaternion<T> const & q0, Quaternion<T> const & q1, T t);
+
+// Returns the spherical linear interpolation from q0 to q1 by t, along the shorter path. Both must be normalized.
+template <typename T>
+Quaternion<T> slerp(Quaternion<T> const & q0, Quaternion<T> const & q1, T t);
 
 // Template implementation
 
 template <typename T>
-Quaternion<T>::Quaternion()
+constexpr Quaternion<T>::Quaternion() : r(1), ijk()
 {
-	r = 1;
-	ijk = {0, 0, 0};
 }
 
 template <typename T>
-Quaternion<T>::Quaternion(T r_, T i, T j, T k)
+constexpr Quaternion<T>::Quaternion(T r_, T i, T j, T k) : r(r_), ijk{i, j, k}
 {
-	r = r;
-	ijk = {i, j, k};
 }
 
 template <typename T>
-Quaternion<T>::Quaternion(T r_, Coord<3, T> ijk_)
+constexpr Quaternion<T>::Quaternion(T r_, Coord<3, T> ijk_) : r(r_), ijk(ijk_)
 {
-	r = r_;
-	ijk = ijk_
 }
 
 template <typename T>
 Quaternion<T>::Quaternion(Coord<3, T> const & start, Coord<3, T> const & end, bool vectorsAreNormalized)
 {
-	r = startCoord.dot(end);
-	Coord<3, T> axis;
+	r = start.dot(end);
 	if(r != -1)
 	{
-		ijk = startCoord.cross(end);
+		ijk = start.cross(end);
 	}
 	else
 	{
@@ -138,26 +139,26 @@ Quaternion<T>::Quaternion(T yaw, T pitch, T roll)
 }
 
 template <typename T>
-Quaternion<T> Quaternion<T>::conjugate() const
+constexpr Quaternion<T> Quaternion<T>::conjugate() const
 {
 	return Quaternion<T>(r, -ijk);
 }
 
 template <typename T>
-Quaternion<T> Quaternion<T>::inverse() const
+constexpr Quaternion<T> Quaternion<T>::inverse() const
 {
 	return conjugate();
 }
 
 template <typename T>
-Quaternion<T> Quaternion<T>::reciprocal() const
+constexpr Quaternion<T> Quaternion<T>::reciprocal() const
 {
 	T nSq = normSq();
 	if(nSq == 0)
 	{
 		throw std::exception();
 	}
-	return conjugate() / nSq;
+	return conjugate() * ((T)1 / nSq);
 }
 
 template <typename T>
@@ -167,7 +168,7 @@ T Quaternion<T>::norm() const
 }
 
 template <typename T>
-T Quaternion<T>::normSq() const
+constexpr T Quaternion<T>::normSq() const
 {
 	return (r * r) + ijk.normSq();
 }
@@ -180,46 +181,47 @@ void Quaternion<T>::normalize()
 	{
 		throw std::exception();
 	}
-	r /= n;
-	ijk /= n;
+	T nInv = 1 / n;
+	r *= nInv;
+	ijk *= nInv;
 }
 
 template <typename T>
-Coord<3, T> Quaternion<T>::rotate(Coord<3, T> const & v) const
+constexpr Coord<3, T> Quaternion<T>::rotate(Coord<3, T> const & v) const
 {
 	Coord<3, T> t = (T)2 * ijk.cross(v);
 	return v + r * t + ijk.cross(t);
 }
 
 template <typename T>
-Coord<3, T> Quaternion<T>::getAxis(unsigned int i) const
+constexpr Coord<3, T> Quaternion<T>::getAxis(unsigned int i) const
 {
 	if(i >= 3)
 	{
 		throw std::exception();
 	}
-	Coord3f axis;
+	Coord<3, T> axis;
 	unsigned int j = (i + 1) % 3;
 	unsigned int k = (i + 2) % 3;
-	axis[i] = 1.0f - 2.0f * (ijk[j] * ijk[j] + ijk[k] * ijk[k]);
-	axis[j] = 2.0f * (ijk[i] * ijk[j] + ijk[k] * r);
-	axis[k] = 2.0f * (ijk[i] * ijk[k] - ijk[j] * r);
+	axis[i] = (T)1 - (T)2 * (ijk[j] * ijk[j] + ijk[k] * ijk[k]);
+	axis[j] = (T)2 * (ijk[i] * ijk[j] + ijk[k] * r);
+	axis[k] = (T)2 * (ijk[i] * ijk[k] - ijk[j] * r);
 	return axis;
 }
 
 template <typename T>
-Matrix<3, 3, T> Quaternion<T>::getMatrix() const
+constexpr Matrix<3, 3, T> Quaternion<T>::getMatrix() const
 {
 	Matrix<3, 3, T> m;
-	float ii = ijk[0] * ijk[0];
-	float ij = ijk[0] * ijk[1];
-	float ik = ijk[0] * ijk[2];
-	float ir = ijk[0] * r;
-	float jj = ijk[1] * ijk[1];
-	float jk = ijk[1] * ijk[2];
-	float jr = ijk[1] * r;
-	float kk = ijk[2] * ijk[2];
-	float kr = ijk[2] * r;
+	T ii = ijk[0] * ijk[0];
+	T ij = ijk[0] * ijk[1];
+	T ik = ijk[0] * ijk[2];
+	T ir = ijk[0] * r;
+	T jj = ijk[1] * ijk[1];
+	T jk = ijk[1] * ijk[2];
+	T jr = ijk[1] * r;
+	T kk = ijk[2] * ijk[2];
+	T kr = ijk[2] * r;
 	m(0, 0) = (T)1 - (T)2 * (jj + kk);
 	m(0, 1) = (T)2 * (ij - kr);
 	m(0, 2) = (T)2 * (ik + jr);
@@ -233,32 +235,74 @@ Matrix<3, 3, T> Quaternion<T>::getMatrix() const
 }
 
 template <typename T>
-Quaternion<T> operator + (Quaternion<T> const & q_lhs, Quaternion<T> const & q_rhs)
+constexpr Quaternion<T> operator + (Quaternion<T> const & q_lhs, Quaternion<T> const & q_rhs)
 {
 	return Quaternion<T>(q_lhs.r + q_rhs.r, q_lhs.ijk + q_rhs.ijk);
 }
 
 template <typename T>
-Quaternion<T> operator - (Quaternion<T> const & q_lhs, Quaternion<T> const & q_rhs)
+constexpr Quaternion<T> operator - (Quaternion<T> const & q_lhs, Quaternion<T> const & q_rhs)
 {
 	return Quaternion<T>(q_lhs.r - q_rhs.r, q_lhs.ijk - q_rhs.ijk);
 }
 
 template <typename T>
-Quaternion<T> operator * (Quaternion<T> const & q_lhs, Quaternion<T> const & q_rhs)
+constexpr Quaternion<T> operator * (Quaternion<T> const & q_lhs, Quaternion<T> const & q_rhs)
 {
-	return Quaternion<T>(q_lhs.r * q_rhs.r - q_lhs.ijk.dot(q_rhs.ijk), q_lhs.r * q_rhs.ijk + q_rhs.r * q_lhs.jik + q_lhs.ijk.cross(q_rhs.ijk));
+	return Quaternion<T>(q_lhs.r * q_rhs.r - q_lhs.ijk.dot(q_rhs.ijk), q_lhs.r * q_rhs.ijk + q_rhs.r * q_lhs.ijk + q_lhs.ijk.cross(q_rhs.ijk));
 }
 
 template <typename T>
-Quaternion<T> operator * (Quaternion<T> const & q, T t)
+constexpr Quaternion<T> operator * (Quaternion<T> const & q, T t)
 {
 	return Quaternion<T>(q.r * t, q.ijk * t);
 }
 
 template <typename T>
-Quaternion<T> operator * (T t, Quaternion<T> const & q)
+constexpr Quaternion<T> operator * (T t, Quaternion<T> const & q)
 {
 	return Quaternion<T>(t * q.r, t * q.ijk);
 }
 
+template <typename T>
+Quaternion<T> nlerp(Quaternion<T> const & q0, Quaternion<T> const & q1, T t)
+{
+	T d = q0.r * q1.r + q0.ijk.dot(q1.ijk);
+	T t1 = d < 0 ? -t : t;
+	Quaternion<T> r = ((T)1 - t) * q0 + t1 * q1;
+	r.normalize();
+	return r;
+}
+
+template <typename T>
+Quaternion<T> slerp(Quaternion<T> const & q0, Quaternion<T> const & q1, T t)
+{
+	T d = q0.r * q1.r + q0.ijk.dot(q1.ijk);
+	T sign = 1;
+	if(d < 0)
+	{
+		d = -d;
+		sign = -1;
+	}
+	T w0 = (T)1 - t;
+	T w1 = t;
+	if(d < (T)0.9995) // Otherwise the angle is so small that nlerp is just as good, and avoids dividing by a tiny sine.
+	{
+		T angle = std::acos(d);
+		T sinAngleInv = (T)1 / std::sin(angle);
+		w0 = std::sin(w0 * angle) * sinAngleInv;
+		w1 = std::sin(w1 * angle) * sinAngleInv;
+	}
+	Quaternion<T> r = w0 * q0 + (sign * w1) * q1;
+	r.normalize();
+	return r;
+}
+
+
+// Compile-time checks that the constexpr functions can be used in constant expressions. For floats, the product uses the run-time
+// SIMD dot of Coord3f, so it isn't usable in constant expressions.
+static_assert(Quaterniond(0, 0, 0, 1).getMatrix() * Coord3d{1, 0, 0} == Coord3d{-1, 0, 0}, "Quaternion must be usable in constant expressions.");
+static_assert((Quaterniond(0, 0, 0, 1) * Quaterniond(0, 0, 0, 1)).r == -1, "Quaternion must be usable in constant expressions.");
+static_assert(Quaternionf(0, 0, 0, 1).getMatrix() * Coord3f{1, 0, 0} == Coord3f{-1, 0, 0}, "Quaternion must be usable in constant expressions.");
+static_assert(Quaternionf(0, 0, 0, 1).rotate(Coord3f{1, 0, 0}) == Coord3f{-1, 0, 0}, "Quaternion must be usable in constant expressions.");
+static_assert(Quaternionf(0, 0, 0, 1).getAxis(1) == Coord3f{0, -1, 0}, "Quaternion must be usable in constant expressions.");
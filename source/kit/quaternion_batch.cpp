@@ -0,0 +1,360 @@
+#include "quaternion_batch.h"
+#include "simd.h"
+
+static_assert(sizeof(Quaternionf) == 4 * sizeof(float), "Quaternionf arrays must be tightly packed floats, r first.");
+static_assert(sizeof(Matrix33f) == 9 * sizeof(float), "Matrix33f arrays must be tightly packed floats.");
+static_assert(sizeof(Coord3f) == 3 * sizeof(float), "Coord3f arrays must be tightly packed floats.");
+
+namespace
+{
+	Quaternionf load(Batch::QuaternionArrays const & a, unsigned int index)
+	{
+		return Quaternionf(a.r[index], a.i[index], a.j[index], a.k[index]);
+	}
+
+	void store(Batch::QuaternionArrays const & a, unsigned int index, Quaternionf const & q)
+	{
+		a.r[index] = q.r;
+		a.i[index] = q.ijk[0];
+		a.j[index] = q.ijk[1];
+		a.k[index] = q.ijk[2];
+	}
+
+#if SIMD_ENABLED
+	// Four quaternions, with each component in its own register.
+	class Quaternion4
+	{
+	public:
+		Simd::Float4 r, i, j, k;
+	};
+
+	Quaternion4 load4(Quaternionf const * q)
+	{
+		float const * p = reinterpret_cast<float const *>(q);
+		Quaternion4 a;
+		a.r = Simd::load(p + 0);
+		a.i = Simd::load(p + 4);
+		a.j = Simd::load(p + 8);
+		a.k = Simd::load(p + 12);
+		Simd::transpose(a.r, a.i, a.j, a.k);
+		return a;
+	}
+
+	void store4(Quaternionf * q, Quaternion4 a)
+	{
+		float * p = reinterpret_cast<float *>(q);
+		Simd::transpose(a.r, a.i, a.j, a.k);
+		Simd::store(p + 0, a.r);
+		Simd::store(p + 4, a.i);
+		Simd::store(p + 8, a.j);
+		Simd::store(p + 12, a.k);
+	}
+
+	Quaternion4 load4(Batch::QuaternionArrays const & a, unsigned int index)
+	{
+		Quaternion4 q;
+		q.r = Simd::load(a.r + index);
+		q.i = Simd::load(a.i + index);
+		q.j = Simd::load(a.j + index);
+		q.k = Simd::load(a.k + index);
+		return q;
+	}
+
+	void store4(Batch::QuaternionArrays const & a, unsigned int index, Quaternion4 const & q)
+	{
+		Simd::store(a.r + index, q.r);
+		Simd::store(a.i + index, q.i);
+		Simd::store(a.j + index, q.j);
+		Simd::store(a.k + index, q.k);
+	}
+
+	Simd::Float4 dot(Quaternion4 const & a, Quaternion4 const & b)
+	{
+		Simd::Float4 d = Simd::mul(a.r, b.r);
+		d = Simd::mulAdd(a.i, b.i, d);
+		d = Simd::mulAdd(a.j, b.j, d);
+		return Simd::mulAdd(a.k, b.k, d);
+	}
+
+	Quaternion4 normalize(Quaternion4 const & q)
+	{
+		Simd::Float4 nInv = Simd::div(Simd::splat(1.0f), Simd::sqrt(dot(q, q)));
+		Quaternion4 r;
+		r.r = Simd::mul(q.r, nInv);
+		r.i = Simd::mul(q.i, nInv);
+		r.j = Simd::mul(q.j, nInv);
+		r.k = Simd::mul(q.k, nInv);
+		return r;
+	}
+
+	// Returns w0 q0 + w1 q1, normalized.
+	Quaternion4 blend(Quaternion4 const & q0, Simd::Float4 w0, Quaternion4 const & q1, Simd::Float4 w1)
+	{
+		Quaternion4 r;
+		r.r = Simd::mulAdd(w0, q0.r, Simd::mul(w1, q1.r));
+		r.i = Simd::mulAdd(w0, q0.i, Simd::mul(w1, q1.i));
+		r.j = Simd::mulAdd(w0, q0.j, Simd::mul(w1, q1.j));
+		r.k = Simd::mulAdd(w0, q0.k, Simd::mul(w1, q1.k));
+		return normalize(r);
+	}
+
+	// The same as nlerp in quaternion.h.
+	Quaternion4 nlerp(Quaternion4 const & q0, Quaternion4 const & q1, float const * t)
+	{
+		Simd::Float4 t4 = Simd::load(t);
+		return blend(q0, Simd::sub(Simd::splat(1.0f), t4), q1, Simd::mulSign(t4, dot(q0, q1)));
+	}
+
+	// The same as slerp in quaternion.h, to within float rounding. Instead of acos and sin, the weights sin(t angle) / sin(angle) use the
+	// series from Eberly, "A Fast and Accurate Algorithm for Computing SLERP", which needs only multiplies and adds. With fourteen terms,
+	// and the last one scaled by onePlusMu, the error is below 2e-7 for all t in [0, 1] and angles up to 90 degrees, which is all that the shorter path needs.
+	Quaternion4 slerp(Quaternion4 const & q0, Quaternion4 const & q1, float const * t)
+	{
+		static unsigned int const numTerms = 14;
+		static float const onePlusMu = 1.9066f;
+		static float const u[numTerms] = {1.0f / (1 * 3), 1.0f / (2 * 5), 1.0f / (3 * 7), 1.0f / (4 * 9), 1.0f / (5 * 11), 1.0f / (6 * 13), 1.0f / (7 * 15), 1.0f / (8 * 17), 1.0f / (9 * 19), 1.0f / (10 * 21), 1.0f / (11 * 23), 1.0f / (12 * 25), 1.0f / (13 * 27), onePlusMu / (14 * 29)};
+		static float const v[numTerms] = {1.0f / 3, 2.0f / 5, 3.0f / 7, 4.0f / 9, 5.0f / 11, 6.0f / 13, 7.0f / 15, 8.0f / 17, 9.0f / 19, 10.0f / 21, 11.0f / 23, 12.0f / 25, 13.0f / 27, onePlusMu * 14 / 29};
+		Simd::Float4 one = Simd::splat(1.0f);
+		Simd::Float4 d = dot(q0, q1);
+		Simd::Float4 xm1 = Simd::sub(Simd::mulSign(d, d), one); // |d| - 1
+		Simd::Float4 t1 = Simd::load(t);
+		Simd::Float4 t0 = Simd::sub(one, t1);
+		Simd::Float4 t0Sq = Simd::mul(t0, t0);
+		Simd::Float4 t1Sq = Simd::mul(t1, t1);
+		Simd::Float4 w0 = one;
+		Simd::Float4 w1 = one;
+		for(int i = numTerms - 1; i >= 0; i--)
+		{
+			Simd::Float4 ui = Simd::splat(u[i]);
+			Simd::Float4 vi = Simd::splat(v[i]);
+			w0 = Simd::mulAdd(Simd::mul(Simd::sub(Simd::mul(ui, t0Sq), vi), xm1), w0, one);
+			w1 = Simd::mulAdd(Simd::mul(Simd::sub(Simd::mul(ui, t1Sq), vi), xm1), w1, one);
+		}
+		return blend(q0, Simd::mul(t0, w0), q1, Simd::mulSign(Simd::mul(t1, w1), d));
+	}
+
+	// The same as Quaternion::getMatrix, for four quaternions into four matrices.
+	void toMatrices(Quaternion4 const & q, Matrix33f * results)
+	{
+		Simd::Float4 one = Simd::splat(1.0f);
+		Simd::Float4 two = Simd::splat(2.0f);
+		Simd::Float4 ii = Simd::mul(q.i, q.i);
+		Simd::Float4 jj = Simd::mul(q.j, q.j);
+		Simd::Float4 kk = Simd::mul(q.k, q.k);
+		Simd::Float4 ij = Simd::mul(q.i, q.j);
+		Simd::Float4 ik = Simd::mul(q.i, q.k);
+		Simd::Float4 jk = Simd::mul(q.j, q.k);
+		Simd::Float4 ir = Simd::mul(q.i, q.r);
+		Simd::Float4 jr = Simd::mul(q.j, q.r);
+		Simd::Float4 kr = Simd::mul(q.k, q.r);
+
+		// Column-major, so e[col * 3 + row]. The last three are padding for the transpose.
+		Simd::Float4 e[12];
+		e[0] = Simd::sub(one, Simd::mul(two, Simd::add(jj, kk)));
+		e[1] = Simd::mul(two, Simd::add(ij, kr));
+		e[2] = Simd::mul(two, Simd::sub(ik, jr));
+		e[3] = Simd::mul(two, Simd::sub(ij, kr));
+		e[4] = Simd::sub(one, Simd::mul(two, Simd::add(ii, kk)));
+		e[5] = Simd::mul(two, Simd::add(jk, ir));
+		e[6] = Simd::mul(two, Simd::add(ik, jr));
+		e[7] = Simd::mul(two, Simd::sub(jk, ir));
+		e[8] = Simd::sub(one, Simd::mul(two, Simd::add(ii, jj)));
+		e[9] = e[10] = e[11] = one;
+
+		// Transpose, so that each matrix's nine floats are contiguous.
+		Simd::transpose(e[0], e[1], e[2], e[3]);
+		Simd::transpose(e[4], e[5], e[6], e[7]);
+		Simd::transpose(e[8], e[9], e[10], e[11]);
+		// The store of the ninth float writes three floats past the matrix, which the next matrix then overwrites, except for the last one.
+		float * m = results[0].ptr();
+		for(unsigned int k = 0; k < 3; k++, m += 9)
+		{
+			Simd::store(m + 0, e[k]);
+			Simd::store(m + 4, e[4 + k]);
+			Simd::store(m + 8, e[8 + k]);
+		}
+		float last[4];
+		Simd::store(m + 0, e[3]);
+		Simd::store(m + 4, e[7]);
+		Simd::store(last, e[11]);
+		m[8] = last[0];
+	}
+
+	// The same as Quaternion::rotate, for four quaternions and vectors. Sets (x, y, z) to the rotated vectors.
+	void rotate(Quaternion4 const & q, Simd::Float4 & x, Simd::Float4 & y, Simd::Float4 & z)
+	{
+		// t = 2 ijk x v, and then v + r t + ijk x t.
+		Simd::Float4 two = Simd::splat(2.0f);
+		Simd::Float4 tx = Simd::mul(two, Simd::sub(Simd::mul(q.j, z), Simd::mul(q.k, y)));
+		Simd::Float4 ty = Simd::mul(two, Simd::sub(Simd::mul(q.k, x), Simd::mul(q.i, z)));
+		Simd::Float4 tz = Simd::mul(two, Simd::sub(Simd::mul(q.i, y), Simd::mul(q.j, x)));
+		x = Simd::add(Simd::mulAdd(q.r, tx, x), Simd::sub(Simd::mul(q.j, tz), Simd::mul(q.k, ty)));
+		y = Simd::add(Simd::mulAdd(q.r, ty, y), Simd::sub(Simd::mul(q.k, tx), Simd::mul(q.i, tz)));
+		z = Simd::add(Simd::mulAdd(q.r, tz, z), Simd::sub(Simd::mul(q.i, ty), Simd::mul(q.j, tx)));
+	}
+#endif
+}
+
+void Batch::normalizeQuaternions(Quaternionf * quaternions, unsigned int count)
+{
+	unsigned int i = 0;
+#if SIMD_ENABLED
+	for(; i + 4 <= count; i += 4)
+	{
+		store4(quaternions + i, normalize(load4(quaternions + i)));
+	}
+#endif
+	for(; i < count; i++)
+	{
+		quaternions[i].normalize();
+	}
+}
+
+void Batch::normalizeQuaternions(QuaternionArrays const & quaternions, unsigned int count)
+{
+	unsigned int i = 0;
+#if SIMD_ENABLED
+	for(; i + 4 <= count; i += 4)
+	{
+		store4(quaternions, i, normalize(load4(quaternions, i)));
+	}
+#endif
+	for(; i < count; i++)
+	{
+		Quaternionf q = load(quaternions, i);
+		q.normalize();
+		store(quaternions, i, q);
+	}
+}
+
+void Batch::nlerpQuaternions(Quaternionf const * q0, Quaternionf const * q1, float const * t, Quaternionf * results, unsigned int count)
+{
+	unsigned int i = 0;
+#if SIMD_ENABLED
+	for(; i + 4 <= count; i += 4)
+	{
+		store4(results + i, nlerp(load4(q0 + i), load4(q1 + i), t + i));
+	}
+#endif
+	for(; i < count; i++)
+	{
+		results[i] = nlerp(q0[i], q1[i], t[i]);
+	}
+}
+
+void Batch::nlerpQuaternions(QuaternionArrays const & q0, QuaternionArrays const & q1, float const * t, QuaternionArrays const & results, unsigned int count)
+{
+	unsigned int i = 0;
+#if SIMD_ENABLED
+	for(; i + 4 <= count; i += 4)
+	{
+		store4(results, i, nlerp(load4(q0, i), load4(q1, i), t + i));
+	}
+#endif
+	for(; i < count; i++)
+	{
+		store(results, i, nlerp(load(q0, i), load(q1, i), t[i]));
+	}
+}
+
+void Batch::slerpQuaternions(Quaternionf const * q0, Quaternionf const * q1, float const * t, Quaternionf * results, unsigned int count)
+{
+	unsigned int i = 0;
+#if SIMD_ENABLED
+	for(; i + 4 <= count; i += 4)
+	{
+		store4(results + i, slerp(load4(q0 + i), load4(q1 + i), t + i));
+	}
+#endif
+	for(; i < count; i++)
+	{
+		results[i] = slerp(q0[i], q1[i], t[i]);
+	}
+}
+
+void Batch::slerpQuaternions(QuaternionArrays const & q0, QuaternionArrays const & q1, float const * t, QuaternionArrays const & results, unsigned int count)
+{
+	unsigned int i = 0;
+#if SIMD_ENABLED
+	for(; i + 4 <= count; i += 4)
+	{
+		store4(results, i, slerp(load4(q0, i), load4(q1, i), t + i));
+	}
+#endif
+	for(; i < count; i++)
+	{
+		store(results, i, slerp(load(q0, i), load(q1, i), t[i]));
+	}
+}
+
+void Batch::quaternionsToMatrices(Quaternionf const * quaternions, Matrix33f * results, unsigned int count)
+{
+	unsigned int i = 0;
+#if SIMD_ENABLED
+	for(; i + 4 <= count; i += 4)
+	{
+		toMatrices(load4(quaternions + i), results + i);
+	}
+#endif
+	for(; i < count; i++)
+	{
+		results[i] = quaternions[i].getMatrix();
+	}
+}
+
+void Batch::quaternionsToMatrices(QuaternionArrays const & quaternions, Matrix33f * results, unsigned int count)
+{
+	unsigned int i = 0;
+#if SIMD_ENABLED
+	for(; i + 4 <= count; i += 4)
+	{
+		toMatrices(load4(quaternions, i), results + i);
+	}
+#endif
+	for(; i < count; i++)
+	{
+		results[i] = load(quaternions, i).getMatrix();
+	}
+}
+
+void Batch::rotateVectors(Quaternionf const * quaternions, Coord3f const * vectors, Coord3f * results, unsigned int count)
+{
+	unsigned int i = 0;
+#if SIMD_ENABLED
+	for(; i + 4 <= count; i += 4)
+	{
+		Simd::Float4 x, y, z;
+		Simd::loadInterleaved3(vectors[i].ptr(), x, y, z);
+		rotate(load4(quaternions + i), x, y, z);
+		Simd::storeInterleaved3(results[i].ptr(), x, y, z);
+	}
+#endif
+	for(; i < count; i++)
+	{
+		results[i] = quaternions[i].rotate(vectors[i]);
+	}
+}
+
+void Batch::rotateVectors(QuaternionArrays const & quaternions, float const * x, float const * y, float const * z, float * rx, float * ry, float * rz, unsigned int count)
+{
+	unsigned int i = 0;
+#if SIMD_ENABLED
+	for(; i + 4 <= count; i += 4)
+	{
+		Simd::Float4 xi = Simd::load(x + i);
+		Simd::Float4 yi = Simd::load(y + i);
+		Simd::Float4 zi = Simd::load(z + i);
+		rotate(load4(quaternions, i), xi, yi, zi);
+		Simd::store(rx + i, xi);
+		Simd::store(ry + i, yi);
+		Simd::store(rz + i, zi);
+	}
+#endif
+	for(; i < count; i++)
+	{
+		Coord3f r = load(quaternions, i).rotate(Coord3f{x[i], y[i], z[i]});
+		rx[i] = r[0];
+		ry[i] = r[1];
+		rz[i] = r[2];
+	}
+}
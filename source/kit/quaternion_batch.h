@@ -0,0 +1,53 @@
+#pragma once
+
+#include "quaternion.h"
+
+/*
+Functions that normalize, interpolate, convert, or apply many quaternions at once, for animation and for updating many entities.
+As in transform_batch.h, the inner loops work on four quaternions at a time with SIMD when it is enabled.
+The AoS versions take arrays of Quaternionf and the SoA versions take a QuaternionArrays, with a separate array for each component.
+The quaternions must be normalized, except for the input of normalizeQuaternions, which must not be zero.
+The results may be written over the inputs, but the arrays may not otherwise overlap.
+*/
+namespace Batch
+{
+	// The separate r, i, j, and k arrays of many quaternions.
+	class QuaternionArrays
+	{
+	public:
+		float * r;
+		float * i;
+		float * j;
+		float * k;
+	};
+
+	// Normalizes each of the quaternions.
+	void normalizeQuaternions(Quaternionf * quaternions, unsigned int count);
+
+	// Normalizes each of the quaternions.
+	void normalizeQuaternions(QuaternionArrays const & quaternions, unsigned int count);
+
+	// Sets results[i] to nlerp(q0[i], q1[i], t[i]).
+	void nlerpQuaternions(Quaternionf const * q0, Quaternionf const * q1, float const * t, Quaternionf * results, unsigned int count);
+
+	// Sets the ith result to nlerp of the ith quaternions of q0 and q1 by t[i].
+	void nlerpQuaternions(QuaternionArrays const & q0, QuaternionArrays const & q1, float const * t, QuaternionArrays const & results, unsigned int count);
+
+	// Sets results[i] to slerp(q0[i], q1[i], t[i]).
+	void slerpQuaternions(Quaternionf const * q0, Quaternionf const * q1, float const * t, Quaternionf * results, unsigned int count);
+
+	// Sets the ith result to slerp of the ith quaternions of q0 and q1 by t[i].
+	void slerpQuaternions(QuaternionArrays const & q0, QuaternionArrays const & q1, float const * t, QuaternionArrays const & results, unsigned int count);
+
+	// Sets results[i] to quaternions[i].getMatrix().
+	void quaternionsToMatrices(Quaternionf const * quaternions, Matrix33f * results, unsigned int count);
+
+	// Sets results[i] to the matrix of the ith quaternion.
+	void quaternionsToMatrices(QuaternionArrays const & quaternions, Matrix33f * results, unsigned int count);
+
+	// Sets results[i] to quaternions[i].rotate(vectors[i]).
+	void rotateVectors(Quaternionf const * quaternions, Coord3f const * vectors, Coord3f * results, unsigned int count);
+
+	// Sets (rx[i], ry[i], rz[i]) to the ith quaternion rotating (x[i], y[i], z[i]).
+	void rotateVectors(QuaternionArrays const & quaternions, float const * x, float const * y, float const * z, float * rx, float * ry, float * rz, unsigned int count);
+}
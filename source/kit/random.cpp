@@ -0,0 +1,354 @@
+#include "random.h"
+#include "math_util.h"
+#include "simd.h"
+#include <random>
+#include <atomic>
+#include <cmath>
+
+namespace
+{
+	uint32_t rotl(uint32_t x, int k)
+	{
+		return (x << k) | (x >> (32 - k));
+	}
+
+	// Advances x and returns the next splitmix64 number, used to turn a seed into a well mixed state.
+	uint64_t splitMix64(uint64_t & x)
+	{
+		x += 0x9e3779b97f4a7c15ull;
+		uint64_t z = x;
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+		return z ^ (z >> 31);
+	}
+
+	// Turns the top 24 bits into a float between 0 (inclusive) and 1 (exclusive).
+	float bitsToFloat(uint32_t bits)
+	{
+		return (float)(bits >> 8) * (1.0f / 16777216.0f);
+	}
+
+	// Returns a seed that is different for every call, even if std::random_device is deterministic.
+	uint64_t newSeed()
+	{
+		static std::atomic<uint64_t> counter(0);
+		std::random_device device;
+		uint64_t seed = ((uint64_t)device() << 32) ^ device();
+		uint64_t count = counter.fetch_add(1);
+		return seed ^ splitMix64(count);
+	}
+
+#if SIMD_ENABLED
+	// Four uint32s and the few operations the streams need.
+#if defined(SIMD_SSE)
+	typedef __m128i UInt4;
+
+	UInt4 load(uint32_t const * p)
+	{
+		return _mm_loadu_si128((__m128i const *)p);
+	}
+
+	void store(uint32_t * p, UInt4 a)
+	{
+		_mm_storeu_si128((__m128i *)p, a);
+	}
+
+	UInt4 add(UInt4 a, UInt4 b)
+	{
+		return _mm_add_epi32(a, b);
+	}
+
+	UInt4 exclusiveOr(UInt4 a, UInt4 b)
+	{
+		return _mm_xor_si128(a, b);
+	}
+
+	template <int k> UInt4 shiftLeft(UInt4 a)
+	{
+		return _mm_slli_epi32(a, k);
+	}
+
+	template <int k> UInt4 rotl(UInt4 a)
+	{
+		return _mm_or_si128(_mm_slli_epi32(a, k), _mm_srli_epi32(a, 32 - k));
+	}
+
+	// Returns the top 24 bits of each as a float between 0 (inclusive) and 1 (exclusive).
+	Simd::Float4 bitsToFloat(UInt4 a)
+	{
+		return _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(a, 8)), _mm_set1_ps(1.0f / 16777216.0f));
+	}
+#else
+	typedef uint32x4_t UInt4;
+
+	UInt4 load(uint32_t const * p)
+	{
+		return vld1q_u32(p);
+	}
+
+	void store(uint32_t * p, UInt4 a)
+	{
+		vst1q_u32(p, a);
+	}
+
+	UInt4 add(UInt4 a, UInt4 b)
+	{
+		return vaddq_u32(a, b);
+	}
+
+	UInt4 exclusiveOr(UInt4 a, UInt4 b)
+	{
+		return veorq_u32(a, b);
+	}
+
+	template <int k> UInt4 shiftLeft(UInt4 a)
+	{
+		return vshlq_n_u32(a, k);
+	}
+
+	template <int k> UInt4 rotl(UInt4 a)
+	{
+		return vsriq_n_u32(vshlq_n_u32(a, k), a, 32 - k);
+	}
+
+	Simd::Float4 bitsToFloat(UInt4 a)
+	{
+		return vmulq_n_f32(vcvtq_f32_u32(vshrq_n_u32(a, 8)), 1.0f / 16777216.0f);
+	}
+#endif
+
+	// Advances the four streams and returns their next bits.
+	UInt4 nextBlock(UInt4 & s0, UInt4 & s1, UInt4 & s2, UInt4 & s3)
+	{
+		// rotl(s1 * 5, 7) * 9, with the multiplies as shifts and adds.
+		UInt4 r = add(shiftLeft<2>(s1), s1);
+		r = rotl<7>(r);
+		r = add(shiftLeft<3>(r), r);
+		UInt4 t = shiftLeft<9>(s1);
+		s2 = exclusiveOr(s2, s0);
+		s3 = exclusiveOr(s3, s1);
+		s1 = exclusiveOr(s1, s2);
+		s0 = exclusiveOr(s0, s3);
+		s2 = exclusiveOr(s2, t);
+		s3 = rotl<11>(s3);
+		return r;
+	}
+#endif
+}
+
+Random::Random()
+{
+	setSeed(newSeed());
+}
+
+Random::Random(uint64_t seed)
+{
+	setSeed(seed);
+}
+
+void Random::setSeed(uint64_t seed)
+{
+	uint64_t x = seed;
+	for(unsigned int i = 0; i < 4; i += 2)
+	{
+		uint64_t z = splitMix64(x);
+		state[i] = (uint32_t)z;
+		state[i + 1] = (uint32_t)(z >> 32);
+	}
+	for(unsigned int j = 0; j < 4; j++)
+	{
+		for(unsigned int i = 0; i < 4; i += 2)
+		{
+			uint64_t z = splitMix64(x);
+			streams[i][j] = (uint32_t)z;
+			streams[i + 1][j] = (uint32_t)(z >> 32);
+		}
+	}
+}
+
+uint32_t Random::nextBits()
+{
+	uint32_t r = rotl(state[1] * 5, 7) * 9;
+	uint32_t t = state[1] << 9;
+	state[2] ^= state[0];
+	state[3] ^= state[1];
+	state[1] ^= state[2];
+	state[0] ^= state[3];
+	state[2] ^= t;
+	state[3] = rotl(state[3], 11);
+	return r;
+}
+
+int Random::nextInt(int min, int max)
+{
+	assert(max > min);
+	// Maps the bits onto the range with a multiply instead of a modulo. The bias is at most range / 2^32.
+	uint32_t range = (uint32_t)max - (uint32_t)min;
+	return (int)((uint32_t)min + (uint32_t)(((uint64_t)nextBits() * range) >> 32));
+}
+
+float Random::nextFloat()
+{
+	return bitsToFloat(nextBits());
+}
+
+float Random::nextFloat(float min, float max)
+{
+	assert(max >= min);
+	return min + (max - min) * nextFloat();
+}
+
+double Random::nextDouble()
+{
+	uint64_t bits = ((uint64_t)nextBits() << 32) | nextBits();
+	return (double)(bits >> 11) * (1.0 / 9007199254740992.0);
+}
+
+double Random::nextDouble(double min, double max)
+{
+	assert(max >= min);
+	return min + (max - min) * nextDouble();
+}
+
+Coord2f Random::nextUnitVector2()
+{
+	float angle = nextFloat() * (float)Math::TWO_PI;
+	return Coord2f{std::cos(angle), std::sin(angle)};
+}
+
+Coord3f Random::nextUnitVector3()
+{
+	// A uniform z and angle around the z axis give a uniform point on the sphere (Archimedes' hat-box theorem).
+	float z = 1.0f - 2.0f * nextFloat();
+	float angle = nextFloat() * (float)Math::TWO_PI;
+	float r = std::sqrt(Math::max(0.0f, 1.0f - z * z));
+	return Coord3f{r * std::cos(angle), r * std::sin(angle), z};
+}
+
+void Random::nextBlock(uint32_t * values)
+{
+#if SIMD_ENABLED
+	UInt4 s0 = load(streams[0]);
+	UInt4 s1 = load(streams[1]);
+	UInt4 s2 = load(streams[2]);
+	UInt4 s3 = load(streams[3]);
+	store(values, ::nextBlock(s0, s1, s2, s3));
+	store(streams[0], s0);
+	store(streams[1], s1);
+	store(streams[2], s2);
+	store(streams[3], s3);
+#else
+	for(unsigned int j = 0; j < 4; j++)
+	{
+		values[j] = rotl(streams[1][j] * 5, 7) * 9;
+		uint32_t t = streams[1][j] << 9;
+		streams[2][j] ^= streams[0][j];
+		streams[3][j] ^= streams[1][j];
+		streams[1][j] ^= streams[2][j];
+		streams[0][j] ^= streams[3][j];
+		streams[2][j] ^= t;
+		streams[3][j] = rotl(streams[3][j], 11);
+	}
+#endif
+}
+
+void Random::fill(uint32_t * values, unsigned int count)
+{
+	unsigned int i = 0;
+#if SIMD_ENABLED
+	// Keep the streams in registers for the whole loop.
+	UInt4 s0 = load(streams[0]);
+	UInt4 s1 = load(streams[1]);
+	UInt4 s2 = load(streams[2]);
+	UInt4 s3 = load(streams[3]);
+	for(; i + 4 <= count; i += 4)
+	{
+		store(values + i, ::nextBlock(s0, s1, s2, s3));
+	}
+	store(streams[0], s0);
+	store(streams[1], s1);
+	store(streams[2], s2);
+	store(streams[3], s3);
+#else
+	for(; i + 4 <= count; i += 4)
+	{
+		nextBlock(values + i);
+	}
+#endif
+	if(i < count)
+	{
+		uint32_t block[4];
+		nextBlock(block);
+		for(unsigned int j = 0; i < count; i++, j++)
+		{
+			values[i] = block[j];
+		}
+	}
+}
+
+void Random::fill(int * values, unsigned int count, int min, int max)
+{
+	assert(max > min);
+	static_assert(sizeof(int) == sizeof(uint32_t), "The bits are generated in place.");
+	fill((uint32_t *)values, count);
+	uint32_t range = (uint32_t)max - (uint32_t)min;
+	for(unsigned int i = 0; i < count; i++)
+	{
+		values[i] = (int)((uint32_t)min + (uint32_t)(((uint64_t)(uint32_t)values[i] * range) >> 32));
+	}
+}
+
+void Random::fill(float * values, unsigned int count, float min, float max)
+{
+	assert(max >= min);
+	unsigned int i = 0;
+#if SIMD_ENABLED
+	UInt4 s0 = load(streams[0]);
+	UInt4 s1 = load(streams[1]);
+	UInt4 s2 = load(streams[2]);
+	UInt4 s3 = load(streams[3]);
+	Simd::Float4 min4 = Simd::splat(min);
+	Simd::Float4 size4 = Simd::splat(max - min);
+	for(; i + 4 <= count; i += 4)
+	{
+		Simd::store(values + i, Simd::mulAdd(size4, bitsToFloat(::nextBlock(s0, s1, s2, s3)), min4));
+	}
+	store(streams[0], s0);
+	store(streams[1], s1);
+	store(streams[2], s2);
+	store(streams[3], s3);
+#endif
+	uint32_t block[4];
+	for(; i < count; i += 4)
+	{
+		nextBlock(block);
+		for(unsigned int j = 0; j < 4 && i + j < count; j++)
+		{
+			values[i + j] = min + (max - min) * bitsToFloat(block[j]);
+		}
+	}
+}
+
+void Random::fillUnitVectors(Coord3f * values, unsigned int count)
+{
+	// Generate the zs and angles in bulk, then turn each pair into a vector, as in nextUnitVector3.
+	float z[256];
+	float angle[256];
+	for(unsigned int i = 0; i < count; i += 256)
+	{
+		unsigned int n = Math::min(count - i, 256u);
+		fill(z, n, -1.0f, 1.0f);
+		fill(angle, n, 0.0f, (float)Math::TWO_PI);
+		for(unsigned int j = 0; j < n; j++)
+		{
+			float r = std::sqrt(Math::max(0.0f, 1.0f - z[j] * z[j]));
+			values[i + j] = Coord3f{r * std::cos(angle[j]), r * std::sin(angle[j]), z[j]};
+		}
+	}
+}
+
+Random & Random::local()
+{
+	thread_local Random random;
+	return random;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "interval.h"
+#include <cstdint>
+
+/*
+A fast pseudo-random number generator, using xoshiro128** seeded with splitmix64. It isn't suitable for cryptography.
+Each generator is meant to be used by one thread at a time. Use Random::local() to get the generator of the calling thread.
+The fill functions use four separate streams at once, four numbers at a time with SIMD. They give the same numbers with or without SIMD,
+but not the same numbers as the single number functions.
+*/
+class Random
+{
+public:
+	// Constructs with a seed from std::random_device, different for each generator.
+	Random();
+
+	// Constructs with the seed. The same seed always gives the same numbers.
+	Random(uint64_t seed);
+
+	// Resets the generator with the seed.
+	void setSeed(uint64_t seed);
+
+	// Returns 32 random bits.
+	uint32_t nextBits();
+
+	// Returns an int between min (inclusive) and max (exclusive).
+	int nextInt(int min, int max);
+
+	// Returns a float between 0 (inclusive) and 1 (exclusive), with a resolution of 2^-24.
+	float nextFloat();
+
+	// Returns a float between min (inclusive) and max (exclusive).
+	float nextFloat(float min, float max);
+
+	// Returns a double between 0 (inclusive) and 1 (exclusive), with a resolution of 2^-53.
+	double nextDouble();
+
+	// Returns a double between min (inclusive) and max (exclusive).
+	double nextDouble(double min, double max);
+
+	// Returns a point within the interval. For integer types, both min and max are included, as with Interval::contains.
+	template <int dim, typename T> Coord<dim, T> nextIn(Interval<dim, T> const & interval);
+
+	// Returns a uniformly distributed unit vector in two dimensions.
+	Coord2f nextUnitVector2();
+
+	// Returns a uniformly distributed unit vector in three dimensions.
+	Coord3f nextUnitVector3();
+
+	// Fills values with count sets of 32 random bits.
+	void fill(uint32_t * values, unsigned int count);
+
+	// Fills values with count ints between min (inclusive) and max (exclusive).
+	void fill(int * values, unsigned int count, int min, int max);
+
+	// Fills values with count floats between min (inclusive) and max (exclusive).
+	void fill(float * values, unsigned int count, float min, float max);
+
+	// Fills values with count uniformly distributed unit vectors.
+	void fillUnitVectors(Coord3f * values, unsigned int count);
+
+	// Returns the generator of the calling thread, seeded differently for each thread.
+	static Random & local();
+
+private:
+	// Advances the four streams and stores their next four sets of bits in values.
+	void nextBlock(uint32_t * values);
+
+	// The state of the single number functions.
+	uint32_t state[4];
+
+	// The states of the four streams of the fill functions. streams[i][j] is word i of stream j, so that each word loads as one SIMD register.
+	uint32_t streams[4][4];
+};
+
+// Template Implementations
+
+inline int _randomIn(Random & random, int min, int max)
+{
+	return random.nextInt(min, max + 1);
+}
+
+inline float _randomIn(Random & random, float min, float max)
+{
+	return random.nextFloat(min, max);
+}
+
+inline double _randomIn(Random & random, double min, double max)
+{
+	return random.nextDouble(min, max);
+}
+
+template <int dim, typename T>
+Coord<dim, T> Random::nextIn(Interval<dim, T> const & interval)
+{
+	Coord<dim, T> r;
+	for(int i = 0; i < dim; i++)
+	{
+		r[i] = _randomIn(*this, interval.min[i], interval.max[i]);
+	}
+	return r;
+}
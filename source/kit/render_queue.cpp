@@ -0,0 +1,118 @@
+#include "render_queue.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace
+{
+	// The keys use the low 47 bits, so the sort only needs six digits. An opaque key is pass, state, depth, and a transparent key is pass, inverted depth, state.
+	const unsigned int passShift = 46;
+	const unsigned int numStateBits = 30;
+	const unsigned int numDepthBits = 16;
+	const unsigned int numDigits = 6;
+	const unsigned int numDigitValues = 256;
+
+	// Below this many draws, the fixed cost of the histograms makes a comparison sort faster.
+	const unsigned int minRadixSortSize = 768;
+}
+
+uint64_t RenderQueue::makeKey(Pass pass, unsigned int state, float depth)
+{
+	// The bits of a non-negative float are in the same order as its value. The top 16 bits are kept, which is a precision of 1/128 of the depth.
+	// Negative depths and NaNs become zero.
+	uint32_t depthBits = 0;
+	if(depth > 0)
+	{
+		std::memcpy(&depthBits, &depth, sizeof(depthBits));
+		depthBits >>= 32 - numDepthBits;
+	}
+	uint64_t key = (uint64_t)pass << passShift;
+	if(pass == Opaque)
+	{
+		key |= (uint64_t)state << numDepthBits | depthBits;
+	}
+	else
+	{
+		key |= (uint64_t)(depthBits ^ 0xffff) << numStateBits | state;
+	}
+	return key;
+}
+
+void RenderQueue::clear()
+{
+	draws.clear();
+}
+
+void RenderQueue::add(uint64_t key, unsigned int item)
+{
+	draws.push_back(Draw{key, item});
+}
+
+void RenderQueue::sort()
+{
+	unsigned int count = (unsigned int)draws.size();
+	if(count < minRadixSortSize)
+	{
+		std::stable_sort(draws.begin(), draws.end(), [](Draw const & draw0, Draw const & draw1)
+		{
+			return draw0.key < draw1.key;
+		});
+		return;
+	}
+
+	// Count the values of every digit in one pass.
+	unsigned int counts[numDigits * numDigitValues] = {};
+	for(Draw const & draw : draws)
+	{
+		uint64_t key = draw.key;
+		for(unsigned int digit = 0; digit < numDigits; digit++)
+		{
+			counts[digit * numDigitValues + ((key >> (digit * 8)) & 0xff)]++;
+		}
+	}
+
+	// Do a stable counting sort on each digit from the least significant, skipping digits that are the same in every key, such as the unused state bits.
+	sortedDraws.resize(count);
+	Draw * source = &draws[0];
+	Draw * destination = &sortedDraws[0];
+	for(unsigned int digit = 0; digit < numDigits; digit++)
+	{
+		unsigned int * digitCounts = &counts[digit * numDigitValues];
+		unsigned int shift = digit * 8;
+		if(digitCounts[(source[0].key >> shift) & 0xff] == count)
+		{
+			continue;
+		}
+		unsigned int offset = 0;
+		for(unsigned int value = 0; value < numDigitValues; value++)
+		{
+			unsigned int valueCount = digitCounts[value];
+			digitCounts[value] = offset;
+			offset += valueCount;
+		}
+		for(unsigned int i = 0; i < count; i++)
+		{
+			destination[digitCounts[(source[i].key >> shift) & 0xff]++] = source[i];
+		}
+		std::swap(source, destination);
+	}
+	if(source != &draws[0])
+	{
+		draws.swap(sortedDraws);
+	}
+}
+
+unsigned int RenderQueue::size() const
+{
+	return (unsigned int)draws.size();
+}
+
+unsigned int RenderQueue::getItem(unsigned int index) const
+{
+	return draws[index].item;
+}
+
+RenderQueue::Pass RenderQueue::getPass(unsigned int index) const
+{
+	return (Pass)(draws[index].key >> passShift);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/*
+The draws of one frame, each with a 64-bit key that packs its pass, render state, and depth, so that sorting the keys gives the draw order.
+Opaque draws come first, grouped by state to reduce shader, texture, and vertex buffer switches, and front to back within a state so that
+the depth test rejects more fragments. Transparent draws come after, back to front so that they blend correctly, and then by state.
+The keys are sorted with a radix sort, so ordering the queue is O(n) every frame, with no tree or resort to keep up when objects or models change.
+*/
+class RenderQueue
+{
+public:
+	// The passes, in the order that they are drawn.
+	enum Pass
+	{
+		Opaque,
+		Transparent
+	};
+
+	// Returns the key for a draw. The state is a rank of the draw's shader, textures, and vertex buffer, so that equal states are drawn together,
+	// and it must be less than 2^30. The depth is the distance from the camera along its view axis, kept to 1/128 of itself. Negative depths are treated as zero.
+	static uint64_t makeKey(Pass pass, unsigned int state, float depth);
+
+	// Removes all of the draws, keeping the memory for the next frame.
+	void clear();
+
+	// Adds a draw of the item, which is an index into whatever the caller is drawing.
+	void add(uint64_t key, unsigned int item);
+
+	// Sorts the draws by their keys, keeping the order of equal keys. O(n), though small queues use a comparison sort, which is faster for them.
+	void sort();
+
+	// Returns the number of draws.
+	unsigned int size() const;
+
+	// Returns the item of the draw at the index, which after a sort is in the draw order.
+	unsigned int getItem(unsigned int index) const;
+
+	// Returns the pass of the draw at the index.
+	Pass getPass(unsigned int index) const;
+
+private:
+	class Draw
+	{
+	public:
+		uint64_t key;
+		unsigned int item;
+	};
+
+	std::vector<Draw> draws;
+	std::vector<Draw> sortedDraws; // Scratch space for the sort, kept between frames so that it isn't reallocated.
+};
@@ -1,7 +1,44 @@
 #include "resources.h"
+#include "texture.h"
+#include "font.h"
+#include "scene_model.h"
 
 OwnPtr<ObjectCache<Texture>> textureCache;
 OwnPtr<ObjectCache<Shader>> shaderCache;
 OwnPtr<ObjectCache<Font>> fontCache;
 OwnPtr<ObjectCache<SceneModel>> sceneModelCache;
+OwnPtr<WorkerPool> workerPool;
 
+ObjectCache<Texture>::Key loadTextureAsync(std::string const & filename)
+{
+	return textureCache->loadAsync<Texture::Pixels>(filename, [filename]()
+	{
+		return Texture::loadPixels(filename);
+	}, [](Texture::Pixels & pixels)
+	{
+		return OwnPtr<Texture>::createNew(&pixels.data[0], pixels.size);
+	});
+}
+
+
+ObjectCache<Font>::Key loadFontAsync(std::string const & filename, int size)
+{
+	return fontCache->loadAsync<Font::Raster>(filename + std::to_string(size), [filename, size]()
+	{
+		return Font::Raster(filename, size);
+	}, [](Font::Raster & raster)
+	{
+		return OwnPtr<Font>::createNew(std::move(raster));
+	});
+}
+
+ObjectCache<SceneModel>::Key loadSceneModelAsync(std::string const & filename)
+{
+	return sceneModelCache->loadAsync<SceneModel::File>(filename, [filename]()
+	{
+		return SceneModel::loadFile(filename, true);
+	}, [](SceneModel::File & file)
+	{
+		return OwnPtr<SceneModel>::createNew(std::move(file));
+	});
+}
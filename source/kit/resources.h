@@ -1,6 +1,8 @@
 #pragma once
 
 #include "object_cache.h"
+#include "worker_pool.h"
+#include <string>
 
 class Texture;
 class Shader;
@@ -11,4 +13,14 @@ extern OwnPtr<ObjectCache<Texture>> textureCache;
 extern OwnPtr<ObjectCache<Shader>> shaderCache;
 extern OwnPtr<ObjectCache<Font>> fontCache;
 extern OwnPtr<ObjectCache<SceneModel>> sceneModelCache;
+extern OwnPtr<WorkerPool> workerPool;
+
+// Starts loading a texture file in the background. It is in the textureCache under the filename once textureCache->finishLoads adds it. If it fails, getLoadError gives the error.
+ObjectCache<Texture>::Key loadTextureAsync(std::string const & filename);
+
+// Starts loading a font file at the size in the background. It is in the fontCache under the filename and size once fontCache->finishLoads adds it. If it fails, getLoadError gives the error.
+ObjectCache<Font>::Key loadFontAsync(std::string const & filename, int size);
+
+// Starts loading a model file and its textures in the background. It is in the sceneModelCache under the filename once sceneModelCache->finishLoads adds it. If it fails, getLoadError gives the error.
+ObjectCache<SceneModel>::Key loadSceneModelAsync(std::string const & filename);
 
@@ -1,8 +1,13 @@
 #include "scene.h"
+#include "transform_batch.h"
+#include "cull_batch.h"
 #include "open_gl.h"
 #include <vector>
+#include <limits>
+#include <algorithm>
+#include <cassert>
 
-Scene::Scene()
+Scene::Scene() : objectTree(0.1f)
 {
 }
 
@@ -11,7 +16,7 @@ Ptr<SceneLight> Scene::addLight()
 	return *lights.insert(OwnPtr<SceneLight>::createNew());
 }
 
-void Scene::removeLight(Ptr<SceneLight> light)
+void Scene::removeLight(Ptr<SceneLight> const & light)
 {
 	lights.erase(light);
 }
@@ -21,21 +26,83 @@ Ptr<SceneCamera> Scene::addCamera()
 	return *cameras.insert(OwnPtr<SceneCamera>::createNew());
 }
 
-void Scene::removeCamera(Ptr<SceneCamera> camera)
+void Scene::removeCamera(Ptr<SceneCamera> const & camera)
 {
 	cameras.erase(camera);
 }
 
 Ptr<SceneObject> Scene::addObject()
 {
-	return *objects.insert(OwnPtr<SceneObject>::createNew());
+	Ptr<SceneObject> object = *objects.insert(OwnPtr<SceneObject>::createNew());
+	object->treeId = objectTree.insert(object->getWorldBounds(), object);
+	object->worldBoundsChanged = false;
+	return object;
 }
 
-void Scene::removeObject(Ptr<SceneObject> object)
+void Scene::removeObject(Ptr<SceneObject> const & object)
 {
+	objectTree.remove(object->treeId);
 	objects.erase(object);
 }
 
+Ptr<SceneObject> Scene::castRay(Ray3f const & ray, float & distance)
+{
+	updateObjectTree();
+	Ptr<SceneObject> nearestObject;
+	distance = std::numeric_limits<float>::infinity();
+	objectTree.castRay(ray, distance, [&](Ptr<SceneObject> const & object, float objectDistance)
+	{
+		// If the model has a triangle hierarchy, hit its triangles instead of its box.
+		// The ray is moved into the model's coordinates without normalizing, so the distances stay in units of the ray's direction.
+		Ptr<SceneModel> model = object->getModel();
+		if(model.isValid() && model->getTriangleBvh().isValid())
+		{
+			Affine3f worldToLocalTransform = object->getWorldToLocalTransform();
+			float modelScaleInv = 1.0f / model->getScale();
+			Ray3f localRay(worldToLocalTransform.transformPoint(ray.start) * modelScaleInv, worldToLocalTransform.transformVector(ray.direction) * modelScaleInv);
+			objectDistance = model->getTriangleBvh()->castRay(localRay).distance;
+			if(objectDistance >= distance)
+			{
+				return distance;
+			}
+		}
+		nearestObject = object;
+		distance = objectDistance;
+		return objectDistance;
+	});
+	return nearestObject;
+}
+
+void Scene::getObjectsInBox(Boxf const & box, std::vector<Ptr<SceneObject>> & result)
+{
+	updateObjectTree();
+	result.clear();
+	objectTree.queryBox(box, [&](Ptr<SceneObject> const & object)
+	{
+		result.push_back(object);
+	});
+}
+
+void Scene::getObjectsInSphere(Coord3f center, float radius, std::vector<Ptr<SceneObject>> & result)
+{
+	updateObjectTree();
+	result.clear();
+	objectTree.querySphere(center, radius, [&](Ptr<SceneObject> const & object)
+	{
+		result.push_back(object);
+	});
+}
+
+void Scene::getObjectsInFrustum(Ptr<SceneCamera> const & camera, std::vector<Ptr<SceneObject>> & result)
+{
+	updateObjectTree();
+	result.clear();
+	objectTree.queryPlanes(camera->getFrustumPlanes(), 6, [&](Ptr<SceneObject> const & object)
+	{
+		result.push_back(object);
+	});
+}
+
 void Scene::setEventHandler(std::function<void(Event const &)> eventHandler)
 {
 	this->eventHandler = eventHandler;
@@ -75,40 +142,25 @@ void Scene::preRenderUpdate()
 	}
 }
 
-void Scene::render(Ptr<SceneCamera> camera)
+void Scene::render(Ptr<SceneCamera> const & camera)
 {
 	// Set the OpenGL settings.
 	glEnable(GL_DEPTH_TEST);
 
-	// Check for sorting. Pull out the ones that need to be resorted, and put them back in the proper place.
-	std::vector<OwnPtr<SceneObject>> objectsToInsert;
-	for(auto it = objects.begin(); it != objects.end();)
-	{
-		OwnPtr<SceneObject> object = *it;
-		if(object->getModel()->needsResorting())
-		{
-			objectsToInsert.push_back(object);
-			it = objects.erase(object);
-		}
-		else
-		{
-			it++;
-		}
-	}
-	for(OwnPtr<SceneObject> object : objectsToInsert)
-	{
-		objects.insert(object);
-		object->getModel()->resortingDone();
-	}
+	updateModelRanks();
 
 	// Prepare the lights.
 	std::vector<Coord3f> lightPositions;
 	std::vector<Coord3f> lightColors;
-	for(Ptr<SceneLight> light : lights)
+	for(OwnPtr<SceneLight> const & light : lights)
 	{
-		lightPositions.push_back(camera->getWorldToCameraTransform().transform(light->getPosition(), 1));
+		lightPositions.push_back(light->getPosition());
 		lightColors.push_back(light->getColor());
 	}
+	if(!lightPositions.empty())
+	{
+		Batch::transformPoints(camera->getWorldToCameraTransform().toMatrix(), &lightPositions[0], &lightPositions[0], (unsigned int)lightPositions.size());
+	}
 	if(!lights.empty())
 	{
 		while(lightPositions.size() < SceneModel::maxLights)
@@ -118,26 +170,162 @@ void Scene::render(Ptr<SceneCamera> camera)
 		}
 	}
 
-	// Do the render.
-	for(Ptr<SceneObject> object : objects)
+	// Compute the local-to-world transforms of all of the objects in one pass.
+	unsigned int numObjects = (unsigned int)objects.size();
+	objectPositions.resize(numObjects);
+	objectOrientations.resize(numObjects);
+	objectScales.resize(numObjects);
+	objectTransforms.resize(numObjects);
+	objectPointers.resize(numObjects);
+	unsigned int i = 0;
+	for(OwnPtr<SceneObject> const & object : objects)
 	{
-		object->getModel()->render(camera->getCameraToNdcTransform(), camera->getWorldToCameraTransform() * object->getLocalToWorldTransform(), lightPositions, lightColors);
+		objectPositions[i] = object->getPosition();
+		objectOrientations[i] = object->getOrientation();
+		objectScales[i] = object->getScale();
+		objectPointers[i] = object.raw();
+		i++;
+	}
+	if(numObjects > 0)
+	{
+		Batch::composeTransforms(&objectPositions[0], &objectOrientations[0], &objectScales[0], &objectTransforms[0], numObjects);
+	}
+
+	// Cull the objects whose bounding spheres are outside of the view frustum. The model scale is applied before the object's transform.
+	objectBoundingSphereCenters.resize(numObjects);
+	objectBoundingSphereRadii.resize(numObjects);
+	visibleObjectIndices.resize(numObjects);
+	for(i = 0; i < numObjects; i++)
+	{
+		Ptr<SceneModel> model = objectPointers[i]->getModel();
+		objectBoundingSphereCenters[i] = objectTransforms[i].transformPoint(model->getScale() * model->getBoundingSphereCenter());
+		objectBoundingSphereRadii[i] = std::abs(objectScales[i] * model->getScale()) * model->getBoundingSphereRadius();
+	}
+	unsigned int numVisibleObjects = 0;
+	if(numObjects > 0)
+	{
+		numVisibleObjects = Batch::cullSpheres(camera->getFrustumPlanes(), 6, &objectBoundingSphereCenters[0], &objectBoundingSphereRadii[0], &visibleObjectIndices[0], numObjects);
+	}
+
+	// Queue the visible objects by pass, model, and the depth of their bounding sphere centers.
+	Affine3f const & worldToCameraTransform = camera->getWorldToCameraTransform();
+	renderQueue.clear();
+	for(unsigned int visibleIndex = 0; visibleIndex < numVisibleObjects; visibleIndex++)
+	{
+		i = visibleObjectIndices[visibleIndex];
+		SceneModel const * model = objectPointers[i]->getModel().raw();
+		float depth = worldToCameraTransform.transformPoint(objectBoundingSphereCenters[i])[2];
+		renderQueue.add(RenderQueue::makeKey(model->isTransparent() ? RenderQueue::Transparent : RenderQueue::Opaque, objectModelRanks[i], depth), i);
+	}
+	renderQueue.sort();
+
+	// Gather the local-to-camera transforms in the queue order, so that each run of objects with the same model has its transforms together.
+	unsigned int numDraws = renderQueue.size();
+	instanceTransforms.resize(numDraws);
+	for(unsigned int queueIndex = 0; queueIndex < numDraws; queueIndex++)
+	{
+		instanceTransforms[queueIndex] = (worldToCameraTransform * objectTransforms[renderQueue.getItem(queueIndex)]).toMatrix();
+	}
+	if(!instanceBuffer.isValid())
+	{
+		instanceBuffer.setNew();
+	}
+	if(numDraws > 0)
+	{
+		instanceBuffer->setInstances(&instanceTransforms[0], numDraws * sizeof(Matrix44f));
+	}
+
+	// Do the render, with each run of objects that share a model as instances of one draw. Opaque objects of the same model are always one run,
+	// since each model has its own rank in the scene, which comes before the depth in their keys. Transparent objects are tested against the depth buffer but don't write to it,
+	// so that those behind them still blend.
+	Matrix44f const & cameraToNdcTransform = camera->getCameraToNdcTransform();
+	bool depthMaskDisabled = false;
+	unsigned int runBegin = 0;
+	while(runBegin < numDraws)
+	{
+		SceneModel const * model = objectPointers[renderQueue.getItem(runBegin)]->getModel().raw();
+		unsigned int runEnd = runBegin + 1;
+		while(runEnd < numDraws && objectPointers[renderQueue.getItem(runEnd)]->getModel().raw() == model)
+		{
+			runEnd++;
+		}
+		if(!depthMaskDisabled && renderQueue.getPass(runBegin) == RenderQueue::Transparent)
+		{
+			glDepthMask(GL_FALSE);
+			depthMaskDisabled = true;
+		}
+		model->render(cameraToNdcTransform, *instanceBuffer, &instanceTransforms[0], runBegin, runEnd - runBegin, lightPositions, lightColors);
+		runBegin = runEnd;
+	}
+	if(depthMaskDisabled)
+	{
+		glDepthMask(GL_TRUE);
 	}
 
 	glDisable(GL_DEPTH_TEST);
 }
 
-bool Scene::ObjectCompare::operator () (OwnPtr<SceneObject> object0, OwnPtr<SceneObject> object1)
+void Scene::updateObjectTree()
+{
+	for(OwnPtr<SceneObject> const & object : objects)
+	{
+		unsigned int modelBoundsVersion = object->model.isValid() ? object->model->getBoundsVersion() : 0;
+		if(object->worldBoundsChanged || object->modelBoundsVersion != modelBoundsVersion)
+		{
+			objectTree.update(object->treeId, object->getWorldBounds());
+			object->worldBoundsChanged = false;
+			object->modelBoundsVersion = modelBoundsVersion;
+		}
+
+		// Check that no change was missed, such as a model being rescaled, since the queries would then miss the object or find it in the wrong place.
+		assert(objectTree.getBox(object->treeId).min == object->getWorldBounds().min && objectTree.getBox(object->treeId).max == object->getWorldBounds().max);
+	}
+}
+
+void Scene::updateModelRanks()
 {
-	Ptr<SceneModel> model0 = object0->getModel();
-	Ptr<SceneModel> model1 = object1->getModel();
-	if(model0.isValid() && model1.isValid())
+	objectModelRanks.resize(objects.size());
+	bool needsRanking = false;
+	unsigned int i = 0;
+	for(OwnPtr<SceneObject> const & object : objects)
+	{
+		SceneModel const * model = object->getModel().raw();
+		auto it = modelRanks.find(model);
+		if(it == modelRanks.end() || it->second.renderStateVersion != model->getRenderStateVersion())
+		{
+			needsRanking = true;
+			break;
+		}
+		objectModelRanks[i] = it->second.rank;
+		i++;
+	}
+	if(!needsRanking)
 	{
-		return *object0->getModel() < *object1->getModel();
+		return;
 	}
-	else
+
+	// Gather each model once, then sort them by render state. There are usually far fewer models than objects, so this is cheap, and it only happens when a model changes.
+	// The models that are no longer used are dropped from the ranks.
+	rankedModels.clear();
+	for(OwnPtr<SceneObject> const & object : objects)
 	{
-		return object0 < object1;
+		rankedModels.push_back(object->getModel().raw());
+	}
+	std::sort(rankedModels.begin(), rankedModels.end());
+	rankedModels.erase(std::unique(rankedModels.begin(), rankedModels.end()), rankedModels.end());
+	std::sort(rankedModels.begin(), rankedModels.end(), [](SceneModel const * model0, SceneModel const * model1)
+	{
+		return *model0 < *model1;
+	});
+	modelRanks.clear();
+	for(unsigned int rank = 0; rank < rankedModels.size(); rank++)
+	{
+		modelRanks[rankedModels[rank]] = ModelRank{rank, rankedModels[rank]->getRenderStateVersion()};
+	}
+	i = 0;
+	for(OwnPtr<SceneObject> const & object : objects)
+	{
+		objectModelRanks[i] = modelRanks[object->getModel().raw()].rank;
+		i++;
 	}
 }
-
@@ -5,8 +5,12 @@
 #include "scene_camera.h"
 #include "event.h"
 #include "ptr_set.h"
+#include "dynamic_bvh.h"
+#include "render_queue.h"
 #include <functional>
 #include <set>
+#include <unordered_map>
+#include <vector>
 
 class Scene
 {
@@ -15,15 +19,28 @@ public:
 
 	Ptr<SceneLight> addLight();
 
-	void removeLight(Ptr<SceneLight>);
+	void removeLight(Ptr<SceneLight> const & light);
 
 	Ptr<SceneCamera> addCamera();
 
-	void removeCamera(Ptr<SceneCamera> camera);
+	void removeCamera(Ptr<SceneCamera> const & camera);
 
 	Ptr<SceneObject> addObject();
 
-	void removeObject(Ptr<SceneObject> object);
+	void removeObject(Ptr<SceneObject> const & object);
+
+	// Returns the object that the ray hits first, or a null Ptr if there is none. Sets distance to the hit, in units of its direction.
+	// Objects whose models have triangle hierarchies are hit at their triangles, and others at their world bounds.
+	Ptr<SceneObject> castRay(Ray3f const & ray, float & distance);
+
+	// Sets result to the objects whose world bounds overlap the box.
+	void getObjectsInBox(Boxf const & box, std::vector<Ptr<SceneObject>> & result);
+
+	// Sets result to the objects whose world bounds overlap the sphere.
+	void getObjectsInSphere(Coord3f center, float radius, std::vector<Ptr<SceneObject>> & result);
+
+	// Sets result to the objects whose world bounds may be in view of the camera. As with the culling in cull_batch.h, some near the corners of the view may be included.
+	void getObjectsInFrustum(Ptr<SceneCamera> const & camera, std::vector<Ptr<SceneObject>> & result);
 
 	void setEventHandler(std::function<void(Event const &)> eventHandler);
 
@@ -41,20 +58,44 @@ public:
 	void preRenderUpdate();
 
 	// Called by GuiViewport to render the scene.
-	void render(Ptr<SceneCamera> camera);
+	void render(Ptr<SceneCamera> const & camera);
 
 private:
-	class ObjectCompare
-	{
-	public:
-		bool operator () (OwnPtr<SceneObject> object0, OwnPtr<SceneObject> object1);
-	};
+	// Updates the leaves in the object tree of the objects that have changed since the last update, or whose models' bounds or scales have.
+	void updateObjectTree();
+
+	// Sets objectModelRanks to the rank of each object's model, in the order of objects. If any model is new to the scene or its shader or textures
+	// have changed, the models are sorted by render state again first. The ranks are kept in the scene, since a model may be in more than one.
+	void updateModelRanks();
 
 	PtrSet<SceneLight> lights;
 	PtrSet<SceneCamera> cameras;
-	PtrSet<SceneObject, ObjectCompare> objects;
+	PtrSet<SceneObject> objects;
+	DynamicBvh<Ptr<SceneObject>> objectTree; // The world bounds of every object, for the queries above. Kept after objects so that it is destroyed first.
 	std::function<void(Event const &)> eventHandler;
 	std::function<void(float)> updateHandler;
 	std::function<void()> preRenderUpdateHandler;
+
+	// Scratch space for render, kept between frames so that it isn't reallocated.
+	std::vector<Coord3f> objectPositions;
+	std::vector<Quaternionf> objectOrientations;
+	std::vector<float> objectScales;
+	std::vector<Affine3f> objectTransforms;
+	std::vector<SceneObject const *> objectPointers;
+	std::vector<Coord3f> objectBoundingSphereCenters;
+	std::vector<float> objectBoundingSphereRadii;
+	std::vector<unsigned int> visibleObjectIndices;
+	class ModelRank
+	{
+	public:
+		unsigned int rank; // The place of the model in the order of the scene's models, used for the render queue keys.
+		unsigned int renderStateVersion; // The model's render state version when it was ranked.
+	};
+	std::unordered_map<SceneModel const *, ModelRank> modelRanks;
+	std::vector<SceneModel const *> rankedModels;
+	std::vector<unsigned int> objectModelRanks;
+	RenderQueue renderQueue;
+	std::vector<Matrix44f> instanceTransforms;
+	OwnPtr<InstanceBufferObject> instanceBuffer; // Created on the first render, when there is an OpenGL context.
 };
 
@@ -1,4 +1,5 @@
 #include "scene_camera.h"
+#include "transform_batch.h"
 
 SceneCamera::SceneCamera()
 {
@@ -9,39 +10,44 @@ SceneCamera::SceneCamera()
 	size = 1.0f;
 	perspective = true;
 	cameraToNdcTransform = ndcToCameraTransform = Matrix44f::identity();
-	worldToCameraTransform = cameraToWorldTransform = Matrix44f::identity();
 	cameraToNdcTransformNeedsUpdate = true;
 	worldToCameraTransformNeedsUpdate = true;
+	frustumPlanesNeedUpdate = true;
 }
 
 void SceneCamera::setPosition(Coord3f position)
 {
 	SceneEntity::setPosition(position);
 	worldToCameraTransformNeedsUpdate = true;
+	frustumPlanesNeedUpdate = true;
 }
 
 void SceneCamera::setOrientation(Quaternionf orientation)
 {
 	SceneEntity::setOrientation(orientation);
 	worldToCameraTransformNeedsUpdate = true;
+	frustumPlanesNeedUpdate = true;
 }
 
 void SceneCamera::setAspectRatio(float newAspectRatio)
 {
 	aspectRatio = newAspectRatio;
 	cameraToNdcTransformNeedsUpdate = true;
+	frustumPlanesNeedUpdate = true;
 }
 
 void SceneCamera::setNear(float newNear)
 {
 	near = newNear;
 	cameraToNdcTransformNeedsUpdate = true;
+	frustumPlanesNeedUpdate = true;
 }
 
 void SceneCamera::setFar(float newFar)
 {
 	far = newFar;
 	cameraToNdcTransformNeedsUpdate = true;
+	frustumPlanesNeedUpdate = true;
 }
 
 void SceneCamera::setPerspective(float newFov)
@@ -49,6 +55,7 @@ void SceneCamera::setPerspective(float newFov)
 	fov = newFov;
 	perspective = true;
 	cameraToNdcTransformNeedsUpdate = true;
+	frustumPlanesNeedUpdate = true;
 }
 
 void SceneCamera::setOrthogonal(float newSize)
@@ -56,6 +63,7 @@ void SceneCamera::setOrthogonal(float newSize)
 	size = newSize;
 	perspective = false;
 	cameraToNdcTransformNeedsUpdate = true;
+	frustumPlanesNeedUpdate = true;
 }
 
 Coord2f SceneCamera::getNdcPosition(Coord3f positionInWorld) const
@@ -68,7 +76,14 @@ Coord2f SceneCamera::getNdcPosition(Coord3f positionInWorld) const
 	{
 		const_cast<SceneCamera *>(this)->updateCameraToNdc();
 	}
-	return (cameraToNdcTransform * worldToCameraTransform).transform(positionInWorld, 1).shrink<2>();
+	Coord3f ndcPosition;
+	Batch::projectPoints(cameraToNdcTransform * worldToCameraTransform.toMatrix(), &positionInWorld, &ndcPosition, 1);
+	return ndcPosition.shrink<2>();
+}
+
+void SceneCamera::getNdcPositions(Coord3f const * worldPositions, Coord3f * ndcPositions, unsigned int count) const
+{
+	Batch::projectPoints(getCameraToNdcTransform() * getWorldToCameraTransform().toMatrix(), worldPositions, ndcPositions, count);
 }
 
 Ray3f SceneCamera::getRay(Coord2f ndcPosition) const
@@ -81,14 +96,17 @@ Ray3f SceneCamera::getRay(Coord2f ndcPosition) const
 	{
 		const_cast<SceneCamera *>(this)->updateCameraToNdc();
 	}
+	// The ray goes from the near plane, at an ndc depth of 1, to the far plane, at an ndc depth of -1.
+	Coord3f ndcPositions[2] = {ndcPosition.extend<3>(1), ndcPosition.extend<3>(-1)};
+	Coord3f worldPositions[2];
+	Batch::projectPoints(cameraToWorldTransform.toMatrix() * ndcToCameraTransform, ndcPositions, worldPositions, 2);
 	Ray3f ray;
-	ray.start = getPosition();
-	Coord3f endPosition = (cameraToWorldTransform * ndcToCameraTransform).transform(ndcPosition.extend<3>(-1), 1);
-	ray.direction = endPosition - ray.start;
+	ray.start = worldPositions[0];
+	ray.direction = worldPositions[1] - worldPositions[0];
 	return ray;
 }
 
-Matrix44f const & SceneCamera::getWorldToCameraTransform() const
+Affine3f const & SceneCamera::getWorldToCameraTransform() const
 {
 	if(worldToCameraTransformNeedsUpdate)
 	{
@@ -106,34 +124,28 @@ Matrix44f const & SceneCamera::getCameraToNdcTransform() const
 	return cameraToNdcTransform;
 }
 
+Coord4f const * SceneCamera::getFrustumPlanes() const
+{
+	if(frustumPlanesNeedUpdate)
+	{
+		const_cast<SceneCamera *>(this)->updateFrustumPlanes();
+	}
+	return frustumPlanes;
+}
+
 void SceneCamera::updateWorldToCamera()
 {
-	Coord3f position = getPosition();
+	// Camera space has the y and z axes of the camera's orientation swapped.
 	Matrix33f rot = getOrientation().getMatrix();
-	worldToCameraTransform(0, 0) = rot(0, 0);
-	worldToCameraTransform(1, 0) = rot(0, 2);
-	worldToCameraTransform(2, 0) = rot(0, 1);
-	worldToCameraTransform(0, 1) = rot(1, 0);
-	worldToCameraTransform(1, 1) = rot(1, 2);
-	worldToCameraTransform(2, 1) = rot(1, 1);
-	worldToCameraTransform(0, 2) = rot(2, 0);
-	worldToCameraTransform(1, 2) = rot(2, 2);
-	worldToCameraTransform(2, 2) = rot(2, 1);
-	worldToCameraTransform(0, 3) = (-position[0] * rot(0, 0) - position[1] * rot(1, 0) - position[2] * rot(2, 0));
-	worldToCameraTransform(1, 3) = (-position[0] * rot(0, 2) - position[1] * rot(1, 2) - position[2] * rot(2, 2));
-	worldToCameraTransform(2, 3) = (-position[0] * rot(0, 1) - position[1] * rot(1, 1) - position[2] * rot(2, 1));
-	cameraToWorldTransform(0, 0) = rot(0, 0);
-	cameraToWorldTransform(1, 0) = rot(1, 0);
-	cameraToWorldTransform(2, 0) = rot(2, 0);
-	cameraToWorldTransform(0, 1) = rot(0, 2);
-	cameraToWorldTransform(1, 1) = rot(1, 2);
-	cameraToWorldTransform(2, 1) = rot(2, 2);
-	cameraToWorldTransform(0, 2) = rot(0, 1);
-	cameraToWorldTransform(1, 2) = rot(1, 1);
-	cameraToWorldTransform(2, 2) = rot(2, 1);
-	cameraToWorldTransform(0, 3) = position[0];
-	cameraToWorldTransform(1, 3) = position[1];
-	cameraToWorldTransform(2, 3) = position[2];
+	Matrix33f cameraToWorldRot;
+	for(unsigned int i = 0; i < 3; i++)
+	{
+		cameraToWorldRot(i, 0) = rot(i, 0);
+		cameraToWorldRot(i, 1) = rot(i, 2);
+		cameraToWorldRot(i, 2) = rot(i, 1);
+	}
+	cameraToWorldTransform = Affine3f(cameraToWorldRot, getPosition());
+	worldToCameraTransform = cameraToWorldTransform.rigidInverse();
 	worldToCameraTransformNeedsUpdate = false;
 }
 
@@ -157,15 +169,11 @@ void SceneCamera::updateCameraToNdc()
 	{
 		cameraToNdcTransform(0, 0) = scaleInv;
 		cameraToNdcTransform(1, 1) = scaleInv * aspectRatio;
-		ndcToCameraTransform(0, 0) = scale;
-		ndcToCameraTransform(1, 1) = scale / aspectRatio;
 	}
 	else
 	{
 		cameraToNdcTransform(0, 0) = scaleInv / aspectRatio;
 		cameraToNdcTransform(1, 1) = scaleInv;
-		ndcToCameraTransform(0, 0) = scale * aspectRatio;
-		ndcToCameraTransform(1, 1) = scale;
 	}
 	if(perspective)
 	{
@@ -176,10 +184,6 @@ void SceneCamera::updateCameraToNdc()
 		cameraToNdcTransform(2, 3) = -nf2 / nmf;
 		cameraToNdcTransform(3, 2) = 1;
 		cameraToNdcTransform(3, 3) = 0;
-		ndcToCameraTransform(2, 2) = 0;
-		ndcToCameraTransform(2, 3) = -1;
-		ndcToCameraTransform(3, 2) = nmf / nf2;
-		ndcToCameraTransform(3, 3) = -npf / nf2;
 	}
 	else
 	{
@@ -189,11 +193,28 @@ void SceneCamera::updateCameraToNdc()
 		cameraToNdcTransform(2, 3) = -npf / nmf;
 		cameraToNdcTransform(3, 2) = 0;
 		cameraToNdcTransform(3, 3) = 1;
-		ndcToCameraTransform(2, 2) = nmf / 2;
-		ndcToCameraTransform(2, 3) = npf / 2;
-		ndcToCameraTransform(3, 2) = 0;
-		ndcToCameraTransform(3, 3) = 1;
 	}
+	ndcToCameraTransform = cameraToNdcTransform.inverse();
 	cameraToNdcTransformNeedsUpdate = false;
 }
 
+
+void SceneCamera::updateFrustumPlanes()
+{
+	// A point is inside of the frustum when -w <= x, y, z <= w in clip coordinates, so each plane is the last row of the world to clip transform
+	// plus or minus one of the others (Gribb and Hartmann). The planes are then scaled so that their normals are unit length.
+	Matrix44f worldToNdcTransform = getCameraToNdcTransform() * getWorldToCameraTransform().toMatrix();
+	for(unsigned int i = 0; i < 3; i++)
+	{
+		for(unsigned int j = 0; j < 4; j++)
+		{
+			frustumPlanes[2 * i][j] = worldToNdcTransform(3, j) + worldToNdcTransform(i, j);
+			frustumPlanes[2 * i + 1][j] = worldToNdcTransform(3, j) - worldToNdcTransform(i, j);
+		}
+	}
+	for(unsigned int i = 0; i < 6; i++)
+	{
+		frustumPlanes[i] = frustumPlanes[i] / frustumPlanes[i].shrink<3>().norm();
+	}
+	frustumPlanesNeedUpdate = false;
+}
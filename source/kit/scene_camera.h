@@ -24,15 +24,23 @@ public:
 
 	Coord2f getNdcPosition(Coord3f worldPosition) const;
 
+	// Sets ndcPositions[i] to the normalized device coordinates (with depth) of worldPositions[i]. Much faster than calling getNdcPosition for each.
+	void getNdcPositions(Coord3f const * worldPositions, Coord3f * ndcPositions, unsigned int count) const;
+
 	Ray3f getRay(Coord2f ndcPosition) const;
 
-	Matrix44f const & getWorldToCameraTransform() const;
+	Affine3f const & getWorldToCameraTransform() const;
 
 	Matrix44f const & getCameraToNdcTransform() const;
 
+	// Returns the six planes of the view frustum in world coordinates, as (normal, d) with a unit normal, so that a point p is inside of the frustum
+	// when normal . p + d >= 0 for every plane. They are in the order left, right, bottom, top, far, and near, and are cached until the camera changes.
+	Coord4f const * getFrustumPlanes() const;
+
 private:
 	void updateWorldToCamera();
 	void updateCameraToNdc();
+	void updateFrustumPlanes();
 
 	float aspectRatio;
 	float near;
@@ -42,9 +50,11 @@ private:
 	bool perspective;
 	bool cameraToNdcTransformNeedsUpdate;
 	bool worldToCameraTransformNeedsUpdate;
+	bool frustumPlanesNeedUpdate;
 	Matrix44f cameraToNdcTransform;
 	Matrix44f ndcToCameraTransform;
-	Matrix44f worldToCameraTransform;
-	Matrix44f cameraToWorldTransform;
+	Affine3f worldToCameraTransform;
+	Affine3f cameraToWorldTransform;
+	Coord4f frustumPlanes[6];
 };
 
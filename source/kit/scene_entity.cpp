@@ -2,8 +2,7 @@
 
 SceneEntity::SceneEntity()
 {
-	worldToLocalTransform = localToWorldTransform = Matrix44f::identity();
-	transformsNeedUpdate = false;
+	scale = 1.0f;
 }
 
 Coord3f const & SceneEntity::getPosition() const
@@ -14,7 +13,6 @@ Coord3f const & SceneEntity::getPosition() const
 void SceneEntity::setPosition(Coord3f position_)
 {
 	position = position_;
-	transformsNeedUpdate = true;
 }
 
 Quaternionf const & SceneEntity::getOrientation() const
@@ -25,54 +23,29 @@ Quaternionf const & SceneEntity::getOrientation() const
 void SceneEntity::setOrientation(Quaternionf orientation_)
 {
 	orientation = orientation_;
-	transformsNeedUpdate = true;
 }
 
-Matrix44f const & SceneEntity::getLocalToWorldTransform() const
+float SceneEntity::getScale() const
 {
-	if(transformsNeedUpdate)
-	{
-		const_cast<SceneEntity *>(this)->updateTransforms();
-	}
-	return localToWorldTransform;
+	return scale;
 }
 
-Matrix44f  const & SceneEntity::getWorldToLocalTransform() const
+void SceneEntity::setScale(float scale_)
 {
-	if(transformsNeedUpdate)
-	{
-		const_cast<SceneEntity *>(this)->updateTransforms();
-	}
-	return worldToLocalTransform;
+	scale = scale_;
 }
 
-void SceneEntity::updateTransforms()
+Affine3f SceneEntity::getLocalToWorldTransform() const
 {
-	Matrix33f rot = orientation.getMatrix();
-	localToWorldTransform(0, 0) = rot(0, 0);
-	localToWorldTransform(1, 0) = rot(1, 0);
-	localToWorldTransform(2, 0) = rot(2, 0);
-	localToWorldTransform(0, 1) = rot(0, 1);
-	localToWorldTransform(1, 1) = rot(1, 1);
-	localToWorldTransform(2, 1) = rot(2, 1);
-	localToWorldTransform(0, 2) = rot(0, 2);
-	localToWorldTransform(1, 2) = rot(1, 2);
-	localToWorldTransform(2, 2) = rot(2, 2);
-	localToWorldTransform(0, 3) = position[0];
-	localToWorldTransform(1, 3) = position[1];
-	localToWorldTransform(2, 3) = position[2];
-	worldToLocalTransform(0, 0) = rot(0, 0);
-	worldToLocalTransform(1, 0) = rot(0, 1);
-	worldToLocalTransform(2, 0) = rot(0, 2);
-	worldToLocalTransform(0, 1) = rot(1, 0);
-	worldToLocalTransform(1, 1) = rot(1, 1);
-	worldToLocalTransform(2, 1) = rot(1, 2);
-	worldToLocalTransform(0, 2) = rot(2, 0);
-	worldToLocalTransform(1, 2) = rot(2, 1);
-	worldToLocalTransform(2, 2) = rot(2, 2);
-	worldToLocalTransform(0, 3) = (-position[0] * rot(0, 0) - position[1] * rot(1, 0) - position[2] * rot(2, 0));
-	worldToLocalTransform(1, 3) = (-position[0] * rot(0, 1) - position[1] * rot(1, 1) - position[2] * rot(2, 1));
-	worldToLocalTransform(2, 3) = (-position[0] * rot(0, 2) - position[1] * rot(1, 2) - position[2] * rot(2, 2));
-	transformsNeedUpdate = false;
+	return Affine3f(scale * orientation.getMatrix(), position);
 }
 
+Affine3f SceneEntity::getWorldToLocalTransform() const
+{
+	if(scale == 0)
+	{
+		throw std::exception();
+	}
+	Matrix33f linear = (1 / scale) * orientation.getMatrix().transpose();
+	return Affine3f(linear, -(linear * position));
+}
@@ -1,9 +1,11 @@
 #pragma once
 
 #include "coord.h"
-#include "matrix.h"
+#include "affine.h"
 #include "quaternion.h"
 
+// Something placed in a scene. Only the position, orientation, and uniform scale are stored, so that entities stay small.
+// The transforms are computed from them when asked for. To get the transforms of many entities at once, use Batch::composeTransforms.
 class SceneEntity
 {
 public:
@@ -17,17 +19,18 @@ public:
 
 	virtual void setOrientation(Quaternionf orientation);
 
-	Matrix44f const & getLocalToWorldTransform() const;
+	float getScale() const;
 
-	Matrix44f const & getWorldToLocalTransform() const;
+	virtual void setScale(float scale);
 
-private:
-	void updateTransforms();
+	// Returns the transform from local to world coordinates. O(1), but computed on every call.
+	Affine3f getLocalToWorldTransform() const;
+
+	// Returns the transform from world to local coordinates. O(1), but computed on every call.
+	Affine3f getWorldToLocalTransform() const;
 
+private:
 	Coord3f position;
 	Quaternionf orientation;
-	bool transformsNeedUpdate;
-	Matrix44f localToWorldTransform;
-	Matrix44f worldToLocalTransform;
+	float scale;
 };
-
@@ -5,12 +5,75 @@
 #include <fstream>
 #include <algorithm>
 
+namespace
+{
+	unsigned int nextRenderStateVersion = 0; // Shared by all models, so that no two get the same render state version.
+	unsigned int nextBoundsVersion = 0; // Likewise for the bounds version.
+
+	const uint64_t emptyHash = 14695981039346656037ull; // The FNV-1a hash of nothing.
+
+	// Returns the FNV-1a hash of the words, continuing from hash. It goes a word at a time instead of a byte at a time, since positions and indices are all words.
+	uint64_t hashWords(void const * words, unsigned int numWords, uint64_t hash)
+	{
+		uint32_t const * w = (uint32_t const *)words;
+		for(unsigned int i = 0; i < numWords; i++)
+		{
+			hash = (hash ^ w[i]) * 1099511628211ull;
+		}
+		return hash;
+	}
+
+	// Returns the hash of the positions, which are the first element of each vertex.
+	uint64_t hashPositions(unsigned char const * vertices, unsigned int numVertices, unsigned int numBytesPerVertex)
+	{
+		uint64_t hash = emptyHash;
+		for(unsigned int i = 0; i < numVertices; i++)
+		{
+			hash = hashWords(vertices + i * numBytesPerVertex, 3, hash);
+		}
+		return hash;
+	}
+
+	// Returns the hash that a triangle hierarchy is saved with.
+	uint64_t hashGeometry(uint64_t positionsHash, uint64_t indicesHash)
+	{
+		return hashWords(&indicesHash, 2, positionsHash);
+	}
+
+	// Reads a triangle hierarchy saved by saveTriangleBvh. Returns null if it isn't valid or was saved for a different geometry hash.
+	OwnPtr<TriangleBvh> loadTriangleBvhFile(std::istream & in, uint64_t geometryHash)
+	{
+		OwnPtr<TriangleBvh> triangleBvh;
+		try
+		{
+			uint64_t savedGeometryHash;
+			deserialize(in, savedGeometryHash);
+			if(savedGeometryHash == geometryHash)
+			{
+				triangleBvh.setNew();
+				deserialize(in, *triangleBvh);
+			}
+		}
+		catch(std::exception const &)
+		{
+			triangleBvh.setNull();
+		}
+		return triangleBvh;
+	}
+}
+
 SceneModel::SceneModel()
 {
 	vertexHasNormal = false;
 	vertexHasTangent = false;
 	vertexHasColor = false;
 	numVertexUVs = 0;
+	numBytesPerVertex = sizeof(Coord3f);
+	boundingSphereRadius = 0;
+	numIndicesPerPrimitive = 3;
+	keepsGeometry = false;
+	positionsHash = emptyHash;
+	indicesHash = emptyHash;
 	emitColor = {0, 0, 0};
 	diffuseColor = {1, 1, 1, 1};
 	specularLevel = 1;
@@ -19,59 +82,109 @@ SceneModel::SceneModel()
 	vertexBufferObject.setNew();
 	vertexBufferObject->setBytesPerVertex(sizeof(Coord3f));
 	shaderDirty = true;
-	sorted = false;
+	instanced = false;
+	renderStateVersion = nextRenderStateVersion++;
+	boundsVersion = nextBoundsVersion++;
+}
+
+SceneModel::SceneModel(std::string const & filename, bool buildTriangleBvh) : SceneModel(loadFile(filename, false, buildTriangleBvh))
+{
 }
 
-SceneModel::SceneModel(std::string const & filename)
+SceneModel::SceneModel(File && file) : SceneModel()
 {
+	setColor(file.emitColor, file.diffuseColor);
+	setSpecular(file.specularLevel, file.specularStrength);
+	for(File::TextureFile & textureFile : file.textures)
+	{
+		if(textureFile.pixels.data.empty() || textureCache->has(textureFile.filename))
+		{
+			addTextureFromFile(textureFile.filename, textureFile.type, textureFile.uvIndex);
+		}
+		else
+		{
+			addTexture(textureCache->add(textureFile.filename, OwnPtr<Texture>::createNew(&textureFile.pixels.data[0], textureFile.pixels.size)), textureFile.type, textureFile.uvIndex);
+		}
+	}
+	setVertexFormat(file.vertexHasNormal, file.vertexHasTangent, file.vertexHasColor, file.numVertexUVs);
+	setVertices(file.vertices.empty() ? nullptr : (void const *)&file.vertices[0], (unsigned int)file.vertices.size());
+	setNumIndicesPerPrimitive(file.numIndicesPerPrimitive);
+	setIndices(file.indices.empty() ? nullptr : &file.indices[0], (unsigned int)file.indices.size());
+	triangleBvh = std::move(file.triangleBvh);
+}
+
+SceneModel::File SceneModel::loadFile(std::string const & filename, bool decodeTextures, bool buildTriangleBvh)
+{
+	File file;
 	std::fstream in(filename, std::fstream::in | std::fstream::binary);
 
 	// Material
-	deserialize(in, emitColor);
-	deserialize(in, diffuseColor);
-	deserialize(in, specularLevel);
-	deserialize(in, specularStrength);
+	deserialize(in, file.emitColor);
+	deserialize(in, file.diffuseColor);
+	deserialize(in, file.specularLevel);
+	deserialize(in, file.specularStrength);
 
 	// Textures
 	unsigned int numTextures;
 	deserialize(in, numTextures);
-	for(unsigned int i = 0; i < numTextures; i++)
+	file.textures.resize(numTextures);
+	for(File::TextureFile & textureFile : file.textures)
 	{
-		std::string filename;
-		deserialize(in, filename);
-		std::string type;
-		deserialize(in, type);
-		unsigned int uvIndex;
-		deserialize(in, uvIndex);
-		addTextureFromFile(filename, type, uvIndex);
+		deserialize(in, textureFile.filename);
+		deserialize(in, textureFile.type);
+		deserialize(in, textureFile.uvIndex);
+		if(decodeTextures)
+		{
+			textureFile.pixels = Texture::loadPixels(textureFile.filename);
+		}
 	}
 
 	// Vertex format
-	bool vertexHasNormal, vertexHasTangent, vertexHasColor;
-	unsigned int numVertexUVs;
-	deserialize(in, vertexHasNormal);
-	deserialize(in, vertexHasTangent);
-	deserialize(in, vertexHasColor);
-	deserialize(in, numVertexUVs);
-	setVertexFormat(vertexHasNormal, vertexHasTangent, vertexHasColor, numVertexUVs);
+	deserialize(in, file.vertexHasNormal);
+	deserialize(in, file.vertexHasTangent);
+	deserialize(in, file.vertexHasColor);
+	deserialize(in, file.numVertexUVs);
+	unsigned int numBytesPerVertex = sizeof(Coord3f);
+	numBytesPerVertex += file.vertexHasNormal ? sizeof(Coord3f) : 0;
+	numBytesPerVertex += file.vertexHasTangent ? sizeof(Coord3f) : 0;
+	numBytesPerVertex += file.vertexHasColor ? sizeof(Coord4f) : 0;
+	numBytesPerVertex += file.numVertexUVs * sizeof(Coord2f);
 
 	// Vertices
 	unsigned int numVertices;
 	deserialize(in, numVertices);
-	std::vector<unsigned char> vertices;
-	vertices.resize(numVertices * numBytesPerVertex);
-	deserialize(in, (void *)&vertices[0], numVertices * numBytesPerVertex);
-	setVertices((void const *)&vertices[0], numVertices * numBytesPerVertex);
+	file.vertices.resize(numVertices * numBytesPerVertex);
+	if(!file.vertices.empty())
+	{
+		deserialize(in, (void *)&file.vertices[0], numVertices * numBytesPerVertex);
+	}
 
 	// Index format
-	unsigned int numIndicesPerPrimitive;
-	deserialize(in, numIndicesPerPrimitive);
-	setNumIndicesPerPrimitive(numIndicesPerPrimitive);
+	deserialize(in, file.numIndicesPerPrimitive);
 
 	// Indices
-	std::vector<unsigned int> indices;
-	deserialize(in, indices, deserialize);
-	setIndices(&indices[0], indices.size());
+	deserialize(in, file.indices, deserialize);
+
+	// Triangle hierarchy, if one was saved for these positions and indices. Otherwise it is for an older version of the model, and can be built again.
+	std::fstream bvhIn(filename + ".bvh", std::fstream::in | std::fstream::binary);
+	if(bvhIn.is_open() && file.numIndicesPerPrimitive == 3)
+	{
+		uint64_t positionsHash = hashPositions(file.vertices.empty() ? nullptr : &file.vertices[0], numVertices, numBytesPerVertex);
+		uint64_t indicesHash = hashWords(file.indices.empty() ? nullptr : &file.indices[0], (unsigned int)file.indices.size(), emptyHash);
+		file.triangleBvh = loadTriangleBvhFile(bvhIn, hashGeometry(positionsHash, indicesHash));
+	}
+
+	// Otherwise build it from the file data if asked, which is freed along with the file instead of being kept by the model.
+	if(!file.triangleBvh.isValid() && buildTriangleBvh && file.numIndicesPerPrimitive == 3)
+	{
+		std::vector<Coord3f> positions(numVertices);
+		for(unsigned int i = 0; i < numVertices; i++)
+		{
+			positions[i] = *(Coord3f const *)(&file.vertices[i * numBytesPerVertex]);
+		}
+		file.triangleBvh.setNew(positions.empty() ? nullptr : &positions[0], file.indices.empty() ? nullptr : &file.indices[0], (unsigned int)file.indices.size());
+	}
+	return file;
 }
 
 void SceneModel::setVertexFormat(bool hasNormal, bool hasTangent, bool hasColor, unsigned int _numVertexUVs)
@@ -96,22 +209,120 @@ void SceneModel::setVertexFormat(bool hasNormal, bool hasTangent, bool hasColor,
 	numBytesPerVertex += _numVertexUVs * sizeof(Coord2f);
 	vertexBufferObject->setBytesPerVertex(numBytesPerVertex);
 	shaderDirty = true;
-	sorted = false;
+	renderStateVersion = nextRenderStateVersion++;
+}
+
+void SceneModel::setKeepsGeometry(bool keepsGeometry_)
+{
+	keepsGeometry = keepsGeometry_;
+	if(!keepsGeometry)
+	{
+		std::vector<Coord3f>().swap(positions);
+		std::vector<unsigned int>().swap(indices);
+	}
 }
 
 void SceneModel::setVertices(void const * vertices, unsigned int numBytes)
 {
 	vertexBufferObject->setVertices(vertices, numBytes, false);
+
+	// The position is the first element of each vertex. The sphere is centered on the box, which is almost as tight as the smallest sphere for most models.
+	unsigned char const * bytes = (unsigned char const *)vertices;
+	unsigned int numVertices = numBytes / numBytesPerVertex;
+	auto position = [&](unsigned int i)
+	{
+		return *(Coord3f const *)(bytes + i * numBytesPerVertex);
+	};
+	if(keepsGeometry)
+	{
+		positions.resize(numVertices);
+		for(unsigned int i = 0; i < numVertices; i++)
+		{
+			positions[i] = position(i);
+		}
+	}
+	positionsHash = hashPositions(bytes, numVertices, numBytesPerVertex);
+	triangleBvh.setNull();
+	boundsVersion = nextBoundsVersion++;
+	if(numVertices == 0)
+	{
+		bounds = Boxf();
+		boundingSphereRadius = 0;
+		return;
+	}
+	bounds = Boxf(position(0), position(0));
+	for(unsigned int i = 1; i < numVertices; i++)
+	{
+		bounds = bounds.extendedTo(position(i));
+	}
+	Coord3f center = getBoundingSphereCenter();
+	float radiusSq = 0;
+	for(unsigned int i = 0; i < numVertices; i++)
+	{
+		radiusSq = std::max(radiusSq, (position(i) - center).normSq());
+	}
+	boundingSphereRadius = std::sqrt(radiusSq);
 }
 
 void SceneModel::setNumIndicesPerPrimitive(unsigned int num)
 {
 	vertexBufferObject->setNumIndicesPerPrimitive(num);
+	numIndicesPerPrimitive = num;
+	triangleBvh.setNull();
+}
+
+void SceneModel::setIndices(unsigned int const * indices_, unsigned int numIndices)
+{
+	vertexBufferObject->setIndices(indices_, numIndices);
+	if(keepsGeometry)
+	{
+		indices.assign(indices_, indices_ + numIndices);
+	}
+	indicesHash = hashWords(indices_, numIndices, emptyHash);
+	triangleBvh.setNull();
 }
 
-void SceneModel::setIndices(unsigned int const * indices, unsigned int numIndices)
+void SceneModel::buildTriangleBvh()
 {
-	vertexBufferObject->setIndices(indices, numIndices);
+	if(numIndicesPerPrimitive != 3 || !keepsGeometry)
+	{
+		throw std::exception();
+	}
+
+	// The copies are only there if keepsGeometry was set before the vertices and indices, so check them against the hashes.
+	if(hashPositions(positions.empty() ? nullptr : (unsigned char const *)&positions[0], (unsigned int)positions.size(), sizeof(Coord3f)) != positionsHash
+		|| hashWords(indices.empty() ? nullptr : &indices[0], (unsigned int)indices.size(), emptyHash) != indicesHash)
+	{
+		throw std::exception();
+	}
+	triangleBvh.setNew(positions.empty() ? nullptr : &positions[0], indices.empty() ? nullptr : &indices[0], (unsigned int)indices.size());
+}
+
+void SceneModel::loadTriangleBvh(std::string const & filename)
+{
+	std::fstream in(filename, std::fstream::in | std::fstream::binary);
+	OwnPtr<TriangleBvh> loadedTriangleBvh = loadTriangleBvhFile(in, hashGeometry(positionsHash, indicesHash));
+	if(numIndicesPerPrimitive != 3 || !loadedTriangleBvh.isValid())
+	{
+		throw std::exception();
+	}
+	triangleBvh = std::move(loadedTriangleBvh);
+}
+
+void SceneModel::saveTriangleBvh(std::string const & filename) const
+{
+	if(!triangleBvh.isValid())
+	{
+		throw std::exception();
+	}
+	std::fstream out(filename, std::fstream::out | std::fstream::binary);
+	serialize(out, hashGeometry(positionsHash, indicesHash));
+	serialize(out, *triangleBvh);
+}
+
+Ptr<TriangleBvh> SceneModel::getTriangleBvh() const
+{
+	return triangleBvh;
 }
 
 void SceneModel::addTexture(Ptr<Texture> texture, std::string const & type, unsigned int uvIndex)
@@ -123,7 +334,7 @@ void SceneModel::addTexture(Ptr<Texture> texture, std::string const & type, unsi
 	textureInfo.uvIndex = uvIndex;
 	textureInfos.push_back(textureInfo);
 	shaderDirty = true;
-	sorted = false;
+	renderStateVersion = nextRenderStateVersion++;
 }
 
 void SceneModel::addTextureFromFile(std::string const & filename, std::string const & type, unsigned int uvIndex)
@@ -136,7 +347,7 @@ void SceneModel::clearTextures()
 {
 	textureInfos.clear();
 	shaderDirty = true;
-	sorted = false;
+	renderStateVersion = nextRenderStateVersion++;
 }
 
 void SceneModel::setColor(Coord3f const & _emitColor, Coord4f const & _diffuseColor)
@@ -151,6 +362,21 @@ void SceneModel::setSpecular(unsigned int level, float strength)
 	specularStrength = strength;
 }
 
+Boxf const & SceneModel::getBounds() const
+{
+	return bounds;
+}
+
+Coord3f SceneModel::getBoundingSphereCenter() const
+{
+	return (bounds.min + bounds.max) / 2.0f;
+}
+
+float SceneModel::getBoundingSphereRadius() const
+{
+	return boundingSphereRadius;
+}
+
 float SceneModel::getScale() const
 {
 	return scale;
@@ -159,9 +385,16 @@ float SceneModel::getScale() const
 void SceneModel::setScale(float _scale)
 {
 	scale = _scale;
+	boundsVersion = nextBoundsVersion++;
 }
 
-void SceneModel::render(Matrix44f const & projectionTransform, Matrix44f const & localToCameraTransform, std::vector<Coord3f> const & lightPositions, std::vector<Coord3f> const & lightColors) const
+unsigned int SceneModel::getBoundsVersion() const
+{
+	return boundsVersion;
+}
+
+void SceneModel::render(Matrix44f const & projectionTransform, InstanceBufferObject const & instances, Matrix44f const * localToCameraTransforms, unsigned int firstInstance, unsigned int numInstances,
+	std::vector<Coord3f> const & lightPositions, std::vector<Coord3f> const & lightColors) const
 {
 	// The render engine handles shader and texture activation.
 	if(shaderDirty)
@@ -170,7 +403,6 @@ void SceneModel::render(Matrix44f const & projectionTransform, Matrix44f const &
 	}
 	shader->activate();
 	shader->setUniform(projectionLocation, projectionTransform);
-	shader->setUniform(worldViewLocation, localToCameraTransform);
 	shader->setUniform(scaleLocation, scale);
 	unsigned int samplerIndex = 0;
 	for(unsigned int i = 0; i < textureInfos.size(); i++)
@@ -189,17 +421,28 @@ void SceneModel::render(Matrix44f const & projectionTransform, Matrix44f const &
 	shader->setUniform(diffuseColorLocation, diffuseColor);
 	shader->setUniform(specularLevelLocation, (int)specularLevel);
 	shader->setUniform(specularStrengthLocation, specularStrength);
-	vertexBufferObject->render();
+	if(instanced)
+	{
+		vertexBufferObject->render(instances, firstInstance, numInstances);
+	}
+	else
+	{
+		for(unsigned int i = firstInstance; i < firstInstance + numInstances; i++)
+		{
+			shader->setUniform(worldViewLocation, localToCameraTransforms[i]);
+			vertexBufferObject->render();
+		}
+	}
 }
 
-bool SceneModel::needsResorting() const
+bool SceneModel::isTransparent() const
 {
-	return !sorted;
+	return diffuseColor[3] < 1;
 }
 
-void SceneModel::resortingDone()
+unsigned int SceneModel::getRenderStateVersion() const
 {
-	sorted = true;
+	return renderStateVersion;
 }
 
 bool SceneModel::operator < (SceneModel const & model) const
@@ -248,6 +491,10 @@ void SceneModel::updateShader()
 		varyingIn = "in";
 		varyingOut = "out";
 	}
+
+	// With instancing, the transform is a mat4 attribute that advances once per instance, so that objects with this model can be drawn together.
+	instanced = glslVersion >= 3.3f;
+	std::string worldView = instanced ? "aWorldView" : "uWorldView";
 	std::string code[Shader::NumCodeTypes];
 
 	std::vector<std::string> uvIndexStrings;
@@ -260,7 +507,14 @@ void SceneModel::updateShader()
 	code[Shader::Vertex] += "#version " + version + "\n";
 
 	// Add the global variables.
-	code[Shader::Vertex] += "uniform mat4 uWorldView;\n";
+	if(instanced)
+	{
+		code[Shader::Vertex] += attribute + " mat4 aWorldView;\n";
+	}
+	else
+	{
+		code[Shader::Vertex] += "uniform mat4 uWorldView;\n";
+	}
 	code[Shader::Vertex] += "uniform mat4 uProjection;\n";
 	code[Shader::Vertex] += "uniform float uScale;\n";
 	code[Shader::Vertex] += attribute + " vec3 aPosition;\n";
@@ -289,15 +543,15 @@ void SceneModel::updateShader()
 	// Add the main function.
 	code[Shader::Vertex] += "void main()\n";
 	code[Shader::Vertex] += "{\n";
-	code[Shader::Vertex] += "	gl_Position = uProjection * uWorldView * vec4(uScale * aPosition, 1);\n";
-	code[Shader::Vertex] += "	vPosition = (uWorldView * vec4(aPosition, 1)).xyz;\n";
+	code[Shader::Vertex] += "	gl_Position = uProjection * " + worldView + " * vec4(uScale * aPosition, 1);\n";
+	code[Shader::Vertex] += "	vPosition = (" + worldView + " * vec4(aPosition, 1)).xyz;\n";
 	if(vertexHasNormal)
 	{
-		code[Shader::Vertex] += "	vNormal = (uWorldView * vec4(aNormal, 0)).xyz;\n";
+		code[Shader::Vertex] += "	vNormal = (" + worldView + " * vec4(aNormal, 0)).xyz;\n";
 	}
 	if(vertexHasTangent)
 	{
-		code[Shader::Vertex] += "	vTangent = (uWorldView * vec4(aTangent, 0)).xyz;\n";
+		code[Shader::Vertex] += "	vTangent = (" + worldView + " * vec4(aTangent, 0)).xyz;\n";
 	}
 	if(vertexHasColor)
 	{
@@ -409,13 +663,17 @@ void SceneModel::updateShader()
 		name += "c";
 	}
 	name += std::to_string(numVertexUVs);
+	if(instanced)
+	{
+		name += "i";
+	}
 	for(TextureInfo const & textureInfo : textureInfos)
 	{
 		name += textureInfo.type[0] + std::to_string(textureInfo.uvIndex);
 	}
 
 	shader = shaderCache->load(name, code);
-	sorted = false;
+	renderStateVersion = nextRenderStateVersion++;
 
 	// Update attribute locations
 	vertexBufferObject->clearVertexComponents();
@@ -441,6 +699,16 @@ void SceneModel::updateShader()
 	{
 		vertexBufferObject->addVertexComponent(shader->getAttributeLocation("aUV" + std::to_string(textureInfo.uvIndex)), offset + textureInfo.uvIndex * sizeof(Coord2f), 2);
 	}
+	if(instanced)
+	{
+		// A mat4 attribute takes four consecutive locations, one for each column.
+		int worldViewAttributeLocation = shader->getAttributeLocation("aWorldView");
+		for(unsigned int column = 0; column < 4; column++)
+		{
+			vertexBufferObject->addInstanceComponent(worldViewAttributeLocation + column, column * sizeof(Coord4f), 4);
+		}
+		vertexBufferObject->setBytesPerInstance(sizeof(Matrix44f));
+	}
 
 	// Update uniform locations
 	lightPositionsLocation = shader->getUniformLocation("uLightPositions");
@@ -494,6 +762,10 @@ string - filename
 string - type
 int - uv index
 
+The triangle hierarchy is saved as a separate file, the model's filename + ".bvh":
+unsigned long long - FNV-1a hash of the positions, continued over the FNV-1a hash of the indices, a 32-bit word at a time
+triangle hierarchy - as serialized in triangle_bvh.cpp
+
 vertex format:
 float[3] - position
 float[3] - normal (if it has one)
@@ -3,27 +3,87 @@
 #include "ptr.h"
 #include "coord.h"
 #include "matrix.h"
+#include "box.h"
+#include "triangle_bvh.h"
 #include "shader.h"
 #include "vertex_buffer_object.h"
+#include "instance_buffer_object.h"
 #include "texture.h"
 #include <string>
 #include <vector>
+#include <cstdint>
 
 class SceneModel
 {
 public:
+	// The contents of a model file. Reading it doesn't use GL, so it can be done on a worker thread, with the model created later from it.
+	class File
+	{
+	public:
+		class TextureFile
+		{
+		public:
+			std::string filename;
+			std::string type;
+			unsigned int uvIndex;
+			Texture::Pixels pixels; // Decoded only if asked for, and empty otherwise.
+		};
+
+		Coord3f emitColor;
+		Coord4f diffuseColor;
+		unsigned int specularLevel;
+		float specularStrength;
+		std::vector<TextureFile> textures;
+		bool vertexHasNormal;
+		bool vertexHasTangent;
+		bool vertexHasColor;
+		unsigned int numVertexUVs;
+		std::vector<unsigned char> vertices;
+		unsigned int numIndicesPerPrimitive;
+		std::vector<unsigned int> indices;
+		OwnPtr<TriangleBvh> triangleBvh; // Null if there was no valid one saved for the model's positions and indices, and none was asked to be built.
+	};
+
 	SceneModel();
 
-	SceneModel(std::string const & filename);
+	// Loads the model from the file. If there is a triangle hierarchy saved as filename + ".bvh" for the same positions and indices, it is loaded too,
+	// and otherwise one is built if buildTriangleBvh is true.
+	SceneModel(std::string const & filename, bool buildTriangleBvh = false);
+
+	// Creates the model from a file read by loadFile, taking its data. Textures that aren't in the textureCache are added from their pixels, or loaded if they have none.
+	SceneModel(File && file);
+
+	// Reads a model file and its saved triangle hierarchy, if it has one, along with the pixels of its textures if decodeTextures is true.
+	// If buildTriangleBvh is true and there is no valid saved hierarchy, one is built from the file, so that the model doesn't need to keep its geometry.
+	static File loadFile(std::string const & filename, bool decodeTextures, bool buildTriangleBvh = false);
 
 	void setVertexFormat(bool hasNormal, bool hasTangent, bool hasColor, unsigned int numVertexUVs);
 
+	// Sets whether the model keeps CPU copies of the positions and indices given to setVertices and setIndices, for buildTriangleBvh.
+	// It is off by default, since most models never build a hierarchy, and must be turned on before the vertices and indices are set. Turning it off frees the copies.
+	void setKeepsGeometry(bool keepsGeometry);
+
+	// Sets the vertices, given in the current vertex format. Also computes the bounds from their positions.
 	void setVertices(void const * vertices, unsigned int numBytes);
 
 	void setNumIndicesPerPrimitive(unsigned int num);
 
+	// Sets the indices of the primitives.
 	void setIndices(unsigned int const * indices, unsigned int numIndices);
 
+	// Builds the triangle hierarchy from the positions and indices, on all hardware threads.
+	// Throws an exception if the primitives aren't triangles or the model doesn't keep its geometry.
+	void buildTriangleBvh();
+
+	// Loads the triangle hierarchy from a file written by saveTriangleBvh. Throws an exception if it isn't valid or was saved for different positions or indices.
+	void loadTriangleBvh(std::string const & filename);
+
+	// Saves the triangle hierarchy to a file, with a hash of the positions and indices, so that it can be loaded instead of built again. Throws an exception if there is none.
+	void saveTriangleBvh(std::string const & filename) const;
+
+	// Returns the triangle hierarchy for casting rays against the model, without the scale. It is null until built or loaded, and again when the vertices or indices change.
+	Ptr<TriangleBvh> getTriangleBvh() const;
+
 	void addTexture(Ptr<Texture> texture, std::string const & type, unsigned int uvIndex);
 
 	void addTextureFromFile(std::string const & filename, std::string const & type, unsigned int uvIndex);
@@ -34,16 +94,37 @@ public:
 
 	void setSpecular(unsigned int level, float strength);
 
+	// Returns the axis-aligned box around the vertex positions, before the scale is applied.
+	Boxf const & getBounds() const;
+
+	// Returns the center of a sphere around the vertex positions, before the scale is applied. It is the center of the bounds.
+	Coord3f getBoundingSphereCenter() const;
+
+	// Returns the radius of the sphere around the vertex positions, before the scale is applied.
+	float getBoundingSphereRadius() const;
+
 	float getScale() const;
 
 	void setScale(float scale);
 
-	void render(Matrix44f const & projectionTransform, Matrix44f const & localToCameraTransform, std::vector<Coord3f> const & lightPositions, std::vector<Coord3f> const & lightColors) const;
+	// Returns a number that changes whenever the bounds or the scale change, so that a scene knows to update the world bounds of the objects with the model.
+	// As with the render state version, no two models share a number.
+	unsigned int getBoundsVersion() const;
+
+	// Renders the instances from firstInstance to firstInstance + numInstances - 1. Their local-to-camera transforms are in localToCameraTransforms,
+	// and must also be in instances in the same order. With OpenGL 3.3 it is a single instanced draw that reads them from instances,
+	// and otherwise it is a draw for each instance, with its transform set as a uniform.
+	void render(Matrix44f const & projectionTransform, InstanceBufferObject const & instances, Matrix44f const * localToCameraTransforms, unsigned int firstInstance, unsigned int numInstances,
+		std::vector<Coord3f> const & lightPositions, std::vector<Coord3f> const & lightColors) const;
 
-	bool needsResorting() const;
+	// Returns true if the diffuse color is partly transparent, so that the model is drawn after the opaque ones, back to front.
+	bool isTransparent() const;
 
-	void resortingDone();
+	// Returns a number that changes whenever the shader or textures change, so that a scene knows to sort its models by operator < again.
+	// No two models share a number, so a new model at the address of a destroyed one is noticed too.
+	unsigned int getRenderStateVersion() const;
 
+	// Orders models by shader, then textures, then vertex buffer, so that neighbors in the order share as much render state as possible.
 	bool operator < (SceneModel const & model) const;
 
 	static const unsigned int maxLights = 4;
@@ -81,11 +162,22 @@ private:
 	unsigned int numVertexUVs;
 	unsigned int numBytesPerVertex;
 	OwnPtr<VertexBufferObject> vertexBufferObject;
+	Boxf bounds;
+	float boundingSphereRadius;
+	unsigned int numIndicesPerPrimitive;
+	bool keepsGeometry;
+	std::vector<Coord3f> positions; // Empty unless keepsGeometry is true.
+	std::vector<unsigned int> indices; // Empty unless keepsGeometry is true.
+	uint64_t positionsHash; // For checking that a saved triangle hierarchy is for these positions and indices.
+	uint64_t indicesHash;
+	OwnPtr<TriangleBvh> triangleBvh;
 
 	Ptr<Shader> shader;
 	bool shaderDirty;
+	bool instanced; // If true, the shader reads the local-to-camera transform as an instance attribute instead of a uniform.
 
-	bool sorted;
+	unsigned int renderStateVersion;
+	unsigned int boundsVersion;
 
 	int projectionLocation;
 	int worldViewLocation;
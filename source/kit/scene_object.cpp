@@ -2,14 +2,29 @@
 #include "scene_model.h"
 #include "resources.h"
 
-float SceneObject::getScale() const
+SceneObject::SceneObject()
 {
-	return model->getScale();
+	treeId = 0;
+	worldBoundsChanged = true;
+	modelBoundsVersion = 0;
+}
+
+void SceneObject::setPosition(Coord3f position)
+{
+	SceneEntity::setPosition(position);
+	worldBoundsChanged = true;
+}
+
+void SceneObject::setOrientation(Quaternionf orientation)
+{
+	SceneEntity::setOrientation(orientation);
+	worldBoundsChanged = true;
 }
 
 void SceneObject::setScale(float scale)
 {
-	model->setScale(scale);
+	SceneEntity::setScale(scale);
+	worldBoundsChanged = true;
 }
 
 Ptr<SceneModel> SceneObject::getModel() const
@@ -20,10 +35,33 @@ Ptr<SceneModel> SceneObject::getModel() const
 void SceneObject::setModel(Ptr<SceneModel> model)
 {
 	this->model = model;
+	worldBoundsChanged = true;
 }
 
 void SceneObject::setModel(std::string const & filename)
 {
 	model = sceneModelCache->load(filename);
+	worldBoundsChanged = true;
 }
 
+Boxf SceneObject::getWorldBounds() const
+{
+	if(!model.isValid())
+	{
+		return Boxf(getPosition(), getPosition());
+	}
+
+	// Transform the center of the box, and make a new box around the transformed extents.
+	Boxf const & bounds = model->getBounds();
+	Coord3f center = (model->getScale() / 2.0f) * (bounds.min + bounds.max);
+	Coord3f extent = (std::abs(model->getScale()) / 2.0f) * (bounds.max - bounds.min);
+	Affine3f localToWorldTransform = getLocalToWorldTransform();
+	Matrix33f const & linear = localToWorldTransform.getLinear();
+	Coord3f worldCenter = localToWorldTransform.transformPoint(center);
+	Coord3f worldExtent;
+	for(unsigned int i = 0; i < 3; i++)
+	{
+		worldExtent[i] = std::abs(linear(i, 0)) * extent[0] + std::abs(linear(i, 1)) * extent[1] + std::abs(linear(i, 2)) * extent[2];
+	}
+	return Boxf(worldCenter - worldExtent, worldCenter + worldExtent);
+}
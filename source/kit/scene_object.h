@@ -2,14 +2,19 @@
 
 #include "scene_entity.h"
 #include "scene_model.h"
+#include "box.h"
 #include <string>
 
 class SceneObject : public SceneEntity
 {
 public:
-	float getScale() const;
+	SceneObject();
 
-	void setScale(float scale);
+	void setPosition(Coord3f position) override;
+
+	void setOrientation(Quaternionf orientation) override;
+
+	void setScale(float scale) override;
 
 	Ptr<SceneModel> getModel() const;
 
@@ -17,7 +22,16 @@ public:
 
 	void setModel(std::string const & filename);
 
+	// Returns the axis-aligned box around the model's bounds in world coordinates. If there is no model, it is just the position.
+	Boxf getWorldBounds() const;
+
 private:
 	Ptr<SceneModel> model;
-};
 
+	// The object's leaf in its scene's object tree, whether the object has changed since the leaf was updated, and the model's bounds version then.
+	unsigned int treeId;
+	bool worldBoundsChanged;
+	unsigned int modelBoundsVersion;
+
+	friend class Scene;
+};
@@ -0,0 +1,414 @@
+#pragma once
+
+/*
+A thin layer over the 4-wide float SIMD instructions of the target, used by the float specializations in coord.h and matrix.h.
+SSE2 is used on x86 and x64 and NEON on ARM. SIMD_ENABLED is 1 when one of them is available and 0 otherwise, in which case
+the generic scalar templates are used. Define SIMD_DISABLED to 1 to force the scalar code, e.g. to compare against it.
+Loads and stores are unaligned, so the types that use them don't need any special alignment.
+*/
+
+#ifndef SIMD_DISABLED
+#define SIMD_DISABLED 0
+#endif
+
+#if !SIMD_DISABLED && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define SIMD_SSE 1
+#include <emmintrin.h>
+#elif !SIMD_DISABLED && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if defined(SIMD_SSE) || defined(SIMD_NEON)
+#define SIMD_ENABLED 1
+#else
+#define SIMD_ENABLED 0
+#endif
+
+#if SIMD_ENABLED
+
+namespace Simd
+{
+#if defined(SIMD_SSE)
+	typedef __m128 Float4;
+#else
+	typedef float32x4_t Float4;
+#endif
+
+	// Returns the four floats at p.
+	Float4 load(float const * p);
+
+	// Returns the three floats at p, with 0 as the fourth.
+	Float4 load3(float const * p);
+
+	// Stores the four floats of a at p.
+	void store(float * p, Float4 a);
+
+	// Stores the first three floats of a at p.
+	void store3(float * p, Float4 a);
+
+	// Returns a with all four floats equal to x.
+	Float4 splat(float x);
+
+	// Returns a + b.
+	Float4 add(Float4 a, Float4 b);
+
+	// Returns a - b.
+	Float4 sub(Float4 a, Float4 b);
+
+	// Returns a b.
+	Float4 mul(Float4 a, Float4 b);
+
+	// Returns a b + c.
+	Float4 mulAdd(Float4 a, Float4 b, Float4 c);
+
+	// Returns a / b.
+	Float4 div(Float4 a, Float4 b);
+
+	// Returns the square root of a.
+	Float4 sqrt(Float4 a);
+
+	// Returns a with its sign flipped wherever s is negative, which is a times the sign of s.
+	Float4 mulSign(Float4 a, Float4 s);
+
+	// Returns the smaller of a and b in each lane.
+	Float4 min(Float4 a, Float4 b);
+
+	// Returns the larger of a and b in each lane.
+	Float4 max(Float4 a, Float4 b);
+
+	// Returns x in the lanes where a <= b and y in the others, including where a or b is NaN.
+	Float4 ifLessEqual(Float4 a, Float4 b, Float4 x, Float4 y);
+
+	// Returns the sum of the four floats of a.
+	float sum(Float4 a);
+
+	// Returns (a1, a2, a0, a3). Used for cross products.
+	Float4 yzxw(Float4 a);
+
+	// Returns the cross product of the xyz of a and b, with a w of 0.
+	Float4 cross(Float4 a, Float4 b);
+
+	// Transposes the 4x4 matrix whose columns (or rows) are a0 to a3.
+	void transpose(Float4 & a0, Float4 & a1, Float4 & a2, Float4 & a3);
+
+	// Loads four interleaved xyz triples from the twelve floats at p, and splits them into the x, y, and z of each.
+	void loadInterleaved3(float const * p, Float4 & x, Float4 & y, Float4 & z);
+
+	// Stores x, y, and z as four interleaved xyz triples into the twelve floats at p.
+	void storeInterleaved3(float * p, Float4 x, Float4 y, Float4 z);
+
+	// Splits the twelve floats of a, b, and c, taken as four interleaved xyz triples, into the x, y, and z of each, as with loadInterleaved3.
+	void deinterleave3(Float4 a, Float4 b, Float4 c, Float4 & x, Float4 & y, Float4 & z);
+
+	// Sets evens to (a0, a2, b0, b2) and odds to (a1, a3, b1, b3).
+	void unzip(Float4 a, Float4 b, Float4 & evens, Float4 & odds);
+
+	// Returns (a[i0], a[i1], b[i2], b[i3]).
+	template <int i0, int i1, int i2, int i3> Float4 shuffle(Float4 a, Float4 b);
+}
+
+// Inline Implementation
+
+#if defined(SIMD_SSE)
+
+inline Simd::Float4 Simd::load(float const * p)
+{
+	return _mm_loadu_ps(p);
+}
+
+inline Simd::Float4 Simd::load3(float const * p)
+{
+	return _mm_set_ps(0.0f, p[2], p[1], p[0]);
+}
+
+inline void Simd::store(float * p, Float4 a)
+{
+	_mm_storeu_ps(p, a);
+}
+
+inline void Simd::store3(float * p, Float4 a)
+{
+	_mm_storel_pi((__m64 *)p, a);
+	_mm_store_ss(p + 2, _mm_movehl_ps(a, a));
+}
+
+inline Simd::Float4 Simd::splat(float x)
+{
+	return _mm_set1_ps(x);
+}
+
+inline Simd::Float4 Simd::add(Float4 a, Float4 b)
+{
+	return _mm_add_ps(a, b);
+}
+
+inline Simd::Float4 Simd::sub(Float4 a, Float4 b)
+{
+	return _mm_sub_ps(a, b);
+}
+
+inline Simd::Float4 Simd::mul(Float4 a, Float4 b)
+{
+	return _mm_mul_ps(a, b);
+}
+
+inline Simd::Float4 Simd::mulAdd(Float4 a, Float4 b, Float4 c)
+{
+	return _mm_add_ps(_mm_mul_ps(a, b), c);
+}
+
+inline Simd::Float4 Simd::div(Float4 a, Float4 b)
+{
+	return _mm_div_ps(a, b);
+}
+
+inline Simd::Float4 Simd::sqrt(Float4 a)
+{
+	return _mm_sqrt_ps(a);
+}
+
+inline Simd::Float4 Simd::mulSign(Float4 a, Float4 s)
+{
+	return _mm_xor_ps(a, _mm_and_ps(s, _mm_set1_ps(-0.0f)));
+}
+
+inline Simd::Float4 Simd::min(Float4 a, Float4 b)
+{
+	return _mm_min_ps(a, b);
+}
+
+inline Simd::Float4 Simd::max(Float4 a, Float4 b)
+{
+	return _mm_max_ps(a, b);
+}
+
+inline Simd::Float4 Simd::ifLessEqual(Float4 a, Float4 b, Float4 x, Float4 y)
+{
+	Float4 mask = _mm_cmple_ps(a, b);
+	return _mm_or_ps(_mm_and_ps(mask, x), _mm_andnot_ps(mask, y));
+}
+
+inline float Simd::sum(Float4 a)
+{
+	Float4 s = _mm_add_ps(a, _mm_movehl_ps(a, a)); // (a0 + a2, a1 + a3, ...)
+	s = _mm_add_ss(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 1, 1, 1)));
+	return _mm_cvtss_f32(s);
+}
+
+inline Simd::Float4 Simd::yzxw(Float4 a)
+{
+	return _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+}
+
+inline void Simd::transpose(Float4 & a0, Float4 & a1, Float4 & a2, Float4 & a3)
+{
+	_MM_TRANSPOSE4_PS(a0, a1, a2, a3);
+}
+
+inline void Simd::loadInterleaved3(float const * p, Float4 & x, Float4 & y, Float4 & z)
+{
+	deinterleave3(_mm_loadu_ps(p + 0), _mm_loadu_ps(p + 4), _mm_loadu_ps(p + 8), x, y, z);
+}
+
+inline void Simd::deinterleave3(Float4 a, Float4 b, Float4 c, Float4 & x, Float4 & y, Float4 & z)
+{
+	// a is (x0, y0, z0, x1), b is (y1, z1, x2, y2), and c is (z2, x3, y3, z3).
+	Float4 xt = _mm_shuffle_ps(b, c, _MM_SHUFFLE(0, 1, 0, 2)); // (x2, y1, x3, z2)
+	x = _mm_shuffle_ps(a, xt, _MM_SHUFFLE(2, 0, 3, 0));
+	y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+	z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+inline void Simd::storeInterleaved3(float * p, Float4 x, Float4 y, Float4 z)
+{
+	Float4 a = _mm_shuffle_ps(_mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 0, 0)), _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+	Float4 b = _mm_shuffle_ps(_mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)), _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0));
+	Float4 c = _mm_shuffle_ps(_mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2)), _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+	_mm_storeu_ps(p + 0, a);
+	_mm_storeu_ps(p + 4, b);
+	_mm_storeu_ps(p + 8, c);
+}
+
+inline void Simd::unzip(Float4 a, Float4 b, Float4 & evens, Float4 & odds)
+{
+	evens = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+	odds = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+template <int i0, int i1, int i2, int i3>
+inline Simd::Float4 Simd::shuffle(Float4 a, Float4 b)
+{
+	return _mm_shuffle_ps(a, b, _MM_SHUFFLE(i3, i2, i1, i0));
+}
+
+#else
+
+inline Simd::Float4 Simd::load(float const * p)
+{
+	return vld1q_f32(p);
+}
+
+inline Simd::Float4 Simd::load3(float const * p)
+{
+	return vcombine_f32(vld1_f32(p), vld1_lane_f32(p + 2, vdup_n_f32(0.0f), 0));
+}
+
+inline void Simd::store(float * p, Float4 a)
+{
+	vst1q_f32(p, a);
+}
+
+inline void Simd::store3(float * p, Float4 a)
+{
+	vst1_f32(p, vget_low_f32(a));
+	vst1q_lane_f32(p + 2, a, 2);
+}
+
+inline Simd::Float4 Simd::splat(float x)
+{
+	return vdupq_n_f32(x);
+}
+
+inline Simd::Float4 Simd::add(Float4 a, Float4 b)
+{
+	return vaddq_f32(a, b);
+}
+
+inline Simd::Float4 Simd::sub(Float4 a, Float4 b)
+{
+	return vsubq_f32(a, b);
+}
+
+inline Simd::Float4 Simd::mul(Float4 a, Float4 b)
+{
+	return vmulq_f32(a, b);
+}
+
+inline Simd::Float4 Simd::mulAdd(Float4 a, Float4 b, Float4 c)
+{
+	return vmlaq_f32(c, a, b);
+}
+
+inline Simd::Float4 Simd::div(Float4 a, Float4 b)
+{
+#if defined(__aarch64__) || defined(_M_ARM64)
+	return vdivq_f32(a, b);
+#else
+	// ARMv7 has no divide, so refine the reciprocal estimate with two Newton-Raphson steps.
+	float32x4_t inv = vrecpeq_f32(b);
+	inv = vmulq_f32(vrecpsq_f32(b, inv), inv);
+	inv = vmulq_f32(vrecpsq_f32(b, inv), inv);
+	return vmulq_f32(a, inv);
+#endif
+}
+
+inline Simd::Float4 Simd::sqrt(Float4 a)
+{
+#if defined(__aarch64__) || defined(_M_ARM64)
+	return vsqrtq_f32(a);
+#else
+	// ARMv7 has no square root, so refine the reciprocal square root estimate with two Newton-Raphson steps and multiply. Zero stays zero.
+	float32x4_t inv = vrsqrteq_f32(a);
+	inv = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a, inv), inv), inv);
+	inv = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a, inv), inv), inv);
+	return vbslq_f32(vceqq_f32(a, vdupq_n_f32(0.0f)), a, vmulq_f32(a, inv));
+#endif
+}
+
+inline Simd::Float4 Simd::mulSign(Float4 a, Float4 s)
+{
+	uint32x4_t sign = vandq_u32(vreinterpretq_u32_f32(s), vdupq_n_u32(0x80000000u));
+	return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(a), sign));
+}
+
+inline Simd::Float4 Simd::min(Float4 a, Float4 b)
+{
+	return vminq_f32(a, b);
+}
+
+inline Simd::Float4 Simd::max(Float4 a, Float4 b)
+{
+	return vmaxq_f32(a, b);
+}
+
+inline Simd::Float4 Simd::ifLessEqual(Float4 a, Float4 b, Float4 x, Float4 y)
+{
+	return vbslq_f32(vcleq_f32(a, b), x, y);
+}
+
+inline float Simd::sum(Float4 a)
+{
+	float32x2_t s = vadd_f32(vget_low_f32(a), vget_high_f32(a));
+	return vget_lane_f32(vpadd_f32(s, s), 0);
+}
+
+inline Simd::Float4 Simd::yzxw(Float4 a)
+{
+	float32x4_t yzwx = vextq_f32(a, a, 1); // (a1, a2, a3, a0)
+	float32x2_t low = vget_low_f32(yzwx); // (a1, a2)
+	float32x2_t xw = vext_f32(vget_high_f32(a), vget_low_f32(a), 1); // (a3, a0)
+	return vcombine_f32(low, vrev64_f32(xw)); // (a1, a2, a0, a3)
+}
+
+inline void Simd::transpose(Float4 & a0, Float4 & a1, Float4 & a2, Float4 & a3)
+{
+	float32x4x2_t t01 = vtrnq_f32(a0, a1); // (a00, a10, a02, a12), (a01, a11, a03, a13)
+	float32x4x2_t t23 = vtrnq_f32(a2, a3); // (a20, a30, a22, a32), (a21, a31, a23, a33)
+	a0 = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+	a1 = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+	a2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+	a3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+}
+
+inline void Simd::loadInterleaved3(float const * p, Float4 & x, Float4 & y, Float4 & z)
+{
+	float32x4x3_t v = vld3q_f32(p);
+	x = v.val[0];
+	y = v.val[1];
+	z = v.val[2];
+}
+
+inline void Simd::storeInterleaved3(float * p, Float4 x, Float4 y, Float4 z)
+{
+	float32x4x3_t v;
+	v.val[0] = x;
+	v.val[1] = y;
+	v.val[2] = z;
+	vst3q_f32(p, v);
+}
+
+inline void Simd::deinterleave3(Float4 a, Float4 b, Float4 c, Float4 & x, Float4 & y, Float4 & z)
+{
+	float p[12];
+	vst1q_f32(p + 0, a);
+	vst1q_f32(p + 4, b);
+	vst1q_f32(p + 8, c);
+	loadInterleaved3(p, x, y, z);
+}
+
+inline void Simd::unzip(Float4 a, Float4 b, Float4 & evens, Float4 & odds)
+{
+	float32x4x2_t v = vuzpq_f32(a, b);
+	evens = v.val[0];
+	odds = v.val[1];
+}
+
+template <int i0, int i1, int i2, int i3>
+inline Simd::Float4 Simd::shuffle(Float4 a, Float4 b)
+{
+	Float4 r = vdupq_n_f32(vgetq_lane_f32(a, i0));
+	r = vsetq_lane_f32(vgetq_lane_f32(a, i1), r, 1);
+	r = vsetq_lane_f32(vgetq_lane_f32(b, i2), r, 2);
+	return vsetq_lane_f32(vgetq_lane_f32(b, i3), r, 3);
+}
+
+#endif
+
+inline Simd::Float4 Simd::cross(Float4 a, Float4 b)
+{
+	// a x b = (a b.yzx - a.yzx b).yzx
+	return yzxw(sub(mul(a, yzxw(b)), mul(yzxw(a), b)));
+}
+
+#endif
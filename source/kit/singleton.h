@@ -2,6 +2,7 @@
 
 #include "ptr.h"
 #include <stdexcept>
+#include <utility>
 
 // A Generic Singleton. Note that calling instance does not lazy-construct the singleton if it does not already exist.
 template <typename T>
@@ -12,7 +13,7 @@ public:
 	static Ptr<T> instance();
 
 	// Creates the instance. If there is already an instance, throws a run_time exception.
-	template <typename ...Args> static void createInstance(Args... args);
+	template <typename ...Args> static void createInstance(Args && ... args);
 
 	// Destroys the instance. If there is not an instance, throws a run_time exception.
 	static void destroyInstance();
@@ -30,13 +31,13 @@ Ptr<T> Singleton<T>::instance()
 }
 
 template <typename T> template <typename ...Args>
-void Singleton<T>::createInstance(Args... args)
+void Singleton<T>::createInstance(Args && ... args)
 {
 	if(global.isValid())
 	{
 		throw std::exception();
 	}
-	global.setNew(args...);
+	global.setNew(std::forward<Args>(args)...);
 }
 
 template <typename T>
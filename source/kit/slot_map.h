@@ -0,0 +1,321 @@
+#pragma once
+
+#include <vector>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+/*
+A container where you put objects in and then refer to them by a handle that is given back.
+The objects are kept contiguous in memory, so iterating over them is a linear walk. Removing an object moves the last object into its place,
+so the order of iteration is not stable and pointers and references to objects are invalidated by add and remove, but handles are not.
+Each handle has the generation of its slot, so a handle to a removed object will never refer to a later object that reuses the slot.
+*/
+template <typename T>
+class SlotMap
+{
+public:
+	// A reference to an object in the map. It is only a pair of integers, so it is cheap to copy and store.
+	class Handle
+	{
+	public:
+		// Constructs to a handle that refers to nothing.
+		Handle();
+
+		// Returns true if the handles refer to the same slot and generation.
+		bool operator == (Handle const & handle) const;
+
+		// Returns true if the handles don't refer to the same slot and generation.
+		bool operator != (Handle const & handle) const;
+
+		// Returns true if this handle's slot and generation is less than the other's. Useful for ordered containers.
+		bool operator < (Handle const & handle) const;
+
+	private:
+		unsigned int slot;
+		unsigned int generation;
+
+		template <typename Y> friend class SlotMap;
+	};
+
+	typedef typename std::vector<T>::iterator iterator;
+	typedef typename std::vector<T>::const_iterator const_iterator;
+
+	// Constructor. O(1)
+	SlotMap();
+
+	// Adds an object and returns its handle. O(1) amortized.
+	Handle add(T object);
+
+	// Constructs an object in place from args and returns its handle. O(1) amortized.
+	template <typename... Args> Handle emplace(Args && ... args);
+
+	// Removes the object referred to by handle. Throws an exception if the handle is invalid. O(1)
+	void remove(Handle handle);
+
+	// Returns true if the handle refers to an object in the map. O(1)
+	bool has(Handle handle) const;
+
+	// Returns a reference to the object referred to by handle. Throws an exception if the handle is invalid. O(1)
+	T & get(Handle handle);
+
+	// Returns a reference to the object referred to by handle. Throws an exception if the handle is invalid. O(1)
+	T const & get(Handle handle) const;
+
+	// Returns a pointer to the object referred to by handle, or nullptr if the handle is invalid. O(1)
+	T * find(Handle handle);
+
+	// Returns a pointer to the object referred to by handle, or nullptr if the handle is invalid. O(1)
+	T const * find(Handle handle) const;
+
+	// Returns the handle of the object at the given position in the iteration order. O(1)
+	Handle getHandle(unsigned int index) const;
+
+	// Returns true if there are no objects. O(1)
+	bool empty() const;
+
+	// Returns the number of objects. O(1)
+	unsigned int size() const;
+
+	// Reserves memory for the given number of objects. O(number of objects)
+	void reserve(unsigned int capacity);
+
+	// Removes all objects. Every handle given out so far becomes invalid. O(number of slots)
+	void clear();
+
+	// The iterators over the objects.
+	iterator begin();
+	iterator end();
+	const_iterator begin() const;
+	const_iterator end() const;
+
+private:
+	class Slot
+	{
+	public:
+		unsigned int index; // The index of the object in objects if the slot is used, or the next free slot if it isn't.
+		unsigned int generation; // Incremented every time the slot's object is removed.
+	};
+
+	void throwInvalid(char const * function) const;
+
+	static const unsigned int noSlot = (unsigned int)-1;
+
+	std::vector<T> objects;
+	std::vector<unsigned int> objectSlots; // The slot for each object in objects.
+	std::vector<Slot> slots;
+	unsigned int firstFreeSlot;
+};
+
+// Template Implementation
+
+template <typename T>
+SlotMap<T>::Handle::Handle()
+{
+	slot = noSlot;
+	generation = 0;
+}
+
+template <typename T>
+bool SlotMap<T>::Handle::operator == (Handle const & handle) const
+{
+	return slot == handle.slot && generation == handle.generation;
+}
+
+template <typename T>
+bool SlotMap<T>::Handle::operator != (Handle const & handle) const
+{
+	return !(*this == handle);
+}
+
+template <typename T>
+bool SlotMap<T>::Handle::operator < (Handle const & handle) const
+{
+	return slot < handle.slot || (slot == handle.slot && generation < handle.generation);
+}
+
+template <typename T>
+SlotMap<T>::SlotMap()
+{
+	firstFreeSlot = noSlot;
+}
+
+template <typename T>
+typename SlotMap<T>::Handle SlotMap<T>::add(T object)
+{
+	return emplace(std::move(object));
+}
+
+template <typename T> template <typename... Args>
+typename SlotMap<T>::Handle SlotMap<T>::emplace(Args && ... args)
+{
+	if(firstFreeSlot == noSlot)
+	{
+		Slot slot;
+		slot.index = noSlot;
+		slot.generation = 0;
+		slots.push_back(slot);
+		firstFreeSlot = (unsigned int)slots.size() - 1;
+	}
+	objects.emplace_back(std::forward<Args>(args)...);
+	try
+	{
+		objectSlots.push_back(firstFreeSlot);
+	}
+	catch(...)
+	{
+		objects.pop_back();
+		throw;
+	}
+	Handle handle;
+	handle.slot = firstFreeSlot;
+	handle.generation = slots[firstFreeSlot].generation;
+	firstFreeSlot = slots[firstFreeSlot].index;
+	slots[handle.slot].index = (unsigned int)objects.size() - 1;
+	return handle;
+}
+
+template <typename T>
+void SlotMap<T>::remove(Handle handle)
+{
+	if(!has(handle))
+	{
+		throwInvalid("remove");
+	}
+	Slot & slot = slots[handle.slot];
+	unsigned int index = slot.index;
+	unsigned int lastIndex = (unsigned int)objects.size() - 1;
+	if(index != lastIndex)
+	{
+		objects[index] = std::move(objects[lastIndex]);
+		objectSlots[index] = objectSlots[lastIndex];
+		slots[objectSlots[index]].index = index;
+	}
+	objects.pop_back();
+	objectSlots.pop_back();
+	slot.generation++;
+	slot.index = firstFreeSlot;
+	firstFreeSlot = handle.slot;
+}
+
+template <typename T>
+bool SlotMap<T>::has(Handle handle) const
+{
+	if(handle.slot >= slots.size())
+	{
+		return false;
+	}
+	// The generation is incremented whenever the slot's object is removed, so a matching generation means the slot still has the handle's object.
+	return slots[handle.slot].generation == handle.generation;
+}
+
+template <typename T>
+T & SlotMap<T>::get(Handle handle)
+{
+	T * object = find(handle);
+	if(object == nullptr)
+	{
+		throwInvalid("get");
+	}
+	return *object;
+}
+
+template <typename T>
+T const & SlotMap<T>::get(Handle handle) const
+{
+	T const * object = find(handle);
+	if(object == nullptr)
+	{
+		throwInvalid("get");
+	}
+	return *object;
+}
+
+template <typename T>
+T * SlotMap<T>::find(Handle handle)
+{
+	return has(handle) ? &objects[slots[handle.slot].index] : nullptr;
+}
+
+template <typename T>
+T const * SlotMap<T>::find(Handle handle) const
+{
+	return has(handle) ? &objects[slots[handle.slot].index] : nullptr;
+}
+
+template <typename T>
+typename SlotMap<T>::Handle SlotMap<T>::getHandle(unsigned int index) const
+{
+	if(index >= objects.size())
+	{
+		throw std::out_of_range("In SlotMap::getHandle, an invalid index: " + std::to_string(index));
+	}
+	Handle handle;
+	handle.slot = objectSlots[index];
+	handle.generation = slots[handle.slot].generation;
+	return handle;
+}
+
+template <typename T>
+bool SlotMap<T>::empty() const
+{
+	return objects.empty();
+}
+
+template <typename T>
+unsigned int SlotMap<T>::size() const
+{
+	return (unsigned int)objects.size();
+}
+
+template <typename T>
+void SlotMap<T>::reserve(unsigned int capacity)
+{
+	objects.reserve(capacity);
+	objectSlots.reserve(capacity);
+	slots.reserve(capacity);
+}
+
+template <typename T>
+void SlotMap<T>::clear()
+{
+	// Every used slot is freed and its generation incremented, so that old handles stay invalid.
+	for(unsigned int slot : objectSlots)
+	{
+		slots[slot].generation++;
+		slots[slot].index = firstFreeSlot;
+		firstFreeSlot = slot;
+	}
+	objects.clear();
+	objectSlots.clear();
+}
+
+template <typename T>
+typename SlotMap<T>::iterator SlotMap<T>::begin()
+{
+	return objects.begin();
+}
+
+template <typename T>
+typename SlotMap<T>::iterator SlotMap<T>::end()
+{
+	return objects.end();
+}
+
+template <typename T>
+typename SlotMap<T>::const_iterator SlotMap<T>::begin() const
+{
+	return objects.begin();
+}
+
+template <typename T>
+typename SlotMap<T>::const_iterator SlotMap<T>::end() const
+{
+	return objects.end();
+}
+
+template <typename T>
+void SlotMap<T>::throwInvalid(char const * function) const
+{
+	throw std::out_of_range(std::string("In SlotMap::") + function + ", an invalid handle.");
+}
@@ -1,6 +1,7 @@
 #include "texture.h"
 #include "open_gl.h"
 #include <vector>
+#include <cstring>
 #include <SDL_image.h>
 
 std::vector<unsigned int> currentTextures; // Current textures in the OpenGL state.
@@ -44,6 +45,31 @@ Texture::Texture(std::string const & filename)
 	SDL_FreeSurface(surface);
 }
 
+Texture::Pixels Texture::loadPixels(std::string const & filename)
+{
+	SDL_Surface * surface = IMG_Load(filename.c_str());
+	if(surface == 0)
+	{
+		throw std::runtime_error("Could not load texture '" + filename + "': " + IMG_GetError());
+	}
+	SDL_Surface * converted = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ABGR8888, 0); // Bytes in RGBA order on little-endian.
+	SDL_FreeSurface(surface);
+	if(converted == 0)
+	{
+		throw std::runtime_error("Could not convert texture '" + filename + "': " + SDL_GetError());
+	}
+	Pixels pixels;
+	pixels.size[0] = converted->w;
+	pixels.size[1] = converted->h;
+	pixels.data.resize(converted->w * converted->h * 4);
+	for(int y = 0; y < converted->h; y++)
+	{
+		memcpy(&pixels.data[y * converted->w * 4], (unsigned char const *)converted->pixels + y * converted->pitch, converted->w * 4);
+	}
+	SDL_FreeSurface(converted);
+	return pixels;
+}
+
 Texture::~Texture()
 {
 	glDeleteTextures(1, &id);
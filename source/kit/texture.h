@@ -2,18 +2,30 @@
 
 #include "coord.h"
 #include <string>
+#include <vector>
 
 #pragma comment (lib, "SDL2_image.lib")
 
 class Texture
 {
 public:
+	// Raw RGBA32 pixels and their size.
+	class Pixels
+	{
+	public:
+		std::vector<unsigned char> data;
+		Coord2i size;
+	};
+
 	// Creates a new texture from raw RGBA32 pixels.
 	Texture(void const * pixels, Coord2i size);
 
 	// Creates a texture from a file.
 	Texture(std::string const & filename);
 
+	// Decodes a file into RGBA32 pixels. It doesn't use GL, so it can run on a worker thread, with the texture created later from the pixels.
+	static Pixels loadPixels(std::string const & filename);
+
 	// Destroys the texture.
 	virtual ~Texture();
 
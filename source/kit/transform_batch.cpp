@@ -0,0 +1,317 @@
+#include "transform_batch.h"
+
+static_assert(sizeof(Coord3f) == 3 * sizeof(float), "Coord3f arrays must be tightly packed floats.");
+static_assert(sizeof(Coord4f) == 4 * sizeof(float), "Coord4f arrays must be tightly packed floats.");
+static_assert(sizeof(Quaternionf) == 4 * sizeof(float), "Quaternionf arrays must be tightly packed floats, r first.");
+static_assert(sizeof(Affine3f) == 12 * sizeof(float), "Affine3f arrays must be tightly packed floats, linear part first.");
+
+#if SIMD_ENABLED
+
+namespace
+{
+	// The elements of a matrix, each repeated in all four lanes.
+	class SplatMatrix
+	{
+	public:
+		SplatMatrix(Matrix44f const & m)
+		{
+			for(unsigned int col = 0; col < 4; col++)
+			{
+				for(unsigned int row = 0; row < 4; row++)
+				{
+					e[row][col] = Simd::splat(m(row, col));
+				}
+			}
+		}
+
+		// Returns the row of the matrix times (x, y, z, w) for each lane, where w is 1 if point is true and 0 otherwise.
+		Simd::Float4 row(unsigned int row, Simd::Float4 x, Simd::Float4 y, Simd::Float4 z, bool point) const
+		{
+			Simd::Float4 r = Simd::mul(e[row][2], z);
+			if(point)
+			{
+				r = Simd::add(r, e[row][3]);
+			}
+			r = Simd::mulAdd(e[row][1], y, r);
+			return Simd::mulAdd(e[row][0], x, r);
+		}
+
+		Simd::Float4 e[4][4];
+	};
+
+	// Returns a b - c d.
+	Simd::Float4 mulSub(Simd::Float4 a, Simd::Float4 b, Simd::Float4 c, Simd::Float4 d)
+	{
+		return Simd::sub(Simd::mul(a, b), Simd::mul(c, d));
+	}
+
+	// Loads the column at offset k of the four matrices, and transposes it so that a[0] to a[3] each have one element of the four matrices.
+	void loadColumn(Matrix44f const * matrices, unsigned int k, Simd::Float4 * a)
+	{
+		a[0] = Simd::load(matrices[0].ptr() + k);
+		a[1] = Simd::load(matrices[1].ptr() + k);
+		a[2] = Simd::load(matrices[2].ptr() + k);
+		a[3] = Simd::load(matrices[3].ptr() + k);
+		Simd::transpose(a[0], a[1], a[2], a[3]);
+	}
+
+	// The reverse of loadColumn.
+	void storeColumn(Matrix44f * matrices, unsigned int k, Simd::Float4 * a)
+	{
+		Simd::transpose(a[0], a[1], a[2], a[3]);
+		Simd::store(matrices[0].ptr() + k, a[0]);
+		Simd::store(matrices[1].ptr() + k, a[1]);
+		Simd::store(matrices[2].ptr() + k, a[2]);
+		Simd::store(matrices[3].ptr() + k, a[3]);
+	}
+
+	// Returns (a x - b y + c z) scale.
+	Simd::Float4 cofactor(Simd::Float4 a, Simd::Float4 x, Simd::Float4 b, Simd::Float4 y, Simd::Float4 c, Simd::Float4 z, Simd::Float4 scale)
+	{
+		return Simd::mul(Simd::add(mulSub(a, x, b, y), Simd::mul(c, z)), scale);
+	}
+
+	void transformAoS(Matrix44f const & m, Coord3f const * in, Coord3f * out, unsigned int count, bool point)
+	{
+		SplatMatrix s(m);
+		unsigned int i = 0;
+		for(; i + 4 <= count; i += 4)
+		{
+			Simd::Float4 x, y, z;
+			Simd::loadInterleaved3(in[i].ptr(), x, y, z);
+			Simd::storeInterleaved3(out[i].ptr(), s.row(0, x, y, z, point), s.row(1, x, y, z, point), s.row(2, x, y, z, point));
+		}
+		for(; i < count; i++)
+		{
+			out[i] = m.transform(in[i], point ? 1.0f : 0.0f);
+		}
+	}
+
+	void transformSoA(Matrix44f const & m, float const * x, float const * y, float const * z, float * rx, float * ry, float * rz, unsigned int count, bool point)
+	{
+		SplatMatrix s(m);
+		unsigned int i = 0;
+		for(; i + 4 <= count; i += 4)
+		{
+			Simd::Float4 xi = Simd::load(x + i);
+			Simd::Float4 yi = Simd::load(y + i);
+			Simd::Float4 zi = Simd::load(z + i);
+			Simd::store(rx + i, s.row(0, xi, yi, zi, point));
+			Simd::store(ry + i, s.row(1, xi, yi, zi, point));
+			Simd::store(rz + i, s.row(2, xi, yi, zi, point));
+		}
+		for(; i < count; i++)
+		{
+			Coord3f r = m.transform(Coord3f{x[i], y[i], z[i]}, point ? 1.0f : 0.0f);
+			rx[i] = r[0];
+			ry[i] = r[1];
+			rz[i] = r[2];
+		}
+	}
+}
+
+#else
+
+namespace
+{
+	void transformAoS(Matrix44f const & m, Coord3f const * in, Coord3f * out, unsigned int count, bool point)
+	{
+		for(unsigned int i = 0; i < count; i++)
+		{
+			out[i] = m.transform(in[i], point ? 1.0f : 0.0f);
+		}
+	}
+
+	void transformSoA(Matrix44f const & m, float const * x, float const * y, float const * z, float * rx, float * ry, float * rz, unsigned int count, bool point)
+	{
+		for(unsigned int i = 0; i < count; i++)
+		{
+			Coord3f r = m.transform(Coord3f{x[i], y[i], z[i]}, point ? 1.0f : 0.0f);
+			rx[i] = r[0];
+			ry[i] = r[1];
+			rz[i] = r[2];
+		}
+	}
+}
+
+#endif
+
+void Batch::transformPoints(Matrix44f const & m, Coord3f const * points, Coord3f * results, unsigned int count)
+{
+	transformAoS(m, points, results, count, true);
+}
+
+void Batch::transformPoints(Matrix44f const & m, float const * x, float const * y, float const * z, float * rx, float * ry, float * rz, unsigned int count)
+{
+	transformSoA(m, x, y, z, rx, ry, rz, count, true);
+}
+
+void Batch::transformDirections(Matrix44f const & m, Coord3f const * directions, Coord3f * results, unsigned int count)
+{
+	transformAoS(m, directions, results, count, false);
+}
+
+void Batch::transformDirections(Matrix44f const & m, float const * x, float const * y, float const * z, float * rx, float * ry, float * rz, unsigned int count)
+{
+	transformSoA(m, x, y, z, rx, ry, rz, count, false);
+}
+
+void Batch::projectPoints(Matrix44f const & m, Coord3f const * points, Coord3f * results, unsigned int count)
+{
+	unsigned int i = 0;
+#if SIMD_ENABLED
+	SplatMatrix s(m);
+	for(; i + 4 <= count; i += 4)
+	{
+		Simd::Float4 x, y, z;
+		Simd::loadInterleaved3(points[i].ptr(), x, y, z);
+		Simd::Float4 w = s.row(3, x, y, z, true);
+		Simd::storeInterleaved3(results[i].ptr(), Simd::div(s.row(0, x, y, z, true), w), Simd::div(s.row(1, x, y, z, true), w), Simd::div(s.row(2, x, y, z, true), w));
+	}
+#endif
+	for(; i < count; i++)
+	{
+		Coord4f r = m * points[i].extend<4>(1);
+		results[i] = Coord3f{r[0] / r[3], r[1] / r[3], r[2] / r[3]};
+	}
+}
+
+void Batch::transform(Matrix44f const & m, Coord4f const * coords, Coord4f * results, unsigned int count)
+{
+	for(unsigned int i = 0; i < count; i++)
+	{
+		results[i] = m * coords[i]; // Already SIMD, with one coord per instruction.
+	}
+}
+
+void Batch::multiply(Matrix44f const & m, Matrix44f const * matrices, Matrix44f * results, unsigned int count)
+{
+	for(unsigned int i = 0; i < count; i++)
+	{
+		results[i] = m * matrices[i];
+	}
+}
+
+void Batch::invert(Matrix44f const * matrices, Matrix44f * results, unsigned int count)
+{
+	unsigned int i = 0;
+#if SIMD_ENABLED
+	for(; i + 4 <= count; i += 4)
+	{
+		// Load four matrices and transpose them so that each element has the four matrices in its lanes.
+		Simd::Float4 a[16];
+		loadColumn(matrices + i, 0, a + 0);
+		loadColumn(matrices + i, 4, a + 4);
+		loadColumn(matrices + i, 8, a + 8);
+		loadColumn(matrices + i, 12, a + 12);
+
+		// The same as the generic Matrix::inverse for 4x4 matrices.
+		Simd::Float4 s0 = mulSub(a[0], a[5], a[4], a[1]);
+		Simd::Float4 s1 = mulSub(a[0], a[6], a[4], a[2]);
+		Simd::Float4 s2 = mulSub(a[0], a[7], a[4], a[3]);
+		Simd::Float4 s3 = mulSub(a[1], a[6], a[5], a[2]);
+		Simd::Float4 s4 = mulSub(a[1], a[7], a[5], a[3]);
+		Simd::Float4 s5 = mulSub(a[2], a[7], a[6], a[3]);
+		Simd::Float4 c0 = mulSub(a[8], a[13], a[12], a[9]);
+		Simd::Float4 c1 = mulSub(a[8], a[14], a[12], a[10]);
+		Simd::Float4 c2 = mulSub(a[8], a[15], a[12], a[11]);
+		Simd::Float4 c3 = mulSub(a[9], a[14], a[13], a[10]);
+		Simd::Float4 c4 = mulSub(a[9], a[15], a[13], a[11]);
+		Simd::Float4 c5 = mulSub(a[10], a[15], a[14], a[11]);
+		Simd::Float4 det = Simd::add(Simd::add(mulSub(s0, c5, s1, c4), mulSub(s2, c3, s4, c1)), Simd::add(Simd::mul(s3, c2), Simd::mul(s5, c0)));
+		float dets[4];
+		Simd::store(dets, det);
+		if(dets[0] == 0 || dets[1] == 0 || dets[2] == 0 || dets[3] == 0)
+		{
+			throw std::exception();
+		}
+		Simd::Float4 detInv = Simd::div(Simd::splat(1.0f), det);
+		Simd::Float4 negDetInv = Simd::sub(Simd::splat(0.0f), detInv);
+		Simd::Float4 b[16];
+		b[0] = cofactor(a[5], c5, a[6], c4, a[7], c3, detInv);
+		b[1] = cofactor(a[1], c5, a[2], c4, a[3], c3, negDetInv);
+		b[2] = cofactor(a[13], s5, a[14], s4, a[15], s3, detInv);
+		b[3] = cofactor(a[9], s5, a[10], s4, a[11], s3, negDetInv);
+		b[4] = cofactor(a[4], c5, a[6], c2, a[7], c1, negDetInv);
+		b[5] = cofactor(a[0], c5, a[2], c2, a[3], c1, detInv);
+		b[6] = cofactor(a[12], s5, a[14], s2, a[15], s1, negDetInv);
+		b[7] = cofactor(a[8], s5, a[10], s2, a[11], s1, detInv);
+		b[8] = cofactor(a[4], c4, a[5], c2, a[7], c0, detInv);
+		b[9] = cofactor(a[0], c4, a[1], c2, a[3], c0, negDetInv);
+		b[10] = cofactor(a[12], s4, a[13], s2, a[15], s0, detInv);
+		b[11] = cofactor(a[8], s4, a[9], s2, a[11], s0, negDetInv);
+		b[12] = cofactor(a[4], c3, a[5], c1, a[6], c0, negDetInv);
+		b[13] = cofactor(a[0], c3, a[1], c1, a[2], c0, detInv);
+		b[14] = cofactor(a[12], s3, a[13], s1, a[14], s0, negDetInv);
+		b[15] = cofactor(a[8], s3, a[9], s1, a[10], s0, detInv);
+
+		// Transpose back, so that each matrix's sixteen floats are contiguous.
+		storeColumn(results + i, 0, b + 0);
+		storeColumn(results + i, 4, b + 4);
+		storeColumn(results + i, 8, b + 8);
+		storeColumn(results + i, 12, b + 12);
+	}
+#endif
+	for(; i < count; i++)
+	{
+		results[i] = matrices[i].inverse();
+	}
+}
+
+void Batch::composeTransforms(Coord3f const * positions, Quaternionf const * orientations, float const * scales, Affine3f * results, unsigned int count)
+{
+	unsigned int i = 0;
+#if SIMD_ENABLED
+	Simd::Float4 two = Simd::splat(2.0f);
+	for(; i + 4 <= count; i += 4)
+	{
+		// Load four quaternions and transpose them so that each of r, i, j, and k has the four entities in its lanes.
+		float const * q = reinterpret_cast<float const *>(orientations + i);
+		Simd::Float4 qr = Simd::load(q + 0);
+		Simd::Float4 qi = Simd::load(q + 4);
+		Simd::Float4 qj = Simd::load(q + 8);
+		Simd::Float4 qk = Simd::load(q + 12);
+		Simd::transpose(qr, qi, qj, qk);
+		Simd::Float4 s = Simd::load(scales + i);
+		Simd::Float4 s2 = Simd::mul(s, two);
+
+		// The same as Quaternion::getMatrix, with each column scaled. Column-major, so e[col * 3 + row].
+		Simd::Float4 e[12];
+		Simd::Float4 ii = Simd::mul(qi, qi);
+		Simd::Float4 jj = Simd::mul(qj, qj);
+		Simd::Float4 kk = Simd::mul(qk, qk);
+		Simd::Float4 ij = Simd::mul(qi, qj);
+		Simd::Float4 ik = Simd::mul(qi, qk);
+		Simd::Float4 jk = Simd::mul(qj, qk);
+		Simd::Float4 ir = Simd::mul(qi, qr);
+		Simd::Float4 jr = Simd::mul(qj, qr);
+		Simd::Float4 kr = Simd::mul(qk, qr);
+		e[0] = Simd::sub(s, Simd::mul(s2, Simd::add(jj, kk)));
+		e[1] = Simd::mul(s2, Simd::add(ij, kr));
+		e[2] = Simd::mul(s2, Simd::sub(ik, jr));
+		e[3] = Simd::mul(s2, Simd::sub(ij, kr));
+		e[4] = Simd::sub(s, Simd::mul(s2, Simd::add(ii, kk)));
+		e[5] = Simd::mul(s2, Simd::add(jk, ir));
+		e[6] = Simd::mul(s2, Simd::add(ik, jr));
+		e[7] = Simd::mul(s2, Simd::sub(jk, ir));
+		e[8] = Simd::sub(s, Simd::mul(s2, Simd::add(ii, jj)));
+		Simd::loadInterleaved3(positions[i].ptr(), e[9], e[10], e[11]);
+
+		// Transpose back, so that each entity's twelve floats are contiguous.
+		Simd::transpose(e[0], e[1], e[2], e[3]);
+		Simd::transpose(e[4], e[5], e[6], e[7]);
+		Simd::transpose(e[8], e[9], e[10], e[11]);
+		for(unsigned int k = 0; k < 4; k++)
+		{
+			float * r = reinterpret_cast<float *>(results + i + k);
+			Simd::store(r + 0, e[k]);
+			Simd::store(r + 4, e[4 + k]);
+			Simd::store(r + 8, e[8 + k]);
+		}
+	}
+#endif
+	for(; i < count; i++)
+	{
+		results[i] = Affine3f(scales[i] * orientations[i].getMatrix(), positions[i]);
+	}
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "affine.h"
+#include "quaternion.h"
+
+/*
+Functions that apply one matrix to many points, directions, or matrices at once.
+The arrays are contiguous and the inner loops work on four elements at a time with SIMD when it is enabled, so a large batch costs about one pass over its memory.
+The AoS versions take arrays of Coords and the SoA versions take a separate array for each component.
+The results may be written over the inputs, but the arrays may not otherwise overlap.
+*/
+namespace Batch
+{
+	// Sets results[i] to m points[i], extending each point with a w of 1.
+	void transformPoints(Matrix44f const & m, Coord3f const * points, Coord3f * results, unsigned int count);
+
+	// Sets (rx[i], ry[i], rz[i]) to m (x[i], y[i], z[i]), extending each point with a w of 1.
+	void transformPoints(Matrix44f const & m, float const * x, float const * y, float const * z, float * rx, float * ry, float * rz, unsigned int count);
+
+	// Sets results[i] to m directions[i], extending each direction with a w of 0.
+	void transformDirections(Matrix44f const & m, Coord3f const * directions, Coord3f * results, unsigned int count);
+
+	// Sets (rx[i], ry[i], rz[i]) to m (x[i], y[i], z[i]), extending each direction with a w of 0.
+	void transformDirections(Matrix44f const & m, float const * x, float const * y, float const * z, float * rx, float * ry, float * rz, unsigned int count);
+
+	// Sets results[i] to m points[i], extending each point with a w of 1 and then dividing by the resulting w. Used for projections.
+	void projectPoints(Matrix44f const & m, Coord3f const * points, Coord3f * results, unsigned int count);
+
+	// Sets results[i] to m coords[i].
+	void transform(Matrix44f const & m, Coord4f const * coords, Coord4f * results, unsigned int count);
+
+	// Sets results[i] to m matrices[i].
+	void multiply(Matrix44f const & m, Matrix44f const * matrices, Matrix44f * results, unsigned int count);
+
+	// Sets results[i] to the inverse of matrices[i]. Throws an exception if any of them is singular.
+	void invert(Matrix44f const * matrices, Matrix44f * results, unsigned int count);
+
+	// Sets results[i] to the transform that scales by scales[i], rotates by orientations[i], and then translates by positions[i]. The orientations must be normalized.
+	void composeTransforms(Coord3f const * positions, Quaternionf const * orientations, float const * scales, Affine3f * results, unsigned int count);
+}
@@ -0,0 +1,624 @@
+#include "triangle_bvh.h"
+#include "intersect_batch.h"
+#include "serialize.h"
+#include "simd.h"
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <thread>
+
+class TriangleBvh::BuildTriangle
+{
+public:
+	Boxf box;
+	Coord3f center;
+	unsigned int index;
+};
+
+class TriangleBvh::Subtree
+{
+public:
+	unsigned int node;
+	unsigned int begin;
+	unsigned int end;
+	unsigned int depth;
+	std::vector<Node> nodes;
+};
+
+namespace
+{
+	float const infinity = std::numeric_limits<float>::infinity();
+
+	// Nodes with this many triangles or fewer are always leaves, since Batch::intersectRayTriangles tests four at a time.
+	unsigned int const minLeafSize = 4;
+
+	// Nodes with more triangles than this are always split, even if the surface area heuristic says otherwise.
+	unsigned int const maxLeafSize = 16;
+
+	// The number of bins along each axis for the surface area heuristic.
+	unsigned int const numBins = 16;
+
+	// The cost of visiting a node, relative to testing a triangle.
+	float const traversalCost = 1.0f;
+
+	// Below this depth, nodes are split at their median instead, which bounds the depth of the tree for any mesh.
+	// The traversal stack holds at most one node more than the depth.
+	unsigned int const maxHeuristicDepth = 64;
+	unsigned int const maxDepth = maxHeuristicDepth + 32;
+	unsigned int const maxStackSize = maxDepth + 1;
+
+	unsigned int const none = (unsigned int)-1;
+
+	// Returns half of the surface area of the box.
+	float halfArea(Boxf const & box)
+	{
+		Coord3f size = box.max - box.min;
+		return size[0] * size[1] + size[1] * size[2] + size[2] * size[0];
+	}
+
+	// Extends the box around the other. It works on the elements directly, since it is in the inner loops of the build.
+	void extend(Boxf & box, Boxf const & other)
+	{
+		float * min = box.min.ptr();
+		float * max = box.max.ptr();
+		float const * otherMin = other.min.ptr();
+		float const * otherMax = other.max.ptr();
+		for(unsigned int axis = 0; axis < 3; axis++)
+		{
+			min[axis] = std::min(min[axis], otherMin[axis]);
+			max[axis] = std::max(max[axis], otherMax[axis]);
+		}
+	}
+
+	Coord3f inverse(Coord3f direction)
+	{
+		return Coord3f{1.0f / direction[0], 1.0f / direction[1], 1.0f / direction[2]};
+	}
+
+	// Returns where the ray enters the box, or infinity if it misses, as in intersect_batch.h.
+	float intersect(Coord3f start, Coord3f directionInv, Boxf const & box)
+	{
+		float near = 0;
+		float far = infinity;
+		for(unsigned int axis = 0; axis < 3; axis++)
+		{
+			float t0 = (box.min[axis] - start[axis]) * directionInv[axis];
+			float t1 = (box.max[axis] - start[axis]) * directionInv[axis];
+			near = std::max(near, std::min(t1, t0));
+			far = std::min(far, std::max(t1, t0));
+		}
+		return near <= far ? near : infinity;
+	}
+
+	// The rays of a packet, with the inverses of their directions for the slab test. Packets of fewer than four rays repeat the first ray.
+	// With SIMD, each register has an element of all four rays, so that a box is tested against all of them at once.
+	class Packet
+	{
+	public:
+#if SIMD_ENABLED
+		Simd::Float4 start[3];
+		Simd::Float4 directionInv[3];
+#else
+		Coord3f start[4];
+		Coord3f directionInv[4];
+#endif
+	};
+
+	Packet makePacket(Ray3f const * rays, unsigned int count)
+	{
+		Packet packet;
+#if SIMD_ENABLED
+		for(unsigned int axis = 0; axis < 3; axis++)
+		{
+			float start[4], directionInv[4];
+			for(unsigned int i = 0; i < 4; i++)
+			{
+				Ray3f const & ray = rays[i < count ? i : 0];
+				start[i] = ray.start[axis];
+				directionInv[i] = 1.0f / ray.direction[axis];
+			}
+			packet.start[axis] = Simd::load(start);
+			packet.directionInv[axis] = Simd::load(directionInv);
+		}
+#else
+		for(unsigned int i = 0; i < 4; i++)
+		{
+			packet.start[i] = rays[i < count ? i : 0].start;
+			packet.directionInv[i] = inverse(rays[i < count ? i : 0].direction);
+		}
+#endif
+		return packet;
+	}
+
+	// Sets distances[i] to where ray i of the packet enters the box, or infinity if it misses, as in intersect_batch.h.
+	void intersect(Packet const & packet, Boxf const & box, float * distances)
+	{
+#if SIMD_ENABLED
+		Simd::Float4 near = Simd::splat(0.0f);
+		Simd::Float4 far = Simd::splat(infinity);
+		for(unsigned int axis = 0; axis < 3; axis++)
+		{
+			Simd::Float4 t0 = Simd::mul(Simd::sub(Simd::splat(box.min[axis]), packet.start[axis]), packet.directionInv[axis]);
+			Simd::Float4 t1 = Simd::mul(Simd::sub(Simd::splat(box.max[axis]), packet.start[axis]), packet.directionInv[axis]);
+			near = Simd::max(Simd::min(t0, t1), near);
+			far = Simd::min(Simd::max(t0, t1), far);
+		}
+		Simd::store(distances, Simd::ifLessEqual(near, far, near, Simd::splat(infinity)));
+#else
+		for(unsigned int i = 0; i < 4; i++)
+		{
+			distances[i] = intersect(packet.start[i], packet.directionInv[i], box);
+		}
+#endif
+	}
+}
+
+TriangleBvh::TriangleBvh()
+{
+}
+
+TriangleBvh::TriangleBvh(Coord3f const * positions, unsigned int const * indices, unsigned int numIndices, unsigned int numThreads)
+{
+	unsigned int numTriangles = numIndices / 3;
+	if(numTriangles == 0)
+	{
+		return;
+	}
+	std::vector<BuildTriangle> buildTriangles(numTriangles);
+	for(unsigned int i = 0; i < numTriangles; i++)
+	{
+		Coord3f v0 = positions[indices[3 * i]];
+		buildTriangles[i].box = Boxf(v0, v0).extendedTo(positions[indices[3 * i + 1]]).extendedTo(positions[indices[3 * i + 2]]);
+		buildTriangles[i].center = buildTriangles[i].box.min + buildTriangles[i].box.max; // Doubled, which doesn't change the splits.
+		buildTriangles[i].index = i;
+	}
+
+	// Build the top of the tree on this thread, leaving subtrees of a few times fewer triangles than there are threads, and then build those on all of the threads.
+	// Each subtree has its own nodes, which are appended afterward. The subtrees partition separate ranges of the triangles, so they don't interfere.
+	if(numThreads == 0)
+	{
+		numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+	std::vector<Subtree> subtrees;
+	unsigned int maxSubtreeSize = std::max(numTriangles / (4 * numThreads), 1024u);
+	nodes.resize(1);
+	build(nodes, 0, &buildTriangles[0], 0, numTriangles, 0, maxSubtreeSize, numThreads > 1 ? &subtrees : nullptr);
+	if(!subtrees.empty())
+	{
+		std::atomic<unsigned int> nextSubtree(0);
+		auto buildSubtrees = [&]()
+		{
+			for(unsigned int i = nextSubtree++; i < subtrees.size(); i = nextSubtree++)
+			{
+				Subtree & subtree = subtrees[i];
+				subtree.nodes.resize(1);
+				build(subtree.nodes, 0, &buildTriangles[0], subtree.begin, subtree.end, subtree.depth, 0, nullptr);
+			}
+		};
+		std::vector<std::thread> threads;
+		for(unsigned int i = 1; i < std::min(numThreads, (unsigned int)subtrees.size()); i++)
+		{
+			threads.push_back(std::thread(buildSubtrees));
+		}
+		buildSubtrees();
+		for(std::thread & thread : threads)
+		{
+			thread.join();
+		}
+		for(Subtree const & subtree : subtrees)
+		{
+			// The subtree's root replaces its node, and the rest of its nodes are appended, so their children move by the offset.
+			unsigned int offset = (unsigned int)nodes.size() - 1;
+			for(unsigned int i = 0; i < subtree.nodes.size(); i++)
+			{
+				Node node = subtree.nodes[i];
+				if(node.count == 0)
+				{
+					node.first += offset;
+				}
+				if(i == 0)
+				{
+					nodes[subtree.node] = node;
+				}
+				else
+				{
+					nodes.push_back(node);
+				}
+			}
+		}
+	}
+
+	// Copy the vertices in the order of the leaves.
+	vertices.resize(3 * numTriangles);
+	triangles.resize(numTriangles);
+	for(unsigned int i = 0; i < numTriangles; i++)
+	{
+		unsigned int index = buildTriangles[i].index;
+		for(unsigned int j = 0; j < 3; j++)
+		{
+			vertices[3 * i + j] = positions[indices[3 * index + j]];
+		}
+		triangles[i] = index;
+	}
+}
+
+unsigned int TriangleBvh::getNumTriangles() const
+{
+	return (unsigned int)triangles.size();
+}
+
+Boxf TriangleBvh::getBounds() const
+{
+	return nodes.empty() ? Boxf() : nodes[0].box;
+}
+
+TriangleBvh::Hit TriangleBvh::castRay(Ray3f const & ray) const
+{
+	Hit hit;
+	hit.triangle = none;
+	hit.distance = infinity;
+	hit.u = hit.v = 0;
+	if(nodes.empty())
+	{
+		return hit;
+	}
+	Coord3f directionInv = inverse(ray.direction);
+	unsigned int nearestLeafTriangle = none;
+	std::pair<unsigned int, float> stack[maxStackSize];
+	unsigned int stackSize = 0;
+	stack[stackSize++] = std::pair<unsigned int, float>(0, intersect(ray.start, directionInv, nodes[0].box));
+	while(stackSize > 0)
+	{
+		std::pair<unsigned int, float> entry = stack[--stackSize];
+		if(entry.second >= hit.distance)
+		{
+			continue;
+		}
+		Node const & node = nodes[entry.first];
+		if(node.count > 0)
+		{
+			float distances[maxLeafSize];
+			Batch::intersectRayTriangles(ray, &vertices[3 * node.first], distances, node.count);
+			for(unsigned int i = 0; i < node.count; i++)
+			{
+				if(distances[i] < hit.distance)
+				{
+					hit.distance = distances[i];
+					nearestLeafTriangle = node.first + i;
+				}
+			}
+			continue;
+		}
+		// Push the farther child first, so that the nearer one is visited first.
+		float distance0 = intersect(ray.start, directionInv, nodes[node.first].box);
+		float distance1 = intersect(ray.start, directionInv, nodes[node.first + 1].box);
+		unsigned int near = node.first;
+		unsigned int far = node.first + 1;
+		if(distance1 < distance0)
+		{
+			std::swap(distance0, distance1);
+			std::swap(near, far);
+		}
+		if(distance1 < hit.distance)
+		{
+			stack[stackSize++] = std::pair<unsigned int, float>(far, distance1);
+		}
+		if(distance0 < hit.distance)
+		{
+			stack[stackSize++] = std::pair<unsigned int, float>(near, distance0);
+		}
+	}
+	if(nearestLeafTriangle != none)
+	{
+		setHit(ray, nearestLeafTriangle, hit);
+	}
+	return hit;
+}
+
+void TriangleBvh::castRays(Ray3f const * rays, Hit * hits, unsigned int count) const
+{
+	for(unsigned int i = 0; i < count; i += 4)
+	{
+		castPacket(rays + i, hits + i, std::min(count - i, 4u));
+	}
+}
+
+void TriangleBvh::build(std::vector<Node> & nodes, unsigned int node, BuildTriangle * triangles, unsigned int begin, unsigned int end, unsigned int depth,
+	unsigned int maxSubtreeSize, std::vector<Subtree> * subtrees)
+{
+	Boxf box = triangles[begin].box;
+	Boxf centers(triangles[begin].center, triangles[begin].center);
+	for(unsigned int i = begin + 1; i < end; i++)
+	{
+		extend(box, triangles[i].box);
+		extend(centers, Boxf(triangles[i].center, triangles[i].center));
+	}
+	nodes[node].box = box;
+	unsigned int count = end - begin;
+	if(subtrees != nullptr && count <= maxSubtreeSize)
+	{
+		Subtree subtree;
+		subtree.node = node;
+		subtree.begin = begin;
+		subtree.end = end;
+		subtree.depth = depth;
+		subtrees->push_back(subtree);
+		return;
+	}
+	if(count <= minLeafSize)
+	{
+		nodes[node].first = begin;
+		nodes[node].count = count;
+		return;
+	}
+
+	// Find the split between bins with the lowest cost by the surface area heuristic, along any axis. All three axes are binned in one pass.
+	Coord3f binScale;
+	for(unsigned int axis = 0; axis < 3; axis++)
+	{
+		float extent = centers.max[axis] - centers.min[axis];
+		binScale[axis] = extent > 0 ? numBins * 0.9999f / extent : 0.0f;
+	}
+	Boxf binBoxes[3][numBins];
+	unsigned int binCounts[3][numBins] = {};
+	if(depth < maxHeuristicDepth)
+	{
+		for(unsigned int i = begin; i < end; i++)
+		{
+			for(unsigned int axis = 0; axis < 3; axis++)
+			{
+				unsigned int bin = (unsigned int)((triangles[i].center.ptr()[axis] - centers.min.ptr()[axis]) * binScale.ptr()[axis]);
+				if(binCounts[axis][bin]++ == 0)
+				{
+					binBoxes[axis][bin] = triangles[i].box;
+				}
+				else
+				{
+					extend(binBoxes[axis][bin], triangles[i].box);
+				}
+			}
+		}
+	}
+	float bestCost = infinity;
+	unsigned int bestAxis = 0;
+	unsigned int bestBin = 0;
+	for(unsigned int axis = 0; axis < 3 && depth < maxHeuristicDepth; axis++)
+	{
+		// Sweep from the left and then from the right, so that the cost of each split is the sum of both sides. Splits with an empty side are skipped.
+		float leftCosts[numBins - 1];
+		unsigned int leftCounts[numBins - 1];
+		Boxf sideBox;
+		unsigned int sideCount = 0;
+		for(unsigned int bin = 0; bin < numBins - 1; bin++)
+		{
+			if(binCounts[axis][bin] > 0)
+			{
+				if(sideCount == 0)
+				{
+					sideBox = binBoxes[axis][bin];
+				}
+				else
+				{
+					extend(sideBox, binBoxes[axis][bin]);
+				}
+				sideCount += binCounts[axis][bin];
+			}
+			leftCosts[bin] = sideCount * halfArea(sideBox);
+			leftCounts[bin] = sideCount;
+		}
+		sideCount = 0;
+		for(unsigned int bin = numBins - 1; bin > 0; bin--)
+		{
+			if(binCounts[axis][bin] > 0)
+			{
+				if(sideCount == 0)
+				{
+					sideBox = binBoxes[axis][bin];
+				}
+				else
+				{
+					extend(sideBox, binBoxes[axis][bin]);
+				}
+				sideCount += binCounts[axis][bin];
+			}
+			if(sideCount == 0 || leftCounts[bin - 1] == 0)
+			{
+				continue;
+			}
+			float cost = leftCosts[bin - 1] + sideCount * halfArea(sideBox);
+			if(cost < bestCost)
+			{
+				bestCost = cost;
+				bestAxis = axis;
+				bestBin = bin - 1;
+			}
+		}
+	}
+
+	// Make a leaf if it is cheaper than splitting, or split at the bin, or if there is no split, at the median along the widest axis.
+	float area = halfArea(box);
+	if(bestCost < infinity && count <= maxLeafSize && traversalCost * area + bestCost >= count * area)
+	{
+		nodes[node].first = begin;
+		nodes[node].count = count;
+		return;
+	}
+	unsigned int middle = begin;
+	if(bestCost < infinity)
+	{
+		middle = (unsigned int)(std::partition(triangles + begin, triangles + end, [&](BuildTriangle const & triangle)
+		{
+			return (unsigned int)((triangle.center[bestAxis] - centers.min[bestAxis]) * binScale[bestAxis]) <= bestBin;
+		}) - triangles);
+	}
+	if(middle == begin || middle == end)
+	{
+		Coord3f size = centers.max - centers.min;
+		unsigned int axis = size[0] >= size[1] && size[0] >= size[2] ? 0 : (size[1] >= size[2] ? 1 : 2);
+		middle = begin + count / 2;
+		std::nth_element(triangles + begin, triangles + middle, triangles + end, [axis](BuildTriangle const & triangle0, BuildTriangle const & triangle1)
+		{
+			return triangle0.center[axis] < triangle1.center[axis];
+		});
+	}
+
+	unsigned int first = (unsigned int)nodes.size();
+	nodes.resize(first + 2);
+	nodes[node].first = first;
+	nodes[node].count = 0;
+	build(nodes, first, triangles, begin, middle, depth + 1, maxSubtreeSize, subtrees);
+	build(nodes, first + 1, triangles, middle, end, depth + 1, maxSubtreeSize, subtrees);
+}
+
+void TriangleBvh::castPacket(Ray3f const * rays, Hit * hits, unsigned int count) const
+{
+	unsigned int nearestLeafTriangles[4];
+	for(unsigned int i = 0; i < count; i++)
+	{
+		hits[i].triangle = none;
+		hits[i].distance = infinity;
+		hits[i].u = hits[i].v = 0;
+		nearestLeafTriangles[i] = none;
+	}
+	if(nodes.empty())
+	{
+		return;
+	}
+
+	// A node is visited if any of the rays enters it before its nearest hit so far. The children are visited in the order of the first ray's direction.
+	Packet packet = makePacket(rays, count);
+	unsigned int stack[maxStackSize];
+	unsigned int stackSize = 0;
+	stack[stackSize++] = 0;
+	while(stackSize > 0)
+	{
+		Node const & node = nodes[stack[--stackSize]];
+		float boxDistances[4];
+		intersect(packet, node.box, boxDistances);
+		bool entered = false;
+		for(unsigned int i = 0; i < count; i++)
+		{
+			entered = entered || boxDistances[i] < hits[i].distance;
+		}
+		if(!entered)
+		{
+			continue;
+		}
+		if(node.count > 0)
+		{
+			for(unsigned int i = 0; i < count; i++)
+			{
+				if(boxDistances[i] >= hits[i].distance)
+				{
+					continue;
+				}
+				float distances[maxLeafSize];
+				Batch::intersectRayTriangles(rays[i], &vertices[3 * node.first], distances, node.count);
+				for(unsigned int j = 0; j < node.count; j++)
+				{
+					if(distances[j] < hits[i].distance)
+					{
+						hits[i].distance = distances[j];
+						nearestLeafTriangles[i] = node.first + j;
+					}
+				}
+			}
+			continue;
+		}
+		Coord3f separation = (nodes[node.first + 1].box.min + nodes[node.first + 1].box.max) - (nodes[node.first].box.min + nodes[node.first].box.max);
+		unsigned int axis = std::abs(separation[0]) >= std::abs(separation[1]) && std::abs(separation[0]) >= std::abs(separation[2]) ? 0 : (std::abs(separation[1]) >= std::abs(separation[2]) ? 1 : 2);
+		bool secondIsNearer = (separation[axis] < 0) == (rays[0].direction[axis] > 0);
+		stack[stackSize++] = node.first + (secondIsNearer ? 0 : 1);
+		stack[stackSize++] = node.first + (secondIsNearer ? 1 : 0);
+	}
+	for(unsigned int i = 0; i < count; i++)
+	{
+		if(nearestLeafTriangles[i] != none)
+		{
+			setHit(rays[i], nearestLeafTriangles[i], hits[i]);
+		}
+	}
+}
+
+void TriangleBvh::setHit(Ray3f const & ray, unsigned int leafTriangle, Hit & hit) const
+{
+	// The barycentric coordinates of the Moller-Trumbore test, as in intersect_batch.cpp.
+	Coord3f const * v = &vertices[3 * leafTriangle];
+	Coord3f e1 = v[1] - v[0];
+	Coord3f e2 = v[2] - v[0];
+	Coord3f p = ray.direction.cross(e2);
+	float detInv = 1.0f / e1.dot(p);
+	Coord3f s = ray.start - v[0];
+	hit.triangle = triangles[leafTriangle];
+	hit.u = s.dot(p) * detInv;
+	hit.v = ray.direction.dot(s.cross(e1)) * detInv;
+}
+
+void serialize(std::ostream & out, TriangleBvh const & bvh)
+{
+	static_assert(sizeof(TriangleBvh::Node) == 8 * sizeof(float), "Nodes must be tightly packed to be serialized directly.");
+	serialize(out, (unsigned int)bvh.nodes.size());
+	serialize(out, (unsigned int)bvh.triangles.size());
+	if(!bvh.nodes.empty())
+	{
+		serialize(out, (void const *)&bvh.nodes[0], (int)(bvh.nodes.size() * sizeof(TriangleBvh::Node)));
+		serialize(out, (void const *)&bvh.vertices[0], (int)(bvh.vertices.size() * sizeof(Coord3f)));
+		serialize(out, (void const *)&bvh.triangles[0], (int)(bvh.triangles.size() * sizeof(unsigned int)));
+	}
+}
+
+void deserialize(std::istream & in, TriangleBvh & bvh)
+{
+	unsigned int numNodes, numTriangles;
+	deserialize(in, numNodes);
+	deserialize(in, numTriangles);
+	if((numNodes == 0) != (numTriangles == 0))
+	{
+		throw std::exception();
+	}
+	bvh.nodes.resize(numNodes);
+	bvh.vertices.resize(3 * numTriangles);
+	bvh.triangles.resize(numTriangles);
+	if(numNodes > 0)
+	{
+		deserialize(in, (void *)&bvh.nodes[0], (int)(numNodes * sizeof(TriangleBvh::Node)));
+		deserialize(in, (void *)&bvh.vertices[0], (int)(3 * numTriangles * sizeof(Coord3f)));
+		deserialize(in, (void *)&bvh.triangles[0], (int)(numTriangles * sizeof(unsigned int)));
+	}
+
+	// Check that the nodes refer to nodes and triangles that exist, that children come after their parents, that every node but the root has
+	// exactly one parent, and that the tree isn't too deep, so that a bad file can't make a ray cast go out of bounds or loop forever.
+	// Since children come after their parents, a node without a parent by the time it is reached is unreachable, and its depth would be wrong.
+	std::vector<unsigned int> depths(numNodes, 0);
+	std::vector<bool> hasParent(numNodes, false);
+	for(unsigned int i = 0; i < numNodes; i++)
+	{
+		TriangleBvh::Node const & node = bvh.nodes[i];
+		if(i > 0 && !hasParent[i])
+		{
+			throw std::exception();
+		}
+		if(node.count == 0)
+		{
+			if(node.first <= i || node.first >= numNodes - 1 || depths[i] >= maxDepth || hasParent[node.first] || hasParent[node.first + 1])
+			{
+				throw std::exception();
+			}
+			hasParent[node.first] = hasParent[node.first + 1] = true;
+			depths[node.first] = depths[node.first + 1] = depths[i] + 1;
+		}
+		else if(node.count > maxLeafSize || node.count > numTriangles || node.first > numTriangles - node.count)
+		{
+			throw std::exception();
+		}
+	}
+
+	// Check that the hits refer to triangles that exist, so that a hit can't index past the indices given to the constructor.
+	for(unsigned int triangle : bvh.triangles)
+	{
+		if(triangle >= numTriangles)
+		{
+			throw std::exception();
+		}
+	}
+}
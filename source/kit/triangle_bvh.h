@@ -0,0 +1,82 @@
+#pragma once
+
+#include "box.h"
+#include "ray.h"
+#include <istream>
+#include <ostream>
+#include <vector>
+
+/*
+A bounding volume hierarchy over the triangles of a mesh, for casting rays against the mesh on the CPU, as for picking in an editor.
+It is built with the surface area heuristic over binned centers, and the subtrees below the first few splits are built in parallel.
+It keeps its own copy of the vertices of each triangle, in the order of its leaves, so that a leaf's triangles are tested together with
+Batch::intersectRayTriangles. Building takes a while for large meshes, so it can be serialized and loaded again instead.
+*/
+class TriangleBvh
+{
+public:
+	// Where a ray hits a triangle.
+	class Hit
+	{
+	public:
+		unsigned int triangle; // The index of the triangle, as in indices[3 triangle] to indices[3 triangle + 2] given to the constructor.
+		float distance; // The distance along the ray, in units of its direction, or infinity if it missed.
+		float u; // The barycentric coordinates, so that the point is (1 - u - v) v0 + u v1 + v v2.
+		float v;
+	};
+
+	// Constructs an empty hierarchy, which no ray hits.
+	TriangleBvh();
+
+	// Builds from the triangles, which are every three indices into positions. If numThreads is 0, it uses the number of hardware threads.
+	TriangleBvh(Coord3f const * positions, unsigned int const * indices, unsigned int numIndices, unsigned int numThreads = 0);
+
+	// Returns the number of triangles.
+	unsigned int getNumTriangles() const;
+
+	// Returns the box around all of the triangles.
+	Boxf getBounds() const;
+
+	// Returns the nearest hit of the ray, from either side of the triangles. If it misses, the distance is infinity.
+	Hit castRay(Ray3f const & ray) const;
+
+	// Sets hits[i] to castRay(rays[i]). The rays go down the tree in packets of four, which is faster when they are coherent, as for the pixels of a view.
+	void castRays(Ray3f const * rays, Hit * hits, unsigned int count) const;
+
+private:
+	// A node is a leaf of the triangles from first to first + count - 1, or if count is 0, a parent of the nodes first and first + 1.
+	class Node
+	{
+	public:
+		Boxf box;
+		unsigned int first;
+		unsigned int count;
+	};
+
+	class BuildTriangle;
+	class Subtree;
+
+	// Builds the node over triangles begin to end - 1 and its descendants, appending them to nodes. If subtrees isn't null,
+	// nodes with no more than maxSubtreeSize triangles are left for later and added to subtrees instead.
+	static void build(std::vector<Node> & nodes, unsigned int node, BuildTriangle * triangles, unsigned int begin, unsigned int end, unsigned int depth,
+		unsigned int maxSubtreeSize, std::vector<Subtree> * subtrees);
+
+	// Casts up to four rays together.
+	void castPacket(Ray3f const * rays, Hit * hits, unsigned int count) const;
+
+	// Sets the triangle and the barycentric coordinates of the hit, given the triangle's place in the leaf order.
+	void setHit(Ray3f const & ray, unsigned int leafTriangle, Hit & hit) const;
+
+	std::vector<Node> nodes;
+	std::vector<Coord3f> vertices; // Three for each triangle, in the order of the leaves.
+	std::vector<unsigned int> triangles; // The index given to the constructor of each triangle, in the order of the leaves.
+
+	friend void serialize(std::ostream & out, TriangleBvh const & bvh);
+	friend void deserialize(std::istream & in, TriangleBvh & bvh);
+};
+
+// Serializes the hierarchy to out.
+void serialize(std::ostream & out, TriangleBvh const & bvh);
+
+// Deserializes the hierarchy from in. Throws an exception if it isn't valid, such as having a node or triangle index that is out of range.
+void deserialize(std::istream & in, TriangleBvh & bvh);
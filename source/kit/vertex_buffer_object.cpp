@@ -8,6 +8,7 @@ VertexBufferObject::VertexBufferObject()
 	mode = GL_TRIANGLES;
 	numIndices = 0;
 	bytesPerVertex = 0;
+	bytesPerInstance = 0;
 }
 
 VertexBufferObject::~VertexBufferObject()
@@ -25,9 +26,19 @@ void VertexBufferObject::addVertexComponent(int location, unsigned int offset, u
 	vertexComponents.push_back(vertexComponent);
 }
 
+void VertexBufferObject::addInstanceComponent(int location, unsigned int offset, unsigned int numDimensions)
+{
+	VertexComponent instanceComponent;
+	instanceComponent.index = location;
+	instanceComponent.size = numDimensions;
+	instanceComponent.offset = offset;
+	instanceComponents.push_back(instanceComponent);
+}
+
 void VertexBufferObject::clearVertexComponents()
 {
 	vertexComponents.clear();
+	instanceComponents.clear();
 }
 
 void VertexBufferObject::setBytesPerVertex(unsigned int bytes)
@@ -35,6 +46,11 @@ void VertexBufferObject::setBytesPerVertex(unsigned int bytes)
 	bytesPerVertex = bytes;
 }
 
+void VertexBufferObject::setBytesPerInstance(unsigned int bytes)
+{
+	bytesPerInstance = bytes;
+}
+
 void VertexBufferObject::setNumIndicesPerPrimitive(unsigned int num)
 {
 	switch(num)
@@ -89,3 +105,30 @@ void VertexBufferObject::render() const
 	glDrawElements(mode, numIndices, GL_UNSIGNED_INT, 0);
 }
 
+void VertexBufferObject::render(InstanceBufferObject const & instances, unsigned int firstInstance, unsigned int numInstances) const
+{
+	glBindBuffer(GL_ARRAY_BUFFER, arrayBuffer);
+	for(VertexComponent const & vertexComponent : vertexComponents)
+	{
+		glEnableVertexAttribArray(vertexComponent.index);
+		glVertexAttribPointer(vertexComponent.index, vertexComponent.size, GL_FLOAT, GL_FALSE, bytesPerVertex, (void const *)vertexComponent.offset);
+	}
+	instances.bind();
+	for(VertexComponent const & instanceComponent : instanceComponents)
+	{
+		glEnableVertexAttribArray(instanceComponent.index);
+		glVertexAttribPointer(instanceComponent.index, instanceComponent.size, GL_FLOAT, GL_FALSE, bytesPerInstance, (void const *)(firstInstance * bytesPerInstance + instanceComponent.offset));
+		glVertexAttribDivisor(instanceComponent.index, 1);
+	}
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementArrayBuffer);
+	glDrawElementsInstanced(mode, numIndices, GL_UNSIGNED_INT, 0, numInstances);
+
+	// There is no vertex array object, so the divisors are global state for the attribute locations. They are put back, so that the
+	// plain render and other shaders, such as those of GuiModel, read the same locations once per vertex.
+	for(VertexComponent const & instanceComponent : instanceComponents)
+	{
+		glVertexAttribDivisor(instanceComponent.index, 0);
+		glDisableVertexAttribArray(instanceComponent.index);
+	}
+}
+
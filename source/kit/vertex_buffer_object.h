@@ -1,5 +1,6 @@
 #pragma once
 
+#include "instance_buffer_object.h"
 #include <vector>
 
 class VertexBufferObject
@@ -11,10 +12,16 @@ public:
 
 	void addVertexComponent(int location, unsigned int offset, unsigned int numDimensions);
 
+	// Adds a component that is read once per instance from an InstanceBufferObject, instead of once per vertex. A matrix is one component per column.
+	void addInstanceComponent(int location, unsigned int offset, unsigned int numDimensions);
+
+	// Clears both the vertex and instance components.
 	void clearVertexComponents();
 
 	void setBytesPerVertex(unsigned int bytes);
 
+	void setBytesPerInstance(unsigned int bytes);
+
 	void setNumIndicesPerPrimitive(unsigned int num);
 
 	void setVertices(void const * vertices, unsigned int numBytes, bool dynamic);
@@ -25,6 +32,9 @@ public:
 
 	void render() const;
 
+	// Renders numInstances copies in one draw, reading the instance components from instances, starting at firstInstance. Needs OpenGL 3.3.
+	void render(InstanceBufferObject const & instances, unsigned int firstInstance, unsigned int numInstances) const;
+
 private:
 	class VertexComponent
 	{
@@ -38,6 +48,8 @@ private:
 	unsigned int mode;
 	unsigned int numIndices;
 	unsigned int bytesPerVertex;
+	unsigned int bytesPerInstance;
 	std::vector<VertexComponent> vertexComponents;
+	std::vector<VertexComponent> instanceComponents;
 };
 
@@ -0,0 +1,64 @@
+#include "worker_pool.h"
+
+WorkerPool::WorkerPool(unsigned int numThreads)
+{
+	stopping = false;
+	if(numThreads == 0)
+	{
+		numThreads = std::thread::hardware_concurrency();
+		numThreads = (numThreads > 1 ? numThreads - 1 : 1);
+	}
+	for(unsigned int i = 0; i < numThreads; i++)
+	{
+		threads.push_back(std::thread(&WorkerPool::work, this));
+	}
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	jobAdded.notify_all();
+	for(auto & thread : threads)
+	{
+		thread.join();
+	}
+}
+
+void WorkerPool::run(std::function<void ()> job)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		jobs.push_back(std::move(job));
+	}
+	jobAdded.notify_one();
+}
+
+unsigned int WorkerPool::getNumThreads() const
+{
+	return (unsigned int)threads.size();
+}
+
+void WorkerPool::work()
+{
+	while(true)
+	{
+		std::function<void ()> job;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			jobAdded.wait(lock, [this]()
+			{
+				return stopping || !jobs.empty();
+			});
+			if(jobs.empty())
+			{
+				return; // Stopping and all jobs are done.
+			}
+			job = std::move(jobs.front());
+			jobs.pop_front();
+		}
+		job();
+	}
+}
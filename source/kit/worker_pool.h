@@ -0,0 +1,34 @@
+#pragma once
+
+#include <functional>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// A pool of threads that run jobs in the background, in the order they were added.
+class WorkerPool
+{
+public:
+	// Starts the threads. If numThreads is 0, it uses one less than the number of hardware threads (at least one).
+	WorkerPool(unsigned int numThreads = 0);
+
+	// Finishes the jobs that are already queued and stops the threads.
+	~WorkerPool();
+
+	// Adds a job to be run on one of the threads. The job must not throw.
+	void run(std::function<void ()> job);
+
+	// Returns the number of threads.
+	unsigned int getNumThreads() const;
+
+private:
+	void work();
+
+	std::vector<std::thread> threads;
+	std::deque<std::function<void ()>> jobs;
+	std::mutex mutex;
+	std::condition_variable jobAdded;
+	bool stopping;
+};
@@ -7,8 +7,6 @@ namespace Scene2D
 	{
 		aspectRatio = 1.0f;
 		maxViewSize = 1.0f;
-		projection = projectionInverse = Matrix33f::identity();
-		view = viewInverse = Matrix33f::identity();
 		projectionNeedsUpdate = true;
 		viewNeedsUpdate = true;
 	}
@@ -47,7 +45,7 @@ namespace Scene2D
 		{
 			const_cast<Camera *>(this)->updateView();
 		}
-		return (projection * view).transform(worldPosition, 1);
+		return (projection * view).transformPoint(worldPosition);
 	}
 
 	Coord2f Camera::getWorldPosition(Coord2f appPosition) const
@@ -60,10 +58,11 @@ namespace Scene2D
 		{
 			const_cast<Camera *>(this)->updateView();
 		}
-		return (viewInverse * projectionInverse).transform(appPosition, 1);
+		// The inverses are computed here rather than kept, since this is called far less often than the camera moves.
+		return (view.rigidInverse() * projection.inverse()).transformPoint(appPosition);
 	}
 
-	Matrix33f const & Camera::getProjection() const
+	Affine2f const & Camera::getProjection() const
 	{
 		if(projectionNeedsUpdate)
 		{
@@ -72,7 +71,7 @@ namespace Scene2D
 		return projection;
 	}
 
-	Matrix33f const & Camera::getView() const
+	Affine2f const & Camera::getView() const
 	{
 		if(viewNeedsUpdate)
 		{
@@ -88,40 +87,31 @@ namespace Scene2D
 			throw std::exception();
 		}
 		float maxViewSizeInv = 1.0f / maxViewSize;
+		Matrix22f scale = Matrix22f::identity();
 		if(aspectRatio >= 1.0f)
 		{
-			projection(0, 0) = maxViewSizeInv;
-			projection(1, 1) = maxViewSizeInv * aspectRatio;
-			projectionInverse(0, 0) = maxViewSize;
-			projectionInverse(1, 1) = maxViewSize / aspectRatio;
+			scale(0, 0) = maxViewSizeInv;
+			scale(1, 1) = maxViewSizeInv * aspectRatio;
 		}
 		else
 		{
-			projection(0, 0) = maxViewSizeInv / aspectRatio;
-			projection(1, 1) = maxViewSizeInv;
-			projectionInverse(0, 0) = maxViewSize * aspectRatio;
-			projectionInverse(1, 1) = maxViewSize;
+			scale(0, 0) = maxViewSizeInv / aspectRatio;
+			scale(1, 1) = maxViewSizeInv;
 		}
+		projection.setLinear(scale);
 		projectionNeedsUpdate = false;
 	}
 
 	void Camera::updateView()
 	{
-		Coord2f position = getPosition();
 		float cosOrientation = std::cos(getOrientation());
 		float sinOrientation = std::sin(getOrientation());
-		view(0, 0) = cosOrientation;
-		view(1, 0) = sinOrientation;
-		view(0, 1) = -sinOrientation;
-		view(1, 1) = cosOrientation;
-		view(0, 2) = (-position[0] * rot(0, 0) - position[1] * rot(1, 0));
-		view(1, 2) = (-position[0] * rot(0, 1) - position[1] * rot(1, 1));
-		viewInverse(0, 0) = cosOrientation;
-		viewInverse(1, 0) = -sinOrientation;
-		viewInverse(0, 1) = sinOrientation;
-		viewInverse(1, 1) = cosOrientation;
-		viewInverse(0, 2) = position[0];
-		viewInverse(1, 2) = position[1];
+		Matrix22f rot;
+		rot(0, 0) = cosOrientation;
+		rot(1, 0) = -sinOrientation;
+		rot(0, 1) = sinOrientation;
+		rot(1, 1) = cosOrientation;
+		view = Affine2f(rot, getPosition()).rigidInverse();
 		viewNeedsUpdate = false;
 	}
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Entity.h"
+#include "../../kit/affine.h"
 #include <memory>
 
 namespace Scene2D
@@ -15,8 +16,8 @@ namespace Scene2D
 		virtual void setOrientation(float) override;
 		Coord2f getAppPosition(Coord2f worldPosition) const;
 		Coord2f getWorldPosition(Coord2f appPosition) const;
-		Matrix33f const & getProjection() const;
-		Matrix33f const & getView() const;
+		Affine2f const & getProjection() const;
+		Affine2f const & getView() const;
 
 	private:
 		void updateProjection();
@@ -26,9 +27,7 @@ namespace Scene2D
 		float maxViewSize;
 		bool projectionNeedsUpdate;
 		bool viewNeedsUpdate;
-		Matrix44f projection;
-		Matrix44f projectionInverse;
-		Matrix44f view;
-		Matrix44f viewInverse;
+		Affine2f projection;
+		Affine2f view;
 	};
 }
\ No newline at end of file